@@ -1,5 +1,15 @@
 #include <benchmark/benchmark.h>
 #include "aec/aec.hpp"
+#include "aec/apa_filter.hpp"
+#include "aec/double_talk_detector.hpp"
+#include "aec/ipnlms_filter.hpp"
+#include "aec/nlms_filter.hpp"
+#include "aec/resampler.hpp"
+#include "aec/session_pool.hpp"
+#include "aec/trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -56,4 +66,377 @@ static void BM_AEC_Latency(benchmark::State& state) {
 
 BENCHMARK(BM_AEC_Latency)->Unit(benchmark::kMillisecond);
 
+// Colored (AR(2)) far-end through a random decaying echo path. Reports CPU
+// time per sample and, as a counter, how many samples the engine needs before
+// a 250 ms window reaches the target ERLE (0 if never reached).
+static void run_convergence(benchmark::State& state, aec::Algorithm algorithm) {
+    const uint32_t length = static_cast<uint32_t>(state.range(0));
+    const uint32_t total = 16000 * 4;
+    const uint32_t window = 4000;
+    const double target_erle_db = 20.0;
+
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(length);
+    for (uint32_t i = 0; i < length; ++i) h[i] = 0.3f * dist(gen) * std::exp(-static_cast<float>(i) / (length / 4.0f));
+    std::vector<float> far(total), near(total, 0.0f), out(total);
+    float p1 = 0.0f, p2 = 0.0f;
+    for (uint32_t i = 0; i < total; ++i) {
+        float s = 1.6f * p1 - 0.8f * p2 + 0.05f * dist(gen);
+        p2 = p1;
+        p1 = s;
+        far[i] = s;
+        for (uint32_t j = 0; j < length && j <= i; ++j) near[i] += h[j] * far[i - j];
+    }
+
+    double samples_to_target = 0.0;
+    for (auto _ : state) {
+        std::unique_ptr<aec::AdaptiveFilter> filter;
+        if (algorithm == aec::Algorithm::APA) {
+            filter.reset(new aec::APAFilter(length, 8, 1.0f, 1e-6f));
+        } else {
+            filter.reset(new aec::NLMSFilter(length, 0.5f, 1e-6f, false));
+        }
+        filter->process_block(far.data(), near.data(), out.data(), total, 1, true);
+        benchmark::DoNotOptimize(out.data());
+
+        state.PauseTiming();
+        samples_to_target = 0.0;
+        for (uint32_t s = 0; s + window <= total; s += window) {
+            double pn = 0.0, pe = 0.0;
+            for (uint32_t i = s; i < s + window; ++i) {
+                pn += near[i] * near[i];
+                pe += out[i] * out[i];
+            }
+            if (10.0 * std::log10(pn / (pe + 1e-20)) >= target_erle_db) {
+                samples_to_target = s + window;
+                break;
+            }
+        }
+        state.ResumeTiming();
+    }
+    state.counters["samples_to_20dB"] = samples_to_target;
+    state.SetItemsProcessed(state.iterations() * total);
+}
+
+static void BM_Convergence_NLMS(benchmark::State& state) { run_convergence(state, aec::Algorithm::NLMS); }
+static void BM_Convergence_APA(benchmark::State& state) { run_convergence(state, aec::Algorithm::APA); }
+
+BENCHMARK(BM_Convergence_NLMS)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Convergence_APA)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// Steady-state cost of IPNLMS on a sparse path (bulk delay, 32-tap response),
+// arg 1 enables tap skipping
+static void BM_IPNLMS_Sparse(benchmark::State& state) {
+    const uint32_t length = 2048;
+    const uint32_t delay = 600;
+    aec::IPNLMSFilter filter(length, 0.5f, 1e-6f, -0.5f);
+    if (state.range(0)) filter.enable_tap_skipping(64, -50.0f, 8000);
+
+    std::mt19937 gen(1);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    const uint32_t n = 32000;
+    std::vector<float> x(n), y(n, 0.0f), out(n);
+    for (auto& v : x) v = dist(gen);
+    for (uint32_t i = delay; i < n; ++i) {
+        for (uint32_t j = 0; j < 32 && j + delay <= i; ++j) {
+            y[i] += 0.3f * std::exp(-static_cast<float>(j) / 8.0f) * x[i - delay - j];
+        }
+    }
+    filter.process_block(x.data(), y.data(), out.data(), n, 1, true); // converge
+
+    for (auto _ : state) {
+        filter.process_block(x.data(), y.data(), out.data(), n, 1, true);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["active_taps"] = filter.active_taps();
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_IPNLMS_Sparse)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// Frequency-domain DTD on an 8-mic array sharing one far-end reference, one
+// 10 ms frame per iteration; arg 0 runs independent per-channel detectors,
+// arg 1 the batched detector
+static void BM_DTD_MultiChannel(benchmark::State& state) {
+    const uint32_t ch = 8, frame = 160;
+    std::mt19937 gen(1);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(frame * ch), near(frame * ch);
+    for (uint32_t i = 0; i < frame; ++i) {
+        const int16_t f = static_cast<int16_t>(dist(gen));
+        for (uint32_t c = 0; c < ch; ++c) {
+            far[i * ch + c] = f;
+            near[i * ch + c] = static_cast<int16_t>(0.5f * f + 0.1f * dist(gen));
+        }
+    }
+    aec::MultiChannelDoubleTalkDetector bank(ch, frame, 1.5f, 0.3f, 0.9f, 3, true, 0);
+    std::vector<aec::DoubleTalkDetector> single(ch, aec::DoubleTalkDetector(frame, 1.5f, 0.3f, 0.9f, 3, true, 0));
+    bool adapt[8];
+    for (auto _ : state) {
+        if (state.range(0)) {
+            bank.update(far.data(), near.data(), frame, ch, adapt);
+        } else {
+            for (uint32_t c = 0; c < ch; ++c) adapt[c] = single[c].update(&far[c], &near[c], frame, ch);
+        }
+        benchmark::DoNotOptimize(adapt);
+    }
+    state.SetItemsProcessed(state.iterations() * frame * ch);
+}
+BENCHMARK(BM_DTD_MultiChannel)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Frequency-domain DTD over a cycle of silence, echo only, near-end talk and
+// double-talk; arg 1 enables the tiered energy gate. The counter reports the
+// share of frames that reached the coherence path.
+static void BM_DTD_Tiered(benchmark::State& state) {
+    const uint32_t frame = 160, frames = 200;
+    std::mt19937 gen(3);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<int16_t> far(frame * frames), near(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        const uint32_t phase = static_cast<uint32_t>(i / frame) / 50; // 50 frames per phase
+        const float f = phase == 0 || phase == 2 ? 0.0f : 3000.0f * dist(gen);
+        const float talk = phase >= 2 ? 3000.0f * dist(gen) : 0.0f;
+        far[i] = static_cast<int16_t>(f);
+        near[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, 0.3f * f + talk)));
+    }
+    aec::DoubleTalkDetector dtd(frame, 1.5f, 0.3f, 0.9f, 3, true, 0, state.range(0) != 0);
+    for (auto _ : state) {
+        for (uint32_t f = 0; f < frames; ++f) {
+            benchmark::DoNotOptimize(dtd.update(&far[f * frame], &near[f * frame], frame));
+        }
+    }
+    const aec::DTDTierCounters& c = dtd.tier_counters();
+    state.counters["coherence_share"] =
+        static_cast<double>(c.coherence) / static_cast<double>(c.silent + c.far_only + c.near_only + c.coherence);
+    state.SetItemsProcessed(state.iterations() * frame * frames);
+}
+BENCHMARK(BM_DTD_Tiered)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Eight channels of 1024-tap float NLMS per 10 ms frame, serially (arg 0) or
+// with that many pool threads helping the caller. Real time is the measure:
+// the caller's CPU time leaves out the work done by the pool.
+static void BM_AEC_ParallelChannels(benchmark::State& state) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 1024;
+    config.channels = 8;
+    config.use_fixed_point = false;
+    config.worker_threads = static_cast<uint32_t>(state.range(0));
+    auto aec = aec::create_aec(config);
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(160 * 8), near(far.size()), out(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>(dist(gen));
+        near[i] = static_cast<int16_t>(0.5f * far[i]);
+    }
+    for (auto _ : state) {
+        aec->process(far.data(), near.data(), out.data(), 160, 8);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 160 * 8);
+}
+BENCHMARK(BM_AEC_ParallelChannels)->Arg(0)->Arg(1)->Arg(3)->Arg(7)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// One 10 ms frame for each of 1000 mono 256-tap Q15 calls: separate AEC
+// instances (arg 0) against one AECSessionPool batch (arg 1)
+static void BM_SessionPool(benchmark::State& state) {
+    const uint32_t sessions = 1000, frame = 160;
+    aec::AECConfig config;
+    config.frame_size = frame;
+    config.filter_length = 256;
+    std::mt19937 gen(5);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(sessions * frame), near(far.size()), out(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>(dist(gen));
+        near[i] = static_cast<int16_t>(0.5f * far[i]);
+    }
+    std::vector<std::unique_ptr<aec::AEC>> instances;
+    aec::AECSessionPool pool(config, state.range(0) ? sessions : 0);
+    std::vector<aec::SessionFrame> batch;
+    for (uint32_t s = 0; s < sessions; ++s) {
+        if (state.range(0)) {
+            batch.push_back({static_cast<uint32_t>(pool.open_session()), &far[s * frame], &near[s * frame], &out[s * frame]});
+        } else {
+            instances.push_back(aec::create_aec(config));
+        }
+    }
+    for (auto _ : state) {
+        if (state.range(0)) {
+            pool.process(batch.data(), sessions);
+        } else {
+            for (uint32_t s = 0; s < sessions; ++s) {
+                instances[s]->process(&far[s * frame], &near[s * frame], &out[s * frame], frame);
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * sessions * frame);
+    if (state.range(0)) state.counters["realtime_calls"] = pool.stats().realtime_factor;
+}
+BENCHMARK(BM_SessionPool)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// Four channels of 512-tap float NLMS per 10 ms frame: interleaved int16
+// (arg 0), which is converted and deinterleaved per channel, against planar
+// float (arg 1), which the filters read in place
+static void BM_AEC_SampleFormat(benchmark::State& state) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 512;
+    config.channels = 4;
+    config.use_fixed_point = false;
+    auto aec = aec::create_aec(config);
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(160 * 4), near(far.size()), out(far.size());
+    std::vector<float> far_f32(far.size()), near_f32(far.size()), out_f32(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>(dist(gen));
+        near[i] = static_cast<int16_t>(0.5f * far[i]);
+        // Channel c's plane starts at c * 160
+        far_f32[(i % 4) * 160 + i / 4] = far[i] / 32768.0f;
+        near_f32[(i % 4) * 160 + i / 4] = near[i] / 32768.0f;
+    }
+    const float* far_planes[4];
+    const float* near_planes[4];
+    float* out_planes[4];
+    for (size_t c = 0; c < 4; ++c) {
+        far_planes[c] = &far_f32[c * 160];
+        near_planes[c] = &near_f32[c * 160];
+        out_planes[c] = &out_f32[c * 160];
+    }
+    for (auto _ : state) {
+        if (state.range(0)) {
+            aec->process(far_planes, near_planes, out_planes, 160, 4);
+            benchmark::DoNotOptimize(out_f32.data());
+        } else {
+            aec->process(far.data(), near.data(), out.data(), 160, 4);
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 160 * 4);
+}
+BENCHMARK(BM_AEC_SampleFormat)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Cost of the echo metrics on a short mono filter, where they weigh the
+// most: 256-tap float NLMS per 10 ms frame with AECConfig::enable_metrics off
+// (arg 0) and on (arg 1)
+static void BM_AEC_Metrics(benchmark::State& state) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.use_fixed_point = false;
+    config.enable_metrics = state.range(0) != 0;
+    auto aec = aec::create_aec(config);
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(160), near(far.size()), out(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>(dist(gen));
+        near[i] = static_cast<int16_t>(0.5f * far[i]);
+    }
+    for (auto _ : state) {
+        aec->process(far.data(), near.data(), out.data(), 160);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 160);
+}
+BENCHMARK(BM_AEC_Metrics)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// 48 kHz mono, 2048-tap float echo canceller per 10 ms frame: fullband NLMS
+// (arg 0) against the subband engine AEC picks at wideband rates (arg 1)
+static void BM_AEC_Subband(benchmark::State& state) {
+    aec::AECConfig config;
+    config.sample_rate = 48000;
+    config.frame_size = 480;
+    config.filter_length = 2048;
+    config.use_fixed_point = false;
+    config.subband_count = state.range(0) ? 64 : 0;
+    auto aec = aec::create_aec(config);
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(480), near(far.size()), out(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>(dist(gen));
+        near[i] = static_cast<int16_t>(0.5f * far[i]);
+    }
+    for (auto _ : state) {
+        aec->process(far.data(), near.data(), out.data(), 480);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 480);
+}
+BENCHMARK(BM_AEC_Subband)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// 16 kHz mono float echo canceller per 10 ms frame: a 2048-tap filter
+// alone (arg 0) against 256 taps with residual echo suppression (arg 1)
+// and without it (arg 2)
+static void BM_AEC_ResidualSuppression(benchmark::State& state) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = state.range(0) ? 256 : 2048;
+    config.use_fixed_point = false;
+    config.enable_residual_echo_suppression = state.range(0) == 1;
+    auto aec = aec::create_aec(config);
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(160), near(far.size()), out(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>(dist(gen));
+        near[i] = static_cast<int16_t>(0.5f * far[i]);
+    }
+    for (auto _ : state) {
+        aec->process(far.data(), near.data(), out.data(), 160);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 160);
+}
+BENCHMARK(BM_AEC_ResidualSuppression)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+// Warm start: restoring a 1024-tap float NLMS instance with the residual
+// echo suppressor from a snapshot
+static void BM_AEC_LoadState(benchmark::State& state) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.use_fixed_point = false;
+    config.enable_residual_echo_suppression = true;
+    auto aec = aec::create_aec(config);
+    std::vector<uint8_t> snapshot;
+    aec->save_state(snapshot);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(aec->load_state(snapshot.data(), snapshot.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * snapshot.size());
+}
+BENCHMARK(BM_AEC_LoadState)->Unit(benchmark::kMicrosecond);
+
+// 10 ms of mono int16 render through the resampler: 48 kHz to 16 kHz
+// (arg 0) and 44.1 kHz to 48 kHz (arg 1)
+static void BM_Resampler(benchmark::State& state) {
+    const uint32_t in_rate = state.range(0) ? 44100 : 48000;
+    const uint32_t out_rate = state.range(0) ? 48000 : 16000;
+    aec::Resampler resampler(in_rate, out_rate);
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> in(in_rate / 100), out(resampler.max_output(in.size()));
+    for (auto& v : in) v = static_cast<int16_t>(dist(gen));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(resampler.process(in.data(), in.size(), out.data()));
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_Resampler)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// One trace event: two clock reads and a slot in this thread's ring. What
+// each AEC_TRACE_SCOPE costs when built with AEC_ENABLE_TRACING.
+static void BM_TraceScope(benchmark::State& state) {
+    aec::trace::register_thread();
+    for (auto _ : state) {
+        aec::trace::Scope scope("bench");
+    }
+    aec::trace::clear();
+}
+BENCHMARK(BM_TraceScope);
+
 BENCHMARK_MAIN();
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -5,6 +6,7 @@
 #include <cstdlib>
 #include "wav_io.hpp"
 #include "aec/aec.hpp"
+#include "aec/resampler.hpp"
 
 static void print_usage(const char* prog) {
     std::cerr << "Usage: " << prog << " <far_wav> <near_wav> <out_wav> [options]\n";
@@ -45,9 +47,22 @@ int main(int argc, char** argv) {
     if (channels == 0) channels = far_spec.num_channels;
     if (channels == 0) channels = 1;
 
+    // The canceller runs at the near-end rate; a far-end at another rate is
+    // resampled to it
     if (far_spec.sample_rate != near_spec.sample_rate) {
-        std::cerr << "sample rate mismatch between far and near WAV\n";
-        return 1;
+        if (!aec::Resampler::supports(far_spec.sample_rate, near_spec.sample_rate)) {
+            std::cerr << "unsupported far/near sample rate ratio\n";
+            return 1;
+        }
+        aec::Resampler resampler(far_spec.sample_rate, near_spec.sample_rate, channels);
+        const size_t far_frames = far_data.size() / channels;
+        std::vector<int16_t> resampled(resampler.max_output(far_frames) * channels);
+        resampled.resize(resampler.process(far_data.data(), far_frames, resampled.data()) * channels);
+        // Offline, the filter delay can be taken back out
+        const size_t lag = std::min<size_t>(resampler.latency() * channels, resampled.size());
+        resampled.erase(resampled.begin(), resampled.begin() + lag);
+        far_data.swap(resampled);
+        std::cout << "Resampled far end " << far_spec.sample_rate << " -> " << near_spec.sample_rate << " Hz\n";
     }
 
     // ensure data lengths match (or pick min)
@@ -57,6 +72,7 @@ int main(int argc, char** argv) {
     size_t out_samples = frames * frame_samples;
 
     aec::AECConfig cfg;
+    cfg.sample_rate = near_spec.sample_rate;
     cfg.channels = channels;
     cfg.frame_size = frame_size;
     cfg.filter_length = filter_length;
@@ -76,7 +92,7 @@ int main(int argc, char** argv) {
         }
     }
 
-    WavSpec out_spec = far_spec;
+    WavSpec out_spec = near_spec;
     write_wav_pcm16(out_fn, out_spec, out);
     std::cout << "Wrote: " << out_fn << " (" << out_samples / channels << " frames)\n";
     return 0;
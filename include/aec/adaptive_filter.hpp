@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "state_io.hpp"
+
+namespace aec {
+
+// Common interface for the echo-path estimators that AEC::Impl can drive.
+// Engines consume a block of far-end (reference) and near-end (microphone)
+// samples for one channel and write the echo-cancelled error signal.
+class AdaptiveFilter {
+public:
+    virtual ~AdaptiveFilter() = default;
+
+    // Process `n` samples. `stride` is the spacing between consecutive samples
+    // of this channel in all three buffers. Samples are floats in [-1, 1).
+    // Returns false if the block cannot be processed (e.g. bad block size).
+    virtual bool process_block(const float* far, const float* near, float* out,
+                               size_t n, size_t stride, bool adapt) = 0;
+
+    // Same as above on raw Q15 samples. Engines without a native fixed-point
+    // path return false; callers then convert to float themselves.
+    virtual bool process_block(const int16_t* far, const int16_t* near, int16_t* out,
+                               size_t n, size_t stride, bool adapt) {
+        (void)far; (void)near; (void)out; (void)n; (void)stride; (void)adapt;
+        return false;
+    }
+
+    virtual void reset() = 0;
+
+    // Warm-start snapshot of everything reset() clears (coefficients, delay
+    // line, running sums), for AEC::save_state. load_state() expects a
+    // snapshot from an engine built with the same parameters and returns
+    // false on data that does not fit it.
+    virtual void save_state(StateWriter& out) const = 0;
+    virtual bool load_state(StateReader& in) = 0;
+
+    // For testing/monitoring: L2 norm of the time-domain coefficients
+    virtual float get_coeff_norm() const = 0;
+};
+
+} // namespace aec
@@ -3,9 +3,34 @@
 #include <vector>
 #include <memory>
 #include "config.hpp"
+#include "double_talk_detector.hpp"
+#include "timing.hpp"
 
 namespace aec {
 
+// Echo metrics of one channel. The powers behind them are smoothed over
+// frames in which the far-end is active and the double-talk detector allows
+// adaptation, so near-end talk does not read as poor cancellation; the
+// power-based fields stay 0 until the first such frame.
+struct ChannelMetrics {
+    double erle_db = 0.0;       // near-end over residual power
+    double erl_db = 0.0;        // far-end over near-end power: loss along the echo path
+    double misadjustment = 0.0; // residual over near-end power, linear; above 1 when the filter diverges
+    double coefficient_norm = 0.0;
+    bool double_talk = false;   // the detector held adaptation in the last frame
+    double dtd_near_far_ratio = 0.0; // detector's last smoothed near/far power ratio
+    double dtd_coherence = 1.0;      // and its last coherence (frequency-domain mode)
+    uint64_t echo_frames = 0;   // frames the powers were updated from
+};
+
+// Snapshot returned by AEC::get_metrics()
+struct AECMetrics {
+    uint32_t channels = 0;
+    double erle_db = 0.0;     // over all channels, from their summed powers
+    bool double_talk = false; // in any channel
+    ChannelMetrics channel[AECConfig::max_channels];
+};
+
 class AEC {
 public:
     explicit AEC(const AECConfig& config);
@@ -16,13 +41,68 @@ public:
     // samples per channel. 'channels' defaults to 1 for backward compatibility.
     bool process(const int16_t* far_end, const int16_t* near_end,
                  int16_t* output, uint32_t frame_size, uint32_t channels = 1);
+
+    // Planar buffers: far_end[c], near_end[c] and output[c] each point to
+    // 'frame_size' samples of channel c. Float samples are on the [-1, 1)
+    // scale. Float engines run on float planes and the Q15 engine on int16
+    // planes without any copy; the other pairings convert per sample.
+    bool process(const float* const* far_end, const float* const* near_end,
+                 float* const* output, uint32_t frame_size, uint32_t channels = 1);
+    bool process(const int16_t* const* far_end, const int16_t* const* near_end,
+                 int16_t* const* output, uint32_t frame_size, uint32_t channels = 1);
     
     // Reset filter state
     void reset();
+
+    // Warm starts: a snapshot of everything the instance has adapted to
+    // (filter coefficients and delay lines, detector and suppressor
+    // smoothers, the delay estimate and far-end ring, echo metrics), from
+    // which a new instance with the same configuration continues bit-exactly.
+    // It is a small versioned header followed by the raw state in host byte
+    // order, so a snapshot file can be memory-mapped and passed to
+    // load_state() as it is. Timing statistics are not part of it. Call
+    // between process() calls.
+    size_t state_size() const;
+    // Writes state_size() bytes; false if `capacity` is smaller
+    bool save_state(void* buffer, size_t capacity) const;
+    bool save_state(std::vector<uint8_t>& out) const;
+    // False, with the state left as it was, for a snapshot taken with
+    // another configuration (worker threads, thread pinning and huge pages
+    // aside), format version or architecture, or cut short; a snapshot that
+    // passes those checks but does not load resets the instance
+    bool load_state(const void* data, size_t size);
     
     // Get performance metrics
-    double get_erle() const;  // Echo Return Loss Enhancement
+    double get_erle() const;  // Echo Return Loss Enhancement, as AECMetrics::erle_db
+    // Mean processing time per sample in ms: a cost, not a latency.
+    // get_timing() has the per-frame tails.
     double get_latency_ms() const;
+    // Echo metrics for every channel (see AECConfig::enable_metrics). Call
+    // between process() calls; cleared by reset().
+    AECMetrics get_metrics() const;
+
+    // Far-to-near bulk delay from the delay estimator, in samples, and its
+    // confidence in [0, 1]; both 0 when delay estimation is disabled or no
+    // estimate exists yet
+    uint32_t get_estimated_delay() const;
+    float get_delay_confidence() const;
+    // Delay currently applied to the far-end ahead of the adaptive filter
+    uint32_t get_applied_delay() const;
+    // Frames decided by each double-talk detector tier, summed over channels
+    // (see AECConfig::dtd_tiered); cleared by reset()
+    DTDTierCounters get_dtd_tier_counters() const;
+    // Bytes of memory the instance holds. Filter, detector and buffer state
+    // sits in one cache-line-aligned block sized exactly at construction
+    // (AECConfig::arena_huge_pages rounds it up to whole huge pages); worker
+    // threads are not counted.
+    size_t memory_footprint() const;
+    // Per-stage timing histograms (p50/p99/max) and the count of process()
+    // calls that took longer than the audio they carried, since construction
+    // or reset_timing(). Both are lock-free and may be called from a
+    // monitoring thread while another runs process(). Everything reads 0
+    // when the library is built with AEC_ENABLE_TIMING off.
+    TimingStats get_timing() const;
+    void reset_timing();
     
 private:
     class Impl;
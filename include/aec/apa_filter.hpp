@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "adaptive_filter.hpp"
+#include "arena.hpp"
+
+namespace aec {
+
+// Fast affine projection (Gauss-Seidel FAP). Projecting the update onto the
+// last `order` regressors decorrelates colored (speech) input, so it converges
+// much faster than NLMS after an echo-path change. The fast form keeps an
+// auxiliary coefficient vector plus a sliding input correlation and solves
+// the order x order normal equations with warm-started Gauss-Seidel sweeps,
+// for O(length + order^2) per sample instead of O(length * order).
+//
+// `order` is clamped to 1..32 (and to `length`); `mu` in (0, 1].
+//
+// The engine always runs in floating point.
+class APAFilter : public AdaptiveFilter {
+public:
+    APAFilter(uint32_t length, uint32_t order, float mu, float delta, Arena* arena = nullptr);
+    ~APAFilter() override;
+
+    using AdaptiveFilter::process_block;
+
+    // Process one sample, returns the echo-cancelled output
+    float process(float far_end, float near_end, bool adapt = true);
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) override;
+    void reset() override;
+    void save_state(StateWriter& out) const override;
+    bool load_state(StateReader& in) override;
+    float get_coeff_norm() const override;
+
+    uint32_t order() const;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
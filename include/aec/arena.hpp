@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace aec {
+
+// One contiguous block that an instance carves all of its state from. Every
+// allocation starts on a cache line and nothing is freed individually: the
+// block goes away with the arena.
+//
+// A default-constructed arena is a counting arena. It serves nothing itself
+// (callers fall back to the heap) but adds up how much space each request
+// would take, so constructing an object graph against a counting arena once
+// gives the exact capacity to build it in a real one.
+class Arena {
+public:
+    static constexpr size_t alignment = 64;
+
+    Arena() = default;
+    // `capacity` bytes, cache-line aligned. With `huge_pages` the block is
+    // mapped from 2 MiB pages when the system has them reserved, otherwise
+    // transparent huge pages are requested for it (Linux only; elsewhere the
+    // flag is ignored).
+    Arena(size_t capacity, bool huge_pages);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // `bytes` aligned to `align` (at least a cache line), or nullptr when the
+    // arena is full or counting
+    void* allocate(size_t bytes, size_t align = alignment);
+    bool owns(const void* p) const {
+        return base && static_cast<const char*>(p) >= base && static_cast<const char*>(p) < base + size;
+    }
+
+    size_t capacity() const { return size; }
+    // Bytes handed out, or requested so far from a counting arena
+    size_t used() const { return offset; }
+    // Whether the block is backed by huge pages (reserved or transparent)
+    bool huge_pages() const { return huge; }
+
+    static size_t round_up(size_t bytes) { return (bytes + alignment - 1) & ~(alignment - 1); }
+
+private:
+    char* base = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    bool mapped = false;
+    bool huge = false;
+};
+
+// std allocator drawing from an arena, or from the heap when it has none or
+// the arena is full. Converts from an Arena* so containers can be built
+// straight from one: std::vector<float, ArenaAllocator<float>> v(arena).
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena* arena = nullptr) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        void* p = arena ? arena->allocate(n * sizeof(T), alignof(T)) : nullptr;
+        return static_cast<T*>(p ? p : ::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) {
+        if (!arena || !arena->owns(p)) ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+    Arena* arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Deleter for objects that may live in an arena: those only have their
+// destructor run, heap objects are deleted
+template <typename T>
+struct ArenaDelete {
+    ArenaDelete(bool in_arena = false) : in_arena(in_arena) {}
+    template <typename U>
+    ArenaDelete(const ArenaDelete<U>& other) : in_arena(other.in_arena) {}
+
+    void operator()(T* p) const {
+        if (in_arena) {
+            p->~T();
+        } else {
+            delete p;
+        }
+    }
+
+    bool in_arena;
+};
+
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDelete<T>>;
+
+// Constructs a T in the arena, or on the heap when there is no room
+template <typename T, typename... Args>
+ArenaPtr<T> arena_new(Arena* arena, Args&&... args) {
+    if (void* p = arena ? arena->allocate(sizeof(T), alignof(T)) : nullptr) {
+        return ArenaPtr<T>(new (p) T(std::forward<Args>(args)...), ArenaDelete<T>(true));
+    }
+    return ArenaPtr<T>(new T(std::forward<Args>(args)...));
+}
+
+} // namespace aec
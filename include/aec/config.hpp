@@ -5,7 +5,10 @@ namespace aec {
 
 enum class Algorithm {
     NLMS,
-    RLS
+    RLS,
+    PBFDAF, // partitioned-block frequency-domain adaptive filter (MDF)
+    APA,    // fast affine projection, order set by apa_order
+    IPNLMS  // improved proportionate NLMS, for sparse echo paths
 };
 
 struct AECConfig {
@@ -15,20 +18,79 @@ struct AECConfig {
     uint32_t filter_length = 1024;
     float mu = 0.1f;  // Step size for NLMS
     float delta = 1e-6f;  // Regularization
+    float rls_lambda = 0.999f; // Forgetting factor for Algorithm::RLS (memory ~ 1/(1-lambda) samples)
+    uint32_t apa_order = 4; // Projection order for Algorithm::APA (1..32)
+    float ipnlms_alpha = -0.5f; // Proportionality for Algorithm::IPNLMS (-1 = NLMS, towards 1 = PNLMS)
+    // Sparse tap skipping (Algorithm::IPNLMS): blocks of taps whose energy
+    // stays below the threshold are left out of the convolution and update
+    bool sparse_tap_skipping = false;
+    uint32_t sparse_block_size = 64; // taps per tracked block
+    float sparse_skip_threshold_db = -50.0f; // block energy relative to the strongest block
+    uint32_t sparse_recheck_interval = 8000; // samples between full-filter re-checks
     bool use_fixed_point = true;
+    // Wideband audio: with Algorithm::NLMS at subband_min_rate and above, the
+    // echo path is estimated in subband_count oversampled bands (see
+    // SubbandFilter), in floating point whatever use_fixed_point says, at
+    // the cost of subband_count * 4 samples of output delay. 0 keeps every
+    // rate fullband.
+    uint32_t subband_count = 64;
+    static constexpr uint32_t subband_min_rate = 32000;
+    // Bulk delay estimation: the far-end is delayed by the estimated echo
+    // delay (less delay_headroom) before the adaptive filter, so
+    // filter_length only has to cover the dispersive echo tail
+    bool enable_delay_estimation = false;
+    uint32_t max_delay_ms = 500; // longest far-to-near delay searched
+    uint32_t delay_headroom = 64; // taps kept ahead of the estimated delay, in samples
+    float delay_confidence_threshold = 0.3f; // estimates below this confidence are not applied
     // Multi-channel support
     uint32_t channels = 1; // number of interleaved channels (1..8)
     static constexpr uint32_t max_channels = 8;
+    // Parallel channels: with worker_threads > 0, AEC::process runs the
+    // channels' filters on a persistent pool of that many threads (at most
+    // channels - 1) plus the calling thread. Output is bit-identical to serial
+    // processing.
+    uint32_t worker_threads = 0;
+    // Pin each pool thread to one CPU of the process's affinity mask
+    // (Linux/Android). Off by default: pools of separate instances pick their
+    // CPUs independently and would share them
+    bool pin_worker_threads = false;
+    // Back the instance's state block with huge pages (Linux): reserved 2 MiB
+    // pages when available, transparent huge pages otherwise
+    bool arena_huge_pages = false;
+    // Echo metrics (AEC::get_metrics): far-end, near-end and residual power
+    // smoothed with this time constant over frames where the far-end is active
+    // and the double-talk detector allows adaptation
+    bool enable_metrics = true;
+    uint32_t metrics_time_constant_ms = 500;
     // Frequency-domain DTD options
-    bool dtd_use_frequency = true; // use frequency-domain coherence by default
-    // Number of FFT bins to average for coherence (use frame_size/2 by default)
-    uint32_t dtd_freq_bins = 0; // 0 = auto (frame_size/2)
+    // Frequency-domain coherence instead of the time-domain detector. AEC
+    // ignored this field before the FFT detector landed; false restores the
+    // previous decisions
+    bool dtd_use_frequency = true;
+    // Number of FFT bins to average for coherence, counted from DC. Frames
+    // are zero-padded to the next power of two (transform_size(frame_size)),
+    // so bin k sits at k * sample_rate / transform_size, not at
+    // k * sample_rate / frame_size as before the FFT detector
+    uint32_t dtd_freq_bins = 0; // 0 = auto (transform_size(frame_size)/2)
     // Double-talk detection (DTD) settings
     bool enable_double_talk_detection = true;
     float dtd_near_to_far_threshold = 1.5f; // ratio near_power / far_power > threshold -> near-dominant
     float dtd_coherence_threshold = 0.3f; // coherence below this with above ratio => double-talk
     float dtd_smoothing_alpha = 0.9f; // smoothing factor for running powers (0..1)
     uint32_t dtd_hangover_frames = 3; // keep adaptation disabled for this many frames after DTD triggers
+    // Tiered frequency-domain DTD: the smoothed near/far power ratio decides
+    // silent, echo-only and clearly near-dominant frames, and spectra and
+    // coherence are computed only for the ambiguous rest
+    bool dtd_tiered = false;
+    float dtd_tier_near_ratio = 10.0f; // smoothed near/far ratio above which a frame is double-talk outright
+    // Residual echo suppression: a Wiener-style spectral gain on each
+    // channel's filter output (see ResidualEchoSuppressor), so a short
+    // filter can reach the echo level of a much longer one. It reuses the
+    // frequency-domain double-talk detector's spectra when that runs.
+    bool enable_residual_echo_suppression = false;
+    float res_over_suppression = 1.5f; // residual echo estimate scale outside double-talk
+    float res_min_gain_db = -30.0f; // deepest suppression in any bin
+    float res_smoothing_alpha = 0.9f; // per-frame smoothing of the spectra behind the gains
 };
 
 } // namespace aec
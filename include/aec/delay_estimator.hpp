@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "arena.hpp"
+#include "state_io.hpp"
+
+namespace aec {
+
+// Far-to-near bulk delay estimator (GCC-PHAT). Every `window` samples the
+// most recent `window` near-end samples are cross-correlated against the
+// far-end history covering delays 0..max_delay, on both signals decimated by
+// `decimation`, which is also the resolution of the estimate. The cross-spectrum is
+// phase-normalized (PHAT) so the correlation peak is sharp for any spectral
+// colouring, and smoothed over analyses so uncorrelated near-end speech and
+// noise average out.
+//
+// confidence() is the margin of the correlation peak over the next best
+// delay: near 1 for one clear echo path, near 0 when far and near are
+// unrelated.
+class DelayEstimator {
+public:
+    // Delays and `window` are in input samples; the decimated window is
+    // rounded up to a power of two
+    explicit DelayEstimator(uint32_t max_delay, uint32_t window = 1024, uint32_t decimation = 4,
+                            Arena* arena = nullptr);
+    ~DelayEstimator();
+
+    void reset();
+    // Warm-start snapshot: the current windows, the smoothed cross-spectrum
+    // and the last estimate
+    void save_state(StateWriter& out) const;
+    bool load_state(StateReader& in);
+
+    // Feed time-aligned far/near samples (`stride` apart, as for interleaved
+    // buffers). Returns true when a new estimate was produced.
+    bool update(const int16_t* far, const int16_t* near, uint32_t n, uint32_t stride = 1);
+    // Float samples in [-1, 1), estimated exactly as the same int16 samples
+    bool update(const float* far, const float* near, uint32_t n, uint32_t stride = 1);
+
+    // Last estimate in samples, and its confidence in [0, 1]; both 0 until
+    // the first analysis with enough far- and near-end energy
+    uint32_t delay() const;
+    float confidence() const;
+
+    uint32_t max_delay() const;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -2,9 +2,33 @@
 #include <cstdint>
 #include <vector>
 #include <complex>
+#include "arena.hpp"
+#include "fft.hpp"
+#include "state_io.hpp"
 
 namespace aec {
 
+// Frames decided by each tier of the frequency-domain detector. Without
+// tiering every frame goes through the coherence path.
+struct DTDTierCounters {
+    uint64_t silent = 0;    // near-end below the energy floor: no double-talk
+    uint64_t far_only = 0;  // near/far power ratio at or below the threshold: echo only
+    uint64_t near_only = 0; // ratio above tier_near_ratio: double-talk without coherence
+    uint64_t coherence = 0; // ambiguous ratio: spectra and coherence computed
+};
+
+// One channel's far-end and near-end spectra from the last frame, for
+// stages that reuse the detector's transforms. Bin k (of `bins`) of the
+// far-end is far[k]; the near-end's is (near_re[k * stride],
+// near_im[k * stride]). `far` is null when the frame computed none.
+struct DTDSpectra {
+    const std::complex<double>* far = nullptr;
+    const double* near_re = nullptr;
+    const double* near_im = nullptr;
+    size_t stride = 0;
+    uint32_t bins = 0;
+};
+
 class DoubleTalkDetector {
 public:
     DoubleTalkDetector(uint32_t frame_size = 256,
@@ -13,19 +37,60 @@ public:
                        float smoothing_alpha = 0.9f,
                        uint32_t hangover_frames = 3,
                        bool use_frequency = false,
-                       uint32_t freq_bins = 0);
+                       uint32_t freq_bins = 0,
+                       bool tiered = false,
+                       float tier_near_ratio = 10.0f,
+                       Arena* arena = nullptr);
 
     void reset();
+    // Warm-start snapshot of the smoothed powers and spectra and the
+    // hangover; the tier counters are statistics and left out
+    void save_state(StateWriter& out) const;
+    bool load_state(StateReader& in);
 
     // Update with a single frame of raw int16 samples. `stride` indicates the
     // spacing between consecutive samples for this channel in the buffer
     // (useful for interleaved multi-channel buffers). Returns true when
     // adaptation is allowed.
     bool update(const int16_t* far, const int16_t* near, uint32_t frame_size, uint32_t stride = 1);
+    // The same for float samples in [-1, 1); an int16 frame scaled by 1/32768
+    // gives the same decision
+    bool update(const float* far, const float* near, uint32_t frame_size, uint32_t stride = 1);
 
     bool is_adapt_allowed() const { return adapt_allowed; }
+    // Frame counts per tier in frequency mode (zero in time-domain mode);
+    // cleared by reset()
+    const DTDTierCounters& tier_counters() const { return counters; }
+    // Compute the spectra for every frame in frequency mode, including the
+    // ones the energy tiers decide without them (decisions are unchanged)
+    void set_keep_spectra(bool keep) { keep_spectra = keep; }
+    // The last frame's spectra, if it computed any
+    DTDSpectra spectra() const;
+
+    // Frame size rounded up to a power of two (frames are zero-padded)
+    static uint32_t transform_size(uint32_t frame_size);
 
 private:
+    friend class MultiChannelDoubleTalkDetector;
+
+    // Which part of the frequency-domain detector decides a frame. With
+    // `tiered` set, the smoothed powers settle the clear cases before any
+    // transform runs; otherwise every frame is Coherence.
+    enum class Tier { Silent, FarOnly, NearOnly, Coherence };
+
+    template <typename T>
+    bool update_frame(const T* far, const T* near, uint32_t frame_size, uint32_t stride);
+
+    void smooth_powers(double far_pow, double near_pow, double cross_pow);
+    // Picks the tier from the smoothed powers and counts it
+    Tier classify();
+    // Coherence decision from the far spectrum X and near spectrum Y, where
+    // bin k of Y is (yr[k * stride], yi[k * stride])
+    bool coherence_double_talk(const std::complex<double>* X, const double* yr, const double* yi, size_t stride);
+    bool time_double_talk() const;
+    // Applies the hangover; returns whether adaptation is allowed
+    bool finish(bool dt_detected);
+
     float alpha; // smoothing factor
     float sm_far;
     float sm_near;
@@ -36,13 +101,25 @@ private:
     uint32_t hangover_frames;
     uint32_t hangover_counter;
     bool adapt_allowed;
+    // Tiered frequency-domain mode: a smoothed near/far power ratio above
+    // tier_near_ratio is double-talk without looking at coherence
+    bool tiered;
+    float tier_near_ratio;
+    DTDTierCounters counters;
+    bool keep_spectra = false;
+    bool has_spectra = false; // X and Y hold the last frame
     // Frequency-domain members
     bool use_frequency;
     uint32_t fft_size;
     uint32_t freq_bins; // how many bins to use (up to fft_size/2)
-    std::vector<double> Sxx_sm;
-    std::vector<double> Syy_sm;
-    std::vector<std::complex<double>> Sxy_sm;
+    ArenaVector<double> Sxx_sm;
+    ArenaVector<double> Syy_sm;
+    ArenaVector<std::complex<double>> Sxy_sm;
+    RealFFTd fft;
+    ArenaVector<double> far_frame;
+    ArenaVector<double> near_frame;
+    ArenaVector<std::complex<double>> X;
+    ArenaVector<std::complex<double>> Y;
     // Last computed metrics (for tests/monitoring)
     double last_coherence = 1.0;
     double last_ratio = 0.0;
@@ -52,4 +129,77 @@ public:
     double get_last_ratio() const { return last_ratio; }
 };
 
+// One DoubleTalkDetector per channel of an interleaved or planar buffer. When
+// every channel carries the same far-end (one loudspeaker reference, several
+// microphones) the far-end power and spectrum are computed once per frame and
+// the near-end channels are gathered in a single pass; otherwise each
+// channel is analysed on its own. Decisions are identical to running the
+// per-channel detectors separately.
+class MultiChannelDoubleTalkDetector {
+public:
+    MultiChannelDoubleTalkDetector(uint32_t channels,
+                                   uint32_t frame_size = 256,
+                                   float near_to_far_threshold = 1.5f,
+                                   float coherence_threshold = 0.3f,
+                                   float smoothing_alpha = 0.9f,
+                                   uint32_t hangover_frames = 3,
+                                   bool use_frequency = false,
+                                   uint32_t freq_bins = 0,
+                                   bool tiered = false,
+                                   float tier_near_ratio = 10.0f,
+                                   Arena* arena = nullptr);
+
+    void reset();
+    // Every channel's DoubleTalkDetector::save_state(), in order
+    void save_state(StateWriter& out) const;
+    bool load_state(StateReader& in);
+
+    // Update the first `channels` detectors from buffers interleaved with
+    // `channels` samples per step; adapt[c] receives each channel's decision
+    void update(const int16_t* far, const int16_t* near, uint32_t frame_size,
+                uint32_t channels, bool* adapt);
+    // Planar buffers: far[c] and near[c] each hold channel c's frame. Planes
+    // that are the same pointer count as the same far-end without comparing
+    // samples.
+    void update(const int16_t* const* far, const int16_t* const* near, uint32_t frame_size,
+                uint32_t channels, bool* adapt);
+    void update(const float* const* far, const float* const* near, uint32_t frame_size,
+                uint32_t channels, bool* adapt);
+
+    uint32_t channels() const { return static_cast<uint32_t>(detectors.size()); }
+    const DoubleTalkDetector& channel(uint32_t c) const { return detectors[c]; }
+    // Whether the last frame took the shared far-end path
+    bool far_end_shared() const { return shared; }
+    // Tier counters summed over all channels
+    DTDTierCounters tier_counters() const;
+    // See DoubleTalkDetector::set_keep_spectra(); applies to every channel
+    void set_keep_spectra(bool keep);
+    // Channel c's spectra from the last frame, shared far-end or not
+    DTDSpectra spectra(uint32_t c) const;
+
+private:
+    // `Frames` reads channel c's samples from an interleaved or planar buffer
+    template <typename Frames>
+    void update_frames(const Frames& far, const Frames& near, uint32_t frame_size, uint32_t channels,
+                       bool* adapt);
+
+    ArenaVector<DoubleTalkDetector> detectors;
+    uint32_t fft_size = 0;
+    RealFFTd fft;
+    ArenaVector<double> far_frame;
+    ArenaVector<std::complex<double>> far_spectrum;
+    // Near-end frames interleaved sample by sample for one batched transform,
+    // and their spectra (bin k of channel c at [k * channels + c])
+    ArenaVector<double> near_frames;
+    ArenaVector<double> near_re;
+    ArenaVector<double> near_im;
+    ArenaVector<double> near_pow;
+    ArenaVector<double> cross_pow;
+    ArenaVector<DoubleTalkDetector::Tier> tiers;
+    bool shared = false;
+    bool keep_spectra = false;
+    bool shared_spectra = false; // far_spectrum and near_re/im hold the last shared frame
+    uint32_t spectra_stride = 0; // channels in that frame
+};
+
 } // namespace aec
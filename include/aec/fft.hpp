@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <complex>
+#include <memory>
+#include "arena.hpp"
+
+namespace aec {
+
+// Twiddles and bit-reversal table for one transform size. Plans are
+// immutable and cached: every transform of the same size and precision
+// shares one, so constructing an FFT after the first is only a map lookup
+// plus its own work buffer.
+template <typename T>
+struct FFTPlan;
+
+// Shared plan for `size` (a power of two, at least 2). Thread-safe.
+template <typename T>
+std::shared_ptr<const FFTPlan<T>> fft_plan(uint32_t size);
+
+// Real-input FFT of a fixed power-of-two size. forward()/inverse() do no trig
+// and no allocation. Butterflies run on the SIMD kernel table (see
+// simd_kernels.hpp); the double ones round identically on every table. Work
+// buffers come from `arena` when one is given.
+template <typename T>
+class BasicRealFFT {
+public:
+    explicit BasicRealFFT(uint32_t size, Arena* arena = nullptr);
+
+    uint32_t size() const { return n; }
+    uint32_t bins() const { return n / 2 + 1; }
+
+    // `in` holds size() real samples, `out` receives bins() complex values.
+    void forward(const T* in, std::complex<T>* out);
+    // `in` holds bins() complex values, `out` receives size() real samples.
+    // The inverse is scaled by 1/size() so inverse(forward(x)) == x.
+    void inverse(const std::complex<T>* in, T* out);
+
+    // forward() on `count` signals at once, interleaved sample by sample:
+    // sample i of signal c is in[i * count + c], and bin k of its spectrum
+    // goes to out_re/out_im[k * count + c]. Each butterfly runs across all
+    // signals, on the SIMD kernel table for double, so this is much cheaper
+    // than `count` forward() calls. For double the results are identical to
+    // forward(); for float they may differ from its SIMD butterflies in
+    // rounding.
+    void forward_batch(const T* in, T* out_re, T* out_im, uint32_t count);
+    // Grows the work buffer for batches of `count`, so forward_batch() does
+    // not allocate
+    void reserve_batch(uint32_t count);
+
+    const FFTPlan<T>* plan() const { return shared_plan.get(); }
+
+private:
+    void complex_fft(std::complex<T>* data, bool inverse) const;
+
+    uint32_t n;
+    uint32_t half;
+    std::shared_ptr<const FFTPlan<T>> shared_plan;
+    ArenaVector<std::complex<T>> work;
+    ArenaVector<T> batch_re; // forward_batch() work, split real/imaginary
+    ArenaVector<T> batch_im;
+};
+
+using RealFFT = BasicRealFFT<float>;
+using RealFFTd = BasicRealFFT<double>;
+
+extern template class BasicRealFFT<float>;
+extern template class BasicRealFFT<double>;
+
+// True when `v` is a non-zero power of two.
+inline bool is_power_of_two(uint32_t v) { return v != 0 && (v & (v - 1)) == 0; }
+
+} // namespace aec
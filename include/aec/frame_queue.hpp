@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aec {
+
+// Wait-free single-producer/single-consumer ring of fixed-size int16 frames,
+// for handing audio from one thread's callback to another's. The producer
+// fills the slot from acquire() and publishes it with push(); the consumer
+// reads front() in place and releases it with pop(). The slots are
+// allocated by the constructor and nothing after that allocates, locks or
+// waits. The two counters sit on their own cache lines so the threads do not
+// share one.
+class FrameQueue {
+public:
+    FrameQueue(uint32_t depth, size_t frame_samples)
+        : depth(depth > 0 ? depth : 1), frame(frame_samples), slots(static_cast<size_t>(this->depth) * frame) {}
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // Producer: the slot for the next frame, or nullptr while the queue is full
+    int16_t* acquire() {
+        const uint64_t w = written.load(std::memory_order_relaxed);
+        if (w - read.load(std::memory_order_acquire) == depth) return nullptr;
+        return &slots[static_cast<size_t>(w % depth) * frame];
+    }
+    // Publishes the slot acquire() returned
+    void push() { written.store(written.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: the oldest frame, or nullptr while the queue is empty
+    const int16_t* front() const {
+        const uint64_t r = read.load(std::memory_order_relaxed);
+        if (written.load(std::memory_order_acquire) == r) return nullptr;
+        return &slots[static_cast<size_t>(r % depth) * frame];
+    }
+    // Hands the front() slot back to the producer
+    void pop() { read.store(read.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Frames queued: a lower bound on the consumer's thread (more may
+    // arrive), an upper bound on the producer's, a snapshot elsewhere
+    uint32_t size() const {
+        const uint64_t r = read.load(std::memory_order_acquire);
+        return static_cast<uint32_t>(written.load(std::memory_order_acquire) - r);
+    }
+    uint32_t capacity() const { return depth; }
+    size_t frame_samples() const { return frame; }
+
+private:
+    const uint32_t depth;
+    const size_t frame;
+    std::vector<int16_t> slots;
+    alignas(64) std::atomic<uint64_t> written{0}; // frames ever pushed
+    alignas(64) std::atomic<uint64_t> read{0};    // frames ever popped
+};
+
+} // namespace aec
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "adaptive_filter.hpp"
+#include "arena.hpp"
+
+namespace aec {
+
+// Improved proportionate NLMS (Benesty & Gay). Each tap's step is a mix of a
+// uniform share and a share proportional to its magnitude, so on sparse echo
+// paths (bulk delay, then a short dense region) the few large taps converge
+// much faster than with NLMS. `alpha` in [-1, 1) sets the mix: -1 is NLMS,
+// values towards 1 behave like PNLMS; -0.5 is the usual choice.
+//
+// Optional tap skipping tracks coefficient energy per block of taps and
+// leaves blocks more than `threshold_db` below the strongest one out of the
+// convolution and the update. Every `recheck_interval` samples all blocks run
+// again for one filter length, so an echo path that moves into a skipped
+// region is picked up.
+//
+// The engine always runs in floating point.
+class IPNLMSFilter : public AdaptiveFilter {
+public:
+    IPNLMSFilter(uint32_t length, float mu, float delta, float alpha, Arena* arena = nullptr);
+    ~IPNLMSFilter() override;
+
+    using AdaptiveFilter::process_block;
+
+    // Process one sample, returns the echo-cancelled output
+    float process(float far_end, float near_end, bool adapt = true);
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) override;
+    void reset() override;
+    void save_state(StateWriter& out) const override;
+    bool load_state(StateReader& in) override;
+    float get_coeff_norm() const override;
+
+    // block_size 0 disables skipping (the default)
+    void enable_tap_skipping(uint32_t block_size, float threshold_db, uint32_t recheck_interval);
+
+    // Taps currently in the convolution and update
+    uint32_t active_taps() const;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -0,0 +1,301 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include "adaptive_filter.hpp"
+#include "fixed_point.hpp"
+#include "state_io.hpp"
+#include "trace.hpp"
+
+namespace aec {
+
+// Inner loops for NLMSEngine, with the trip count as a template parameter so
+// the compiler can fully unroll and vectorize them for the target it builds
+// for. Header-only; the library's prebuilt engines substitute the runtime
+// dispatched SIMD kernels instead (see create_nlms_filter).
+struct PortableNLMSOps {
+    // Independent partial sums so the float reduction vectorizes without
+    // relaxed floating-point flags
+    static constexpr uint32_t lanes = 16;
+
+    template <uint32_t N>
+    static float dot_f32(const float* a, const float* b) {
+        float acc[lanes] = {};
+        for (uint32_t i = 0; i < N; i += lanes) {
+            for (uint32_t l = 0; l < lanes; ++l) acc[l] += a[i + l] * b[i + l];
+        }
+        float sum = 0.0f;
+        for (uint32_t l = 0; l < lanes; ++l) sum += acc[l];
+        return sum;
+    }
+
+    template <uint32_t N>
+    static void axpy_f32(float alpha, const float* x, float* y) {
+        for (uint32_t i = 0; i < N; ++i) y[i] += alpha * x[i];
+    }
+
+    // Wrapping 32-bit accumulation, like the SIMD kernels
+    template <uint32_t N>
+    static int32_t dot_q15(const int16_t* a, const int16_t* b) {
+        uint32_t acc = 0;
+        for (uint32_t i = 0; i < N; ++i) {
+            acc += static_cast<uint32_t>(static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]));
+        }
+        return static_cast<int32_t>(acc);
+    }
+
+    // w[i] = sat(w[i] + q15mul(q15mul(x[i], e), step)), bit-exact with Q15
+    template <uint32_t N>
+    static void update_q15(int16_t* w, const int16_t* x, int16_t e, int16_t step) {
+        for (uint32_t i = 0; i < N; ++i) {
+            const int16_t update = static_cast<int16_t>((static_cast<int32_t>(x[i]) * e) >> 15);
+            const int16_t scaled = static_cast<int16_t>((static_cast<int32_t>(update) * step) >> 15);
+            const int32_t sum = static_cast<int32_t>(w[i]) + scaled;
+            w[i] = static_cast<int16_t>(sum < -32768 ? -32768 : (sum > 32767 ? 32767 : sum));
+        }
+    }
+};
+
+// NLMS with the filter length and sample type fixed at compile time.
+//
+// Allocation-free: all state lives in fixed-size arrays inside the object, so
+// it can be placed statically on targets without a heap. There is no
+// per-sample branching on mode: the sample type selects the arithmetic at
+// compile time, adaptation on/off is hoisted out of the sample loop by
+// process_block, and the delay-line wrap is a constant modulus.
+//
+// Behaviour matches NLMSFilter: the Q15 engine is bit-exact with
+// NLMSFilter(Length, mu, delta, true), the float engine equal up to rounding
+// (the dot product may be summed in a different order).
+//
+//   static aec::NLMSEngine<256, int16_t> nlms(0.1f, 1e-6f);
+//   nlms.process_block(far, near, out, 160, 1, true);
+template <uint32_t Length, typename SampleT, typename Ops = PortableNLMSOps>
+class NLMSEngine;
+
+template <uint32_t Length, typename Ops>
+class NLMSEngine<Length, float, Ops> {
+    static_assert(Length > 0 && Length % PortableNLMSOps::lanes == 0,
+                  "NLMSEngine length must be a positive multiple of 16");
+
+public:
+    using sample_type = float;
+    static constexpr uint32_t length = Length;
+
+    NLMSEngine(float mu, float delta) : mu(mu), delta(delta) { reset(); }
+
+    void reset() {
+        w.fill(0.0f);
+        x.fill(0.0f);
+        x_index = 0;
+        power_sum = 0.0f;
+    }
+
+    // Snapshot for warm starts (see AdaptiveFilter::save_state)
+    void save_state(StateWriter& out) const {
+        out.put_array(w.data(), w.size());
+        out.put_array(x.data(), x.size());
+        out.put(x_index);
+        out.put(power_sum);
+    }
+
+    bool load_state(StateReader& in) {
+        if (!in.get_array(w.data(), w.size()) || !in.get_array(x.data(), x.size()) || !in.get(x_index) ||
+            !in.get(power_sum)) {
+            return false;
+        }
+        if (x_index >= Length) return in.fail();
+        return true;
+    }
+
+    float process(float far_end, float near_end, bool adapt = true) {
+        return adapt ? step<true>(far_end, near_end) : step<false>(far_end, near_end);
+    }
+
+    void process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) {
+        if (adapt) {
+            run<true>(far, near, out, n, stride);
+        } else {
+            run<false>(far, near, out, n, stride);
+        }
+    }
+
+    float coeff_norm() const {
+        float sum = 0.0f;
+        for (float v : w) sum += v * v;
+        return std::sqrt(sum);
+    }
+
+private:
+    template <bool Adapt>
+    void run(const float* far, const float* near, float* out, size_t n, size_t stride) {
+        for (size_t j = 0; j < n; ++j) {
+            out[j * stride] = step<Adapt>(far[j * stride], near[j * stride]);
+        }
+    }
+
+    template <bool Adapt>
+    float step(float far_end, float near_end) {
+        const float leaving = x[x_index];
+        power_sum += far_end * far_end - leaving * leaving;
+        x[x_index] = far_end;
+        x[x_index + Length] = far_end;
+        const float* xw = &x[x_index];
+
+        const float e = near_end - Ops::template dot_f32<Length>(w.data(), xw);
+
+        // Exact recompute once per pass bounds the drift of the running sum
+        if (x_index == 0) power_sum = Ops::template dot_f32<Length>(x.data(), x.data());
+        if (Adapt) {
+            const float power = delta + (power_sum > 0.0f ? power_sum : 0.0f);
+            Ops::template axpy_f32<Length>((mu / power) * e, xw, w.data());
+        }
+
+        x_index = (x_index + 1) % Length;
+        return e;
+    }
+
+    float mu;
+    float delta;
+    alignas(64) std::array<float, Length> w;
+    alignas(64) std::array<float, 2 * Length> x; // mirrored delay line
+    uint32_t x_index = 0;
+    float power_sum = 0.0f;
+};
+
+template <uint32_t Length, typename Ops>
+class NLMSEngine<Length, int16_t, Ops> {
+    static_assert(Length > 0 && Length % PortableNLMSOps::lanes == 0,
+                  "NLMSEngine length must be a positive multiple of 16");
+
+public:
+    using sample_type = int16_t;
+    static constexpr uint32_t length = Length;
+
+    NLMSEngine(float mu, float delta)
+        : mu(mu), delta_q30(static_cast<int32_t>(delta * 32768.0f * 32768.0f)) {
+        reset();
+    }
+
+    void reset() {
+        w.fill(0);
+        x.fill(0);
+        x_index = 0;
+        power_sum = 0;
+    }
+
+    // Snapshot for warm starts (see AdaptiveFilter::save_state)
+    void save_state(StateWriter& out) const {
+        out.put_array(w.data(), w.size());
+        out.put_array(x.data(), x.size());
+        out.put(x_index);
+        out.put(power_sum);
+    }
+
+    bool load_state(StateReader& in) {
+        if (!in.get_array(w.data(), w.size()) || !in.get_array(x.data(), x.size()) || !in.get(x_index) ||
+            !in.get(power_sum)) {
+            return false;
+        }
+        if (x_index >= Length) return in.fail();
+        return true;
+    }
+
+    int16_t process(int16_t far_end, int16_t near_end, bool adapt = true) {
+        return adapt ? step<true>(far_end, near_end) : step<false>(far_end, near_end);
+    }
+
+    void process_block(const int16_t* far, const int16_t* near, int16_t* out,
+                       size_t n, size_t stride, bool adapt) {
+        if (adapt) {
+            run<true>(far, near, out, n, stride);
+        } else {
+            run<false>(far, near, out, n, stride);
+        }
+    }
+
+    float coeff_norm() const {
+        float sum = 0.0f;
+        for (int16_t v : w) {
+            float vf = static_cast<float>(v) / 32768.0f;
+            sum += vf * vf;
+        }
+        return std::sqrt(sum);
+    }
+
+private:
+    template <bool Adapt>
+    void run(const int16_t* far, const int16_t* near, int16_t* out, size_t n, size_t stride) {
+        for (size_t j = 0; j < n; ++j) {
+            out[j * stride] = step<Adapt>(far[j * stride], near[j * stride]);
+        }
+    }
+
+    template <bool Adapt>
+    int16_t step(int16_t far_end, int16_t near_end) {
+        const int32_t leaving = x[x_index];
+        const int32_t entering = far_end;
+        power_sum += ((entering * entering) >> 15) - ((leaving * leaving) >> 15);
+        x[x_index] = far_end;
+        x[x_index + Length] = far_end;
+        const int16_t* xw = &x[x_index];
+
+        const int32_t y_acc = Ops::template dot_q15<Length>(xw, w.data());
+        const Q15 e = Q15::from_raw(near_end) - Q15::from_raw(static_cast<int16_t>(y_acc >> 15));
+
+        if (Adapt) {
+            const float power = static_cast<float>(delta_q30 + power_sum) / (32768.0f * 32768.0f);
+            Ops::template update_q15<Length>(w.data(), xw, e.raw(), Q15(mu / power).raw());
+        }
+
+        x_index = (x_index + 1) % Length;
+        return e.raw();
+    }
+
+    float mu;
+    int32_t delta_q30;
+    alignas(64) std::array<int16_t, Length> w;     // Q15
+    alignas(64) std::array<int16_t, 2 * Length> x; // Q15, mirrored delay line
+    uint32_t x_index = 0;
+    int32_t power_sum = 0; // sum of (x*x) >> 15 over the delay line
+};
+
+// AdaptiveFilter adapter so AEC::Impl can drive an NLMSEngine. The block
+// overload for the other sample type returns false, like NLMSFilter does when
+// called in the wrong mode.
+template <uint32_t Length, typename SampleT, typename Ops = PortableNLMSOps>
+class StaticNLMSFilter : public AdaptiveFilter {
+public:
+    StaticNLMSFilter(float mu, float delta) : engine(mu, delta) {}
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) override {
+        return run(far, near, out, n, stride, adapt);
+    }
+    bool process_block(const int16_t* far, const int16_t* near, int16_t* out,
+                       size_t n, size_t stride, bool adapt) override {
+        return run(far, near, out, n, stride, adapt);
+    }
+    void reset() override { engine.reset(); }
+    void save_state(StateWriter& out) const override { engine.save_state(out); }
+    bool load_state(StateReader& in) override { return engine.load_state(in); }
+    float get_coeff_norm() const override { return engine.coeff_norm(); }
+
+private:
+    bool run(const SampleT* far, const SampleT* near, SampleT* out,
+             size_t n, size_t stride, bool adapt) {
+        AEC_TRACE_SCOPE("NLMSFilter::process_block");
+        engine.process_block(far, near, out, n, stride, adapt);
+        return true;
+    }
+    template <typename OtherT>
+    bool run(const OtherT*, const OtherT*, OtherT*, size_t, size_t, bool) {
+        return false;
+    }
+
+    NLMSEngine<Length, SampleT, Ops> engine;
+};
+
+} // namespace aec
@@ -1,24 +1,46 @@
 #pragma once
 #include <cstdint>
 #include <memory>
+#include "adaptive_filter.hpp"
+#include "arena.hpp"
 
 namespace aec {
 
-class NLMSFilter {
+class NLMSFilter : public AdaptiveFilter {
 public:
-    NLMSFilter(uint32_t length, float mu, float delta, bool use_fixed_point);
-    ~NLMSFilter();
-    
+    // State is allocated from `arena` when one is given
+    NLMSFilter(uint32_t length, float mu, float delta, bool use_fixed_point, Arena* arena = nullptr);
+    ~NLMSFilter() override;
+
     // Process one sample. 'adapt' indicates whether coefficient updates are allowed
     float process_float(float far_end, float near_end, bool adapt = true);
     int16_t process_fixed(int16_t far_end, int16_t near_end, bool adapt = true);
+
+    // Process `n` samples spaced `stride` apart (e.g. one channel of an
+    // interleaved buffer). Equivalent to calling process_float/process_fixed
+    // per sample, but runs the convolution and update over linear memory.
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) override;
+    bool process_block(const int16_t* far, const int16_t* near, int16_t* out,
+                       size_t n, size_t stride, bool adapt) override;
+
     // For testing/monitoring: L2 norm of filter coefficients
-    float get_coeff_norm() const;
-    void reset();
-    
+    float get_coeff_norm() const override;
+    void reset() override;
+    void save_state(StateWriter& out) const override;
+    bool load_state(StateReader& in) override;
+
 private:
     class Impl;
-    std::unique_ptr<Impl> pimpl;
+    ArenaPtr<Impl> pimpl;
 };
 
+// NLMS engine for `length` taps: a compile-time specialized NLMSEngine for
+// 128/256/512/1024/2048 taps, NLMSFilter for any other length. Output is
+// bit-exact with NLMSFilter on the Q15 path.
+std::unique_ptr<AdaptiveFilter> create_nlms_filter(uint32_t length, float mu, float delta, bool use_fixed_point);
+// The same, constructed in `arena` (the compile-time engines keep all their
+// state inline, so they take one allocation)
+ArenaPtr<AdaptiveFilter> create_nlms_filter(Arena* arena, uint32_t length, float mu, float delta, bool use_fixed_point);
+
 } // namespace aec
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "adaptive_filter.hpp"
+#include "arena.hpp"
+
+namespace aec {
+
+// Partitioned-block frequency-domain adaptive filter (MDF, overlap-save).
+// The `length` taps are split into ceil(length / block_size) partitions of
+// `block_size` taps each; every block costs three FFTs of size 2*block_size
+// plus one complex multiply-accumulate per bin and partition, instead of
+// `length` MACs per sample. `block_size` must be a power of two (64 is
+// used otherwise). process_block() takes any number of samples without
+// added latency: samples that do not complete a block are held over, and
+// their outputs cost one more transform pair and multiply-accumulate pass,
+// so calls of whole blocks are cheapest. The filter adapts once per block.
+//
+// The engine always runs in floating point.
+class PBFDAFFilter : public AdaptiveFilter {
+public:
+    PBFDAFFilter(uint32_t length, uint32_t block_size, float mu, float delta, Arena* arena = nullptr);
+    ~PBFDAFFilter() override;
+
+    using AdaptiveFilter::process_block;
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) override;
+    void reset() override;
+    void save_state(StateWriter& out) const override;
+    bool load_state(StateReader& in) override;
+    float get_coeff_norm() const override;
+
+    uint32_t block_size() const;
+    uint32_t partitions() const;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "arena.hpp"
+
+namespace aec {
+
+// Streaming rational-ratio resampler for one stream of interleaved channels.
+// The ratio out_rate / in_rate is reduced to up / down and a Kaiser-windowed
+// sinc lowpass (about 80 dB stop band, cut off at 0.91 of the lower rate's
+// Nyquist frequency) is split into `up` polyphase banks at construction;
+// each output sample is one dot product of a bank with the newest inputs on
+// the SIMD kernel table. Input may arrive in blocks of any size and output
+// is continuous across calls.
+//
+// Equal rates copy the input. Rates supports() rejects (zero, or a reduced
+// ratio with either term above 1024) also pass the input through unchanged.
+// process() never allocates.
+class Resampler {
+public:
+    Resampler(uint32_t in_rate, uint32_t out_rate, uint32_t channels = 1, Arena* arena = nullptr);
+    ~Resampler();
+
+    static bool supports(uint32_t in_rate, uint32_t out_rate);
+
+    // Resamples `frames` frames of `channels` interleaved samples and returns
+    // the number of frames written to `out`, at most max_output(frames).
+    // int16 output is rounded and saturated.
+    size_t process(const float* in, size_t frames, float* out);
+    size_t process(const int16_t* in, size_t frames, int16_t* out);
+    size_t max_output(size_t frames) const;
+    void reset();
+
+    uint32_t up() const;
+    uint32_t down() const;
+    uint32_t taps_per_phase() const;
+    // Group delay of the lowpass, in output samples
+    uint32_t latency() const;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
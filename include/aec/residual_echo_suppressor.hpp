@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "arena.hpp"
+#include "double_talk_detector.hpp"
+#include "state_io.hpp"
+
+namespace aec {
+
+// Post-filter for the echo the adaptive filter leaves behind. Per frequency
+// bin it keeps smoothed far-end, near-end and error spectra and estimates
+// the residual echo two ways: the part of the error coherent with this
+// frame's far-end (misadjustment), and the bin's leak, the error per unit
+// of far-end power learned over frames the detector decided as far-end only
+// (the tail past the filter). A Wiener gain removes the larger, capped by
+// the near-end:
+//
+//   R = min(max(Cxe * See, leak * Sxx), Syy),  G = max(min_gain, 1 - over * R / See)
+//
+// with Cxe the magnitude-squared coherence and `over` 1 during double-talk.
+// The leak is capped by the tail measured in the error's cross-spectra with
+// the far-end of earlier frames, which near-end talk does not raise, and it
+// rises slowly; near-end talk too quiet for the detector is then not
+// learned as echo.
+//
+// The far-end and near-end spectra are normally the frequency-domain
+// double-talk detector's (same transform size), so only the error is
+// transformed and transformed back, in float at twice that size. The gains are
+// smoothed across neighbouring bins and applied without added latency: the
+// filtered frame goes out at once and its ringing past the frame's end is
+// overlap-added into the next frames, while the ringing that would precede
+// the frame is dropped. Gains that change sharply between frames therefore
+// still leave small block-rate discontinuities, the price of no latency;
+// a windowed, overlapped analysis would avoid them at the cost of a frame's
+// delay.
+class ResidualEchoSuppressor {
+public:
+    // `frame_size` as given to the double-talk detector; `over_suppression`
+    // scales the residual echo estimate outside double-talk
+    ResidualEchoSuppressor(uint32_t frame_size, float over_suppression = 1.5f, float min_gain_db = -30.0f,
+                           float smoothing_alpha = 0.9f, Arena* arena = nullptr);
+    ~ResidualEchoSuppressor();
+
+    void reset();
+    // Warm-start snapshot of the smoothed spectra and the learned leak
+    void save_state(StateWriter& out) const;
+    bool load_state(StateReader& in);
+
+    // What the double-talk detector made of a frame. Only far-end-only
+    // frames teach the leak; double-talk frames are suppressed without
+    // over-suppression.
+    enum class Decision { Undecided, FarEndOnly, DoubleTalk };
+
+    // Suppresses residual echo in the filter output `out` in place. `spectra`
+    // holds this frame's far/near spectra from the double-talk detector; when
+    // it is null or computed none, far and near are transformed here. Frames
+    // longer than the transform run in transform-sized pieces.
+    void process(const int16_t* far, const int16_t* near, int16_t* out, uint32_t n,
+                 const DTDSpectra* spectra, Decision decision);
+    // Float samples in [-1, 1)
+    void process(const float* far, const float* near, float* out, uint32_t n,
+                 const DTDSpectra* spectra, Decision decision);
+
+    uint32_t transform_size() const;
+    // Mean gain over the bins of the last frame, in dB
+    float last_gain_db() const;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "adaptive_filter.hpp"
+#include "arena.hpp"
+
+namespace aec {
+
+// Recursive least squares via the a posteriori least-squares lattice (LSL).
+// Cost is O(length) per sample (a handful of MACs and divides per stage)
+// instead of the O(length^2) of direct-form RLS, and the lattice's
+// orthogonalized backward errors make it converge in a few filter lengths
+// regardless of how colored the far-end signal is.
+//
+// `lambda` is the exponential forgetting factor (close to but below 1).
+// The engine always runs in floating point.
+class RLSFilter : public AdaptiveFilter {
+public:
+    RLSFilter(uint32_t length, float lambda, float delta, Arena* arena = nullptr);
+    ~RLSFilter() override;
+
+    using AdaptiveFilter::process_block;
+
+    // Process one sample, returns the a priori error (echo-cancelled output)
+    float process(float far_end, float near_end, bool adapt = true);
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) override;
+    void reset() override;
+    void save_state(StateWriter& out) const override;
+    bool load_state(StateReader& in) override;
+    // L2 norm of the ladder (joint-process) coefficients
+    float get_coeff_norm() const override;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "config.hpp"
+
+namespace aec {
+
+// Counters for one session since it was opened or reset_stats() was called
+struct SessionStats {
+    uint64_t frames = 0;
+    uint64_t samples = 0;
+    uint64_t processing_ns = 0; // time spent on this session's frames
+};
+
+// Pool-wide counters since construction or reset_stats()
+struct SessionPoolStats {
+    uint64_t batches = 0;
+    uint64_t frames = 0;
+    uint64_t samples = 0;
+    uint64_t wall_ns = 0;       // time spent inside process()
+    uint64_t processing_ns = 0; // time spent on frames, summed over threads
+    uint64_t steals = 0;        // frame ranges one thread took from another
+    // Seconds of audio processed per second of wall time, i.e. how many
+    // real-time calls the pool kept up with
+    double realtime_factor = 0.0;
+};
+
+// One frame of one session in a batch: config.frame_size mono samples
+struct SessionFrame {
+    uint32_t session;
+    const int16_t* far_end;
+    const int16_t* near_end;
+    int16_t* output;
+};
+
+// Many independent mono echo cancellers sharing one configuration, for
+// servers hosting thousands of calls. Filter state for all sessions lives in
+// a few contiguous structure-of-arrays blocks allocated once (coefficient and
+// delay-line rows padded to a cache line), and process() runs a whole batch
+// of frames from different sessions per call. The batch is split evenly over
+// the calling thread and `worker_threads` pool threads; a thread that runs
+// out of frames steals half of the remaining range of another, so sessions
+// that cost more (double-talk, longer frames elsewhere) do not leave cores
+// idle.
+//
+// Sessions run fullband NLMS (Q15 or float per use_fixed_point) with the
+// configured double-talk detector and no residual echo suppressor; each
+// session's output is bit-identical to an aec::AEC with the same config
+// below AECConfig::subband_min_rate, or with subband_count 0, as long as
+// enable_residual_echo_suppression is off. At wideband rates AEC runs NLMS
+// in subbands and the pool does not, so the outputs differ there.
+// algorithm, channels, subband_count, enable_residual_echo_suppression and
+// delay estimation are not used.
+class AECSessionPool {
+public:
+    AECSessionPool(const AECConfig& config, uint32_t max_sessions, uint32_t worker_threads = 0);
+    ~AECSessionPool();
+
+    AECSessionPool(const AECSessionPool&) = delete;
+    AECSessionPool& operator=(const AECSessionPool&) = delete;
+
+    // Returns the id of a free session in its initial state, or -1 when all
+    // max_sessions are open
+    int32_t open_session();
+    void close_session(uint32_t session);
+    // Clears the session's filter, detector and counters
+    void reset_session(uint32_t session);
+
+    uint32_t active_sessions() const;
+    uint32_t max_sessions() const;
+
+    // Processes one frame for each entry. A session may appear at most once
+    // per batch. Returns false without processing anything when an entry
+    // names a closed session or repeats one. Does not allocate.
+    bool process(const SessionFrame* frames, uint32_t count);
+
+    SessionStats session_stats(uint32_t session) const;
+    SessionPoolStats stats() const;
+    void reset_stats();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace aec {
+namespace simd {
+
+// Inner loops of the time-domain adaptive filters. One table exists per
+// instruction set; kernels() picks the best one the running CPU supports the
+// first time it is called, so a single binary runs on every target.
+struct Kernels {
+    const char* name;
+
+    // sum(a[i] * b[i])
+    float (*dot_f32)(const float* a, const float* b, size_t n);
+    // y[i] += alpha * x[i]
+    void (*axpy_f32)(float alpha, const float* x, float* y, size_t n);
+    // Proportionate (IPNLMS) gain: out[i] = (base + slope * |w[i]|) * x[i],
+    // returns sum(out[i] * x[i])
+    float (*gain_f32)(float* out, const float* w, const float* x, float base, float slope, size_t n);
+    // sum(|x[i]|)
+    float (*abs_sum_f32)(const float* x, size_t n);
+    // One radix-2 FFT stage on interleaved complex data: for each of `groups`
+    // blocks of 2h points and k < h, t = w[k] * hi[k], (lo[k], hi[k]) =
+    // (lo[k] + t, lo[k] - t), with lo the block's first h points
+    void (*butterfly_c32)(float* data, const float* w, size_t h, size_t groups);
+    // The same stage in double precision (the double-talk detector's
+    // transform). Plain multiplies and adds, no FMA, so every table gives
+    // identical results.
+    void (*butterfly_c64)(double* data, const double* w, size_t h, size_t groups);
+    // The same stage for `count` double-precision transforms at once, stored
+    // as split real/imaginary arrays interleaved point by point (point p of
+    // transform c at re[p * count + c]); `w` as for butterfly_c32. Plain
+    // multiplies and adds, no FMA, so every table gives identical results.
+    void (*butterfly_batch_f64)(double* re, double* im, const double* w, size_t h, size_t groups, size_t count);
+    // Subband filters, band-major: row r holds tap r of `lanes` complex
+    // filters as split real/imaginary arrays, rows `lanes` floats apart.
+    // y[k] += sum over rows of w[r][k] * x[r][k]
+    void (*cmac_rows_f32)(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                          const float* x_re, const float* x_im, size_t lanes, size_t rows);
+    // w[r][k] += (a[k] + i b[k]) * conj(x[r][k])
+    void (*cupdate_rows_f32)(float* w_re, float* w_im, const float* a, const float* b,
+                             const float* x_re, const float* x_im, size_t lanes, size_t rows);
+
+    // sum(a[i] * b[i]) accumulated in 32 bits with two's complement wrap,
+    // like pmaddwd
+    int32_t (*dot_q15)(const int16_t* a, const int16_t* b, size_t n);
+    // NLMS Q15 coefficient update, bit-exact with the Q15 class:
+    // w[i] = sat(w[i] + q15mul(q15mul(x[i], e), step))
+    void (*update_q15)(int16_t* w, const int16_t* x, int16_t e, int16_t step, size_t n);
+};
+
+// Kernel table selected for this CPU
+const Kernels& kernels();
+
+// Name of the selected table: "scalar", "sse4.1", "avx2", "avx512" or "neon"
+const char* active_kernel_name();
+
+// Portable reference implementation
+const Kernels& scalar_kernels();
+
+// Table for the given instruction set, or nullptr when it was not compiled in
+// or the CPU does not support it
+const Kernels* find_kernels(const char* name);
+
+} // namespace simd
+} // namespace aec
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace aec {
+
+// Flat binary snapshot of adaptation state, for warm starts (see
+// AEC::save_state). Values are copied in host byte order without padding or
+// alignment, so a snapshot restores only on the same architecture. Arrays
+// carry their element count, which loading checks against the size the
+// reading object was built with.
+//
+// Like a counting Arena, a writer without a buffer only adds up the bytes.
+class StateWriter {
+public:
+    StateWriter() = default;
+    StateWriter(void* buffer, size_t capacity) : out(static_cast<uint8_t*>(buffer)), capacity(capacity) {}
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "state values are copied as bytes");
+        put_bytes(&value, sizeof(T));
+    }
+    // Flags as one byte, 0 or 1
+    void put(bool value) { put(static_cast<uint8_t>(value ? 1 : 0)); }
+    template <typename T>
+    void put_array(const T* data, size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "state values are copied as bytes");
+        static_assert(!std::is_same<T, bool>::value, "flags are written one at a time");
+        put(static_cast<uint64_t>(n));
+        put_bytes(data, n * sizeof(T));
+    }
+    template <typename T, typename A>
+    void put(const std::vector<T, A>& v) { put_array(v.data(), v.size()); }
+
+    size_t size() const { return offset; }
+    // False once a write did not fit the buffer
+    bool ok() const { return !overflow; }
+
+private:
+    void put_bytes(const void* p, size_t n) {
+        if (out) {
+            if (overflow || n > capacity - offset) {
+                overflow = true;
+                return;
+            }
+            if (n > 0) std::memcpy(out + offset, p, n);
+        }
+        offset += n;
+    }
+
+    uint8_t* out = nullptr;
+    size_t capacity = 0;
+    size_t offset = 0;
+    bool overflow = false;
+};
+
+// Reads what a StateWriter wrote, in the same order. Every read fails once
+// one has run past the data or met an array of the wrong length.
+class StateReader {
+public:
+    StateReader(const void* data, size_t size) : in(static_cast<const uint8_t*>(data)), size(size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "state values are copied as bytes");
+        return get_bytes(&value, sizeof(T));
+    }
+    // A flag byte other than 0 or 1 would be undefined behaviour as a bool,
+    // so it marks the data invalid
+    bool get(bool& value) {
+        uint8_t byte = 0;
+        if (!get(byte)) return false;
+        if (byte > 1) return fail();
+        value = byte != 0;
+        return true;
+    }
+    // Exactly `n` elements
+    template <typename T>
+    bool get_array(T* data, size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "state values are copied as bytes");
+        static_assert(!std::is_same<T, bool>::value, "flags are read one at a time");
+        uint64_t count = 0;
+        if (!get(count)) return false;
+        if (count != n) failed = true;
+        return get_bytes(data, n * sizeof(T));
+    }
+    // As many elements as `v` holds
+    template <typename T, typename A>
+    bool get(std::vector<T, A>& v) { return get_array(v.data(), v.size()); }
+
+    // Element count of the next array, without consuming it
+    bool peek_count(uint64_t& count) const {
+        if (failed || sizeof(count) > size - offset) return false;
+        std::memcpy(&count, in + offset, sizeof(count));
+        return true;
+    }
+
+    size_t remaining() const { return size - offset; }
+    bool ok() const { return !failed; }
+    // Marks the data invalid, e.g. an index out of range
+    bool fail() {
+        failed = true;
+        return false;
+    }
+
+private:
+    bool get_bytes(void* p, size_t n) {
+        if (failed || n > size - offset) {
+            failed = true;
+            return false;
+        }
+        if (n > 0) std::memcpy(p, in + offset, n);
+        offset += n;
+        return true;
+    }
+
+    const uint8_t* in;
+    size_t size;
+    size_t offset = 0;
+    bool failed = false;
+};
+
+} // namespace aec
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "adaptive_filter.hpp"
+#include "arena.hpp"
+
+namespace aec {
+
+// Subband echo canceller for wideband (32/48 kHz) audio. An oversampled DFT
+// filterbank (root-raised-cosine prototype, polyphase analysis and weighted
+// overlap-add synthesis) splits far-end and near-end into `bands` complex
+// bands decimated by bands / 2; the bands / 2 + 1 bands of a real signal
+// each run a short complex NLMS filter, and the synthesis bank rebuilds the
+// echo-cancelled output. An echo tail of `length` taps takes about
+// length / decimation() taps per band, and each band converges at its own
+// normalized rate, which also suits coloured signals such as speech. With
+// the filterbanks, an AEC at 48 kHz with 2048 taps takes about 0.5-0.65
+// times as long as fullband NLMS (BM_AEC_Subband).
+//
+// The output lags the input by latency() samples (the prototype length).
+// `bands` must be a power of two from 8 to 512 (otherwise 64 is used), and
+// process_block() takes any number of samples. The engine always runs in
+// floating point.
+class SubbandFilter : public AdaptiveFilter {
+public:
+    SubbandFilter(uint32_t length, uint32_t bands, float mu, float delta, Arena* arena = nullptr);
+    ~SubbandFilter() override;
+
+    using AdaptiveFilter::process_block;
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) override;
+    void reset() override;
+    void save_state(StateWriter& out) const override;
+    bool load_state(StateReader& in) override;
+    // L2 norm of all band coefficients, on the fullband taps' scale
+    float get_coeff_norm() const override;
+
+    uint32_t bands() const;
+    uint32_t decimation() const;
+    uint32_t taps_per_band() const;
+    uint32_t latency() const;
+
+private:
+    class Impl;
+    ArenaPtr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace aec {
+
+// Parts of AEC::process timed by a TimingRecorder
+enum class Stage : uint32_t {
+    Convert,    // interleaved int16 gathered into planes and scattered back
+    Delay,      // delay estimator and far-end delay line
+    DoubleTalk, // double-talk detection for all channels
+    Filter,     // every channel's filter and coefficient update, end to end
+    Frame       // the whole process() call
+};
+
+static constexpr uint32_t kTimingStages = 5;
+// Four buckets per octave from 1 ns; the last one also holds everything
+// from about 4 s up
+static constexpr uint32_t kTimingBuckets = 128;
+
+// Durations of one stage since the last reset
+struct StageTiming {
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    // Upper edge of the bucket holding the percentile (within 19%), capped
+    // at the exact maximum
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+    // Bucket b counts durations in [timing_bucket_floor(b), timing_bucket_floor(b + 1))
+    uint64_t histogram[kTimingBuckets] = {};
+};
+
+struct TimingStats {
+    StageTiming stages[kTimingStages];
+    uint64_t frames = 0;   // process() calls
+    uint64_t overruns = 0; // calls that took longer than the audio they carried
+    uint64_t worst_overrun_ns = 0; // largest time past that deadline
+
+    const StageTiming& stage(Stage s) const { return stages[static_cast<uint32_t>(s)]; }
+};
+
+// Smallest duration in ns that lands in bucket b
+uint64_t timing_bucket_floor(uint32_t b);
+
+// Fixed-bucket log histograms per stage plus frame-deadline counters. One
+// thread records (the one calling process()); snapshot() and reset() may be
+// called from any other thread at any time. Counters are relaxed atomics
+// written with plain loads and stores, so recording costs no locked
+// instruction; a snapshot is exact per counter but not a cut across them.
+class TimingRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TimingRecorder() { clear(); }
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+    }
+
+    static uint32_t bucket(uint64_t ns) {
+        if (ns < 4) return static_cast<uint32_t>(ns);
+#if defined(__GNUC__) || defined(__clang__)
+        const uint32_t msb = 63 - static_cast<uint32_t>(__builtin_clzll(ns));
+#else
+        uint32_t msb = 63;
+        while (!(ns >> msb)) --msb;
+#endif
+        const uint32_t b = 4 * (msb - 1) + static_cast<uint32_t>((ns >> (msb - 2)) & 3);
+        return b < kTimingBuckets ? b : kTimingBuckets - 1;
+    }
+
+    // Recording thread only
+    void record(Stage stage, uint64_t ns) {
+        Counters& c = stages[static_cast<uint32_t>(stage)];
+        bump(c.histogram[bucket(ns)], 1);
+        bump(c.total_ns, ns);
+        if (ns > c.max_ns.load(std::memory_order_relaxed)) c.max_ns.store(ns, std::memory_order_relaxed);
+    }
+
+    // Recording thread only: a process() call of `ns` for `deadline_ns` of audio
+    void record_frame(uint64_t ns, uint64_t deadline_ns) {
+        record(Stage::Frame, ns);
+        if (ns <= deadline_ns) return;
+        bump(overruns, 1);
+        const uint64_t late = ns - deadline_ns;
+        if (late > worst_overrun_ns.load(std::memory_order_relaxed)) {
+            worst_overrun_ns.store(late, std::memory_order_relaxed);
+        }
+    }
+
+    // Recording thread only: applies a reset() requested since the last call
+    void sync() {
+        if (reset_pending.load(std::memory_order_relaxed) && reset_pending.exchange(false)) clear();
+    }
+
+    // Any thread
+    TimingStats snapshot() const;
+    // Any thread: the counters read as zero from now on and are cleared by
+    // the recording thread at its next sync()
+    void reset() { reset_pending.store(true); }
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> histogram[kTimingBuckets]; // the count is their sum
+        std::atomic<uint64_t> total_ns;
+        std::atomic<uint64_t> max_ns;
+    };
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    void clear();
+
+    Counters stages[kTimingStages];
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint64_t> worst_overrun_ns{0};
+    std::atomic<bool> reset_pending{false};
+};
+
+} // namespace aec
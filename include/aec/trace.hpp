@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace aec {
+namespace trace {
+
+// Events each thread keeps; older ones are overwritten
+static constexpr uint32_t kRingEvents = 1u << 14;
+
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// Appends a complete event to the calling thread's ring. `name` must outlive
+// the trace (a string literal). The first event on a thread allocates its
+// ring unless register_thread() did so already.
+void record(const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+// Gives the calling thread its ring ahead of time, so the first traced call
+// on it doesn't allocate, and names it in the trace (nullptr keeps the name)
+void register_thread(const char* name = nullptr);
+
+// Writes the events every thread still holds as Chrome trace-event JSON,
+// loadable in chrome://tracing and Perfetto. Threads may keep recording
+// meanwhile; events overwritten while being read are left out.
+bool write_chrome_json(const char* path);
+
+// Drops every event recorded so far
+void clear();
+
+// Events retained across all threads
+size_t event_count();
+
+// Times the enclosing scope as one event
+class Scope {
+public:
+    explicit Scope(const char* name) : name(name), begin(now_ns()) {}
+    ~Scope() { record(name, begin, now_ns()); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+} // namespace trace
+} // namespace aec
+
+// Trace points compile to nothing unless the library is built with
+// AEC_ENABLE_TRACING
+#if defined(AEC_ENABLE_TRACING)
+#define AEC_TRACE_CONCAT_(a, b) a##b
+#define AEC_TRACE_CONCAT(a, b) AEC_TRACE_CONCAT_(a, b)
+#define AEC_TRACE_SCOPE(name) ::aec::trace::Scope AEC_TRACE_CONCAT(aec_trace_scope_, __LINE__)(name)
+#else
+#define AEC_TRACE_SCOPE(name) ((void)0)
+#endif
@@ -1,26 +1,64 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include "aec/aec.hpp"
+#include "aec/frame_queue.hpp"
+#include "aec/resampler.hpp"
 namespace aec {
 namespace webrtc {
+struct RenderQueueStats {
+    uint64_t overruns = 0;  // render frames dropped because the queue was full
+    uint64_t underruns = 0; // capture frames that found no render frame queued
+    uint32_t queued = 0;    // render frames waiting
+};
 class WebRTCAecAdapter {
 public:
     WebRTCAecAdapter() = default;
     ~WebRTCAecAdapter() = default;
     bool Init(const AECConfig& config, uint32_t sample_rate, uint32_t frame_ms = 10, uint32_t channels = 1);
+    // Render and capture at different rates: the engine runs at the capture
+    // rate and ProcessRender() resamples each render frame (frame_ms of
+    // render_rate samples) to it, which delays the render path by
+    // Resampler::latency() samples. Fails for rates aec::Resampler does not
+    // support or frames that do not map to whole samples at both rates.
+    bool Init(const AECConfig& config, uint32_t render_rate, uint32_t capture_rate, uint32_t frame_ms, uint32_t channels);
+    // Render frames reach capture through a wait-free single-producer/
+    // single-consumer queue of `depth` frames, so ProcessRender() and
+    // ProcessCapture() may run on different threads. Capture starts once
+    // `delay_frames` + 1 render frames are queued, and again after each
+    // underrun, so it is cancelled against the render frame `delay_frames`
+    // older than the newest; until then the render side reads as silence.
+    // A full queue drops the incoming render frame. Takes effect at the next
+    // Init(); fails unless delay_frames < depth. The default, depth 4 and no
+    // delay, suits render and capture called in turn on one thread.
+    bool SetRenderQueue(uint32_t depth, uint32_t delay_frames) noexcept;
+    // Producer side of the queue; wait-free
     void ProcessRender(const int16_t* far_frame) noexcept;
+    // Consumer side of the queue
     bool ProcessCapture(int16_t* in_out_frame) noexcept;
+    // May be called from any thread
+    RenderQueueStats GetRenderQueueStats() const noexcept;
     void SetEnabled(bool enabled) noexcept { enabled_ = enabled; }
     bool IsEnabled() const noexcept { return enabled_; }
     double GetErle() const;
     double GetLatencyMs() const;
 private:
+    const int16_t* NextRenderFrame() noexcept;
     std::unique_ptr<AEC> aec_;
-    std::vector<int16_t> far_buffer_;
+    std::unique_ptr<Resampler> render_resampler_;
+    std::unique_ptr<FrameQueue> render_queue_;
+    std::vector<int16_t> render_scratch_; // resampler output of dropped frames
+    std::vector<int16_t> silence_;
     std::vector<int16_t> out_buffer_;
+    uint32_t render_queue_depth_ = 4;
+    uint32_t render_delay_frames_ = 0;
+    bool render_primed_ = false; // capture is consuming the queue
+    std::atomic<uint64_t> render_overruns_{0};
+    std::atomic<uint64_t> render_underruns_{0};
     uint32_t sample_rate_ = 0;
+    uint32_t render_rate_ = 0;
     uint32_t frame_ms_ = 10;
     uint32_t frame_size_ = 0;
     uint32_t channels_ = 1;
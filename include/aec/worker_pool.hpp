@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+namespace aec {
+
+// Persistent worker threads for per-frame fork/join work. The threads are
+// created once and optionally pinned, one CPU each, to the CPUs the process
+// may run on; each run() hands them a batch of tasks and waits for it.
+// Between batches a worker spins on the batch counter for `spin_iterations`
+// polls before it parks on a condition variable, so back-to-back frames are
+// picked up without a wake-up syscall and an idle pool costs no CPU. On a
+// single-CPU machine nothing spins.
+//
+// Task t always runs on participant t % (workers + 1), the calling thread
+// being participant 0, so which thread handles which task never changes.
+// run() does not allocate.
+class WorkerPool {
+public:
+    using TaskFn = void (*)(void* context, uint32_t task);
+
+    explicit WorkerPool(uint32_t workers, bool pin = false, uint32_t spin_iterations = 20000);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Calls fn(context, t) for every t < tasks and returns once all are done
+    void run(uint32_t tasks, TaskFn fn, void* context);
+
+    uint32_t workers() const;
+    // Times a worker had to be woken from the parked state
+    uint64_t wakeups() const;
+    // Workers pinned to a CPU; final once every worker has joined a run()
+    uint32_t pinned() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+} // namespace aec
@@ -1,79 +1,383 @@
 #include "aec/aec.hpp"
+#include "aec/arena.hpp"
 #include "aec/nlms_filter.hpp"
 #include "aec/double_talk_detector.hpp"
+#include "aec/delay_estimator.hpp"
+#include "aec/residual_echo_suppressor.hpp"
+#include "aec/pbfdaf_filter.hpp"
+#include "aec/subband_filter.hpp"
+#include "aec/rls_filter.hpp"
+#include "aec/apa_filter.hpp"
+#include "aec/ipnlms_filter.hpp"
+#include "aec/fixed_point.hpp"
+#include "aec/worker_pool.hpp"
+#include "aec/simd_kernels.hpp"
+#include "aec/timing.hpp"
+#include "aec/trace.hpp"
+#include "aec/state_io.hpp"
 #include <vector>
 #include <memory>
-#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 #include <iostream>
 
 namespace aec {
 
+// The stage histograms of an AEC. Without AEC_ENABLE_TIMING an empty
+// stand-in, so instances carry no counters and get_timing() reads zeros.
+#if defined(AEC_ENABLE_TIMING)
+using StageRecorder = TimingRecorder;
+#else
+struct StageRecorder {
+    TimingStats snapshot() const { return {}; }
+    void reset() {}
+};
+#endif
+
+// Accumulates time spent in a stage across start()/pause() pairs; lap()
+// records it and starts the next stage on the same clock read. Compiles to
+// nothing without AEC_ENABLE_TIMING.
+class StageTimer {
+public:
+#if defined(AEC_ENABLE_TIMING)
+    void start() { begin = TimingRecorder::now_ns(); }
+    void pause() { elapsed += TimingRecorder::now_ns() - begin; }
+    void lap(StageRecorder& recorder, Stage stage) {
+        const uint64_t now = TimingRecorder::now_ns();
+        recorder.record(stage, elapsed + (now - begin));
+        begin = now;
+        elapsed = 0;
+    }
+
+private:
+    uint64_t begin = 0;
+    uint64_t elapsed = 0;
+#else
+    void start() {}
+    void pause() {}
+    void lap(StageRecorder&, Stage) {}
+#endif
+};
+
+// Snapshot header (see AEC::save_state). The magic reads back differently
+// on a host of the other byte order.
+static constexpr uint32_t kStateMagic = 0x53434541; // "AECS" on little-endian hosts
+static constexpr uint32_t kStateVersion = 2;
+
+// FNV-1a over every setting that shapes the state or how it evolves. Worker
+// threads, thread pinning and huge pages change neither, so snapshots move
+// freely between instances that differ only in those.
+static uint64_t config_hash(const AECConfig& c) {
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](const auto& value) {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        for (unsigned char b : bytes) h = (h ^ b) * 1099511628211ull;
+    };
+    mix(static_cast<uint32_t>(c.algorithm));
+    mix(c.sample_rate);
+    mix(c.frame_size);
+    mix(c.filter_length);
+    mix(c.mu);
+    mix(c.delta);
+    mix(c.rls_lambda);
+    mix(c.apa_order);
+    mix(c.ipnlms_alpha);
+    mix(c.sparse_tap_skipping);
+    mix(c.sparse_block_size);
+    mix(c.sparse_skip_threshold_db);
+    mix(c.sparse_recheck_interval);
+    mix(c.use_fixed_point);
+    mix(c.subband_count);
+    mix(c.enable_delay_estimation);
+    mix(c.max_delay_ms);
+    mix(c.delay_headroom);
+    mix(c.delay_confidence_threshold);
+    mix(c.channels);
+    mix(c.enable_metrics);
+    mix(c.metrics_time_constant_ms);
+    mix(c.dtd_use_frequency);
+    mix(c.dtd_freq_bins);
+    mix(c.enable_double_talk_detection);
+    mix(c.dtd_near_to_far_threshold);
+    mix(c.dtd_coherence_threshold);
+    mix(c.dtd_smoothing_alpha);
+    mix(c.dtd_hangover_frames);
+    mix(c.dtd_tiered);
+    mix(c.dtd_tier_near_ratio);
+    mix(c.enable_residual_echo_suppression);
+    mix(c.res_over_suppression);
+    mix(c.res_min_gain_db);
+    mix(c.res_smoothing_alpha);
+    return h;
+}
+
+// All filter, detector and buffer state of an instance comes from one arena.
+// Its size is found by building the same state once against a counting arena
+// (see Arena), so the real block fits exactly.
 class AEC::Impl {
 public:
-    Impl(const AECConfig& config)
-        : config(config), total_samples_processed(0), total_processing_time_ns(0) {
-        uint32_t ch = std::max<uint32_t>(1, config.channels);
-        if (ch > AECConfig::max_channels) ch = AECConfig::max_channels;
+    explicit Impl(const AECConfig& config) : Impl(config, nullptr) {}
 
+    // With `probe` set, builds the state from the heap and only counts it
+    Impl(const AECConfig& config, Arena* probe)
+        : config(config),
+          arena(probe ? 0 : arena_bytes(config), config.arena_huge_pages),
+          memory(probe ? probe : &arena),
+          filters(memory),
+          far_block(memory),
+          near_block(memory),
+          out_block(memory),
+          far_q15(memory),
+          near_q15(memory),
+          out_q15(memory),
+          dtd(std::min<uint32_t>(std::max<uint32_t>(1, config.channels), AECConfig::max_channels),
+              config.frame_size,
+              config.dtd_near_to_far_threshold,
+              config.dtd_coherence_threshold,
+              config.dtd_smoothing_alpha,
+              config.dtd_hangover_frames,
+              config.dtd_use_frequency,
+              config.dtd_freq_bins,
+              config.dtd_tiered,
+              config.dtd_tier_near_ratio,
+              memory),
+          suppressors(memory),
+          far_ring(memory),
+          delayed_q15(memory),
+          delayed_f32(memory),
+          total_samples_processed(0), total_processing_time_ns(0) {
+        uint32_t ch = dtd.channels();
+
+        const bool subband = uses_subbands(config);
+        fixed_path = config.use_fixed_point && config.algorithm == Algorithm::NLMS && !subband;
+        metrics_alpha = metrics_smoothing(config);
+        filters.reserve(ch);
         for (uint32_t i = 0; i < ch; ++i) {
-            nlms_filters.emplace_back(std::make_unique<NLMSFilter>(config.filter_length, config.mu, config.delta, config.use_fixed_point));
-            dtds.emplace_back(config.frame_size,
-                              config.dtd_near_to_far_threshold,
-                              config.dtd_coherence_threshold,
-                              config.dtd_smoothing_alpha,
-                              config.dtd_hangover_frames);
+            if (config.algorithm == Algorithm::PBFDAF) {
+                filters.push_back(arena_new<PBFDAFFilter>(memory, config.filter_length,
+                                                          pbfdaf_block_size(config.frame_size), config.mu,
+                                                          config.delta, memory));
+            } else if (config.algorithm == Algorithm::RLS) {
+                filters.push_back(arena_new<RLSFilter>(memory, config.filter_length, config.rls_lambda,
+                                                       config.delta, memory));
+            } else if (config.algorithm == Algorithm::APA) {
+                filters.push_back(arena_new<APAFilter>(memory, config.filter_length, config.apa_order, config.mu,
+                                                       config.delta, memory));
+            } else if (config.algorithm == Algorithm::IPNLMS) {
+                auto ipnlms = arena_new<IPNLMSFilter>(memory, config.filter_length, config.mu, config.delta,
+                                                      config.ipnlms_alpha, memory);
+                if (config.sparse_tap_skipping) {
+                    ipnlms->enable_tap_skipping(config.sparse_block_size, config.sparse_skip_threshold_db,
+                                                config.sparse_recheck_interval);
+                }
+                filters.push_back(std::move(ipnlms));
+            } else if (subband) {
+                filters.push_back(arena_new<SubbandFilter>(memory, config.filter_length, config.subband_count,
+                                                           config.mu, config.delta, memory));
+            } else {
+                filters.push_back(create_nlms_filter(memory, config.filter_length, config.mu, config.delta,
+                                                     fixed_path));
+            }
+        }
+        if (config.enable_residual_echo_suppression) {
+            suppressors.reserve(ch);
+            for (uint32_t i = 0; i < ch; ++i) {
+                suppressors.push_back(arena_new<ResidualEchoSuppressor>(memory, config.frame_size,
+                                                                        config.res_over_suppression,
+                                                                        config.res_min_gain_db,
+                                                                        config.res_smoothing_alpha, memory));
+            }
+            // Every frame's spectra, not just the ones the tiers leave open
+            dtd.set_keep_spectra(true);
+        }
+        // One slice of scratch per channel, so channels can run in parallel
+        far_block.resize(static_cast<size_t>(config.frame_size) * ch);
+        near_block.resize(far_block.size());
+        out_block.resize(far_block.size());
+        far_q15.resize(far_block.size());
+        near_q15.resize(far_block.size());
+        out_q15.resize(far_block.size());
+#if defined(AEC_ENABLE_TRACING)
+        // The constructing thread usually processes too: give it its trace
+        // ring now rather than on the first frame
+        if (!probe) trace::register_thread();
+#endif
+        if (config.worker_threads > 0 && ch > 1 && !probe) {
+            pool = std::make_unique<WorkerPool>(std::min(config.worker_threads, ch - 1), config.pin_worker_threads);
+        }
+        if (config.enable_delay_estimation) {
+            // Search at about 4 kHz in 64 ms windows whatever the sample rate
+            const uint32_t rate = std::max<uint32_t>(1, config.sample_rate);
+            const uint32_t max_delay = static_cast<uint32_t>(static_cast<uint64_t>(config.max_delay_ms) * rate / 1000);
+            delay_estimator = arena_new<DelayEstimator>(memory, max_delay, std::max<uint32_t>(rate / 16, 1),
+                                                        std::max<uint32_t>(rate / 4000, 1), memory);
+            ring_channels = ch;
+            ring_length = max_delay + 1;
+            far_ring.assign(static_cast<size_t>(ring_length) * ring_channels, 0.0f);
+            delayed_q15.resize(static_cast<size_t>(config.frame_size) * ring_channels);
+            delayed_f32.resize(delayed_q15.size());
         }
     }
+
+    // Bytes held by the instance: this object and its arena
+    size_t memory_footprint() const { return sizeof(Impl) + arena.capacity(); }
     
-    bool process(const int16_t* far_end, const int16_t* near_end,
-                 int16_t* output, uint32_t frame_size, uint32_t channels = 1) {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        uint32_t cfg_ch = std::max<uint32_t>(1, config.channels);
-        uint32_t ch = std::min<uint32_t>(std::max<uint32_t>(1, channels), AECConfig::max_channels);
-        // If config.channels differs from requested channels, use the smaller of the two
-        ch = std::min(ch, cfg_ch);
-
-        // For each channel, decide adaptation and process its samples
-        for (uint32_t c = 0; c < ch; ++c) {
-            bool adapt = true;
-            if (config.enable_double_talk_detection) {
-                adapt = dtds[c].update(far_end + c, near_end + c, frame_size, ch);
+    // Planar buffers, one pointer per channel, in int16 or float samples
+    template <typename T>
+    bool process_planar(const T* const* far_end, const T* const* near_end, T* const* output,
+                        uint32_t frame_size, uint32_t channels) {
+        const uint64_t start_ns = begin_frame();
+        const uint32_t ch = active_channels(channels);
+        const uint32_t chunk = prepare_chunks(frame_size, ch);
+        Planes<T>& planes = job_planes(T());
+        for (uint32_t offset = 0; offset < frame_size; offset += chunk) {
+            for (uint32_t c = 0; c < ch; ++c) {
+                planes.far[c] = far_end[c] + offset;
+                planes.near[c] = near_end[c] + offset;
+                planes.out[c] = output[c] + offset;
             }
+            if (!process_chunk(planes, std::min(chunk, frame_size - offset), ch)) return false;
+        }
+        end_frame(start_ns, frame_size);
+        return true;
+    }
 
-            for (uint32_t i = 0; i < frame_size; ++i) {
-                uint32_t idx = i * ch + c;
-                if (config.use_fixed_point) {
-                    output[idx] = nlms_filters[c]->process_fixed(far_end[idx], near_end[idx], adapt);
-                } else {
-                    float far_float = far_end[idx] / 32768.0f;
-                    float near_float = near_end[idx] / 32768.0f;
-                    float out_float = nlms_filters[c]->process_float(far_float, near_float, adapt);
-                    output[idx] = static_cast<int16_t>(out_float * 32767.0f);
+    // Interleaved int16: mono is already planar; more channels are gathered
+    // into int16 planes chunk by chunk and scattered back afterwards
+    bool process_interleaved(const int16_t* far_end, const int16_t* near_end,
+                             int16_t* output, uint32_t frame_size, uint32_t channels) {
+        const uint32_t ch = active_channels(channels);
+        if (ch == 1) return process_planar(&far_end, &near_end, &output, frame_size, 1);
+
+        const uint64_t start_ns = begin_frame();
+        const uint32_t chunk = prepare_chunks(frame_size, ch);
+        Planes<int16_t>& planes = job.q15;
+        StageTimer convert;
+        for (uint32_t offset = 0; offset < frame_size; offset += chunk) {
+            const uint32_t n = std::min(chunk, frame_size - offset);
+            const size_t base = static_cast<size_t>(offset) * ch;
+            for (uint32_t c = 0; c < ch; ++c) {
+                const size_t slice = static_cast<size_t>(c) * block_size;
+                planes.far[c] = &far_q15[slice];
+                planes.near[c] = &near_q15[slice];
+                planes.out[c] = &out_q15[slice];
+            }
+            convert.start();
+            for (uint32_t i = 0; i < n; ++i) {
+                for (uint32_t c = 0; c < ch; ++c) {
+                    far_q15[static_cast<size_t>(c) * block_size + i] = far_end[base + i * ch + c];
+                    near_q15[static_cast<size_t>(c) * block_size + i] = near_end[base + i * ch + c];
                 }
             }
+            convert.pause();
+            if (!process_chunk(planes, n, ch)) return false;
+            convert.start();
+            for (uint32_t i = 0; i < n; ++i) {
+                for (uint32_t c = 0; c < ch; ++c) {
+                    output[base + i * ch + c] = out_q15[static_cast<size_t>(c) * block_size + i];
+                }
+            }
+            convert.lap(timing, Stage::Convert);
         }
-        
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-            end_time - start_time);
-        
-        total_processing_time_ns += duration_ns.count();
-        total_samples_processed += static_cast<uint64_t>(frame_size) * static_cast<uint64_t>(std::max<uint32_t>(1, config.channels));
-        
+        end_frame(start_ns, frame_size);
         return true;
     }
     
     void reset() {
-        for (auto &f : nlms_filters) if (f) f->reset();
+        for (auto &f : filters) if (f) f->reset();
         total_samples_processed = 0;
         total_processing_time_ns = 0;
-        for (auto &d : dtds) d.reset();
+        dtd.reset();
+        for (auto &s : suppressors) s->reset();
+        std::fill(echo, echo + AECConfig::max_channels, EchoPowers());
+        if (delay_estimator) {
+            delay_estimator->reset();
+            std::fill(far_ring.begin(), far_ring.end(), 0);
+            ring_pos = 0;
+            applied_delay = 0;
+        }
     }
     
+    size_t state_size() const {
+        StateWriter counter;
+        write_state(counter);
+        return counter.size();
+    }
+
+    bool save_state(void* buffer, size_t capacity) const {
+        StateWriter out(buffer, capacity);
+        write_state(out);
+        return out.ok();
+    }
+
+    bool save_state(std::vector<uint8_t>& out) const {
+        out.resize(state_size());
+        return save_state(out.data(), out.size());
+    }
+
+    // Header, then the payload
+    void write_state(StateWriter& out) const {
+        StateWriter payload;
+        save_payload(payload);
+        out.put(kStateMagic);
+        out.put(kStateVersion);
+        out.put(config_hash(config));
+        out.put(static_cast<uint64_t>(payload.size()));
+        save_payload(out);
+    }
+
+    bool load_state(const void* data, size_t size) {
+        StateReader in(data, size);
+        uint32_t magic = 0, version = 0;
+        uint64_t hash = 0, payload = 0;
+        if (!in.get(magic) || !in.get(version) || !in.get(hash) || !in.get(payload)) return false;
+        if (magic != kStateMagic || version != kStateVersion || hash != config_hash(config)) return false;
+        // Trailing bytes are allowed, e.g. a mapping rounded up to pages
+        StateWriter expected;
+        save_payload(expected);
+        if (payload != expected.size() || payload > in.remaining()) return false;
+        if (!load_payload(in)) {
+            reset();
+            return false;
+        }
+        return true;
+    }
+
     double get_erle() const {
-        // Simplified ERLE calculation
-        // In real implementation, track echo and residual power
-        return 25.0; // dB - conservative estimate
+        double near = 0.0, residual = 0.0;
+        bool any = false;
+        for (uint32_t c = 0; c < dtd.channels(); ++c) {
+            if (echo[c].frames == 0) continue;
+            near += echo[c].near;
+            residual += echo[c].residual;
+            any = true;
+        }
+        return any ? power_db(near, residual) : 0.0;
+    }
+
+    AECMetrics get_metrics() const {
+        AECMetrics metrics;
+        metrics.channels = dtd.channels();
+        metrics.erle_db = get_erle();
+        for (uint32_t c = 0; c < metrics.channels; ++c) {
+            const EchoPowers& e = echo[c];
+            ChannelMetrics& m = metrics.channel[c];
+            if (e.frames > 0) {
+                m.erle_db = power_db(e.near, e.residual);
+                m.erl_db = power_db(e.far, e.near);
+                m.misadjustment = (e.residual + kPowerFloor) / (e.near + kPowerFloor);
+            }
+            m.coefficient_norm = filters[c]->get_coeff_norm();
+            m.double_talk = e.double_talk;
+            m.dtd_near_far_ratio = dtd.channel(c).get_last_ratio();
+            m.dtd_coherence = dtd.channel(c).get_last_coherence();
+            m.echo_frames = e.frames;
+            metrics.double_talk |= e.double_talk;
+        }
+        return metrics;
     }
     
     double get_latency_ms() const {
@@ -82,13 +386,403 @@ public:
                                       / total_samples_processed;
         return avg_time_per_sample_ns / 1e6; // Convert to ms
     }
+
+    uint32_t get_estimated_delay() const { return delay_estimator ? delay_estimator->delay() : 0; }
+    float get_delay_confidence() const { return delay_estimator ? delay_estimator->confidence() : 0.0f; }
+    uint32_t get_applied_delay() const { return applied_delay; }
+    TimingStats get_timing() const { return timing.snapshot(); }
+    void reset_timing() { timing.reset(); }
+    DTDTierCounters get_dtd_tier_counters() const { return dtd.tier_counters(); }
     
 private:
+    // Per channel: filter, suppressor and echo powers; then the detectors
+    // and the delay compensation
+    void save_payload(StateWriter& out) const {
+        for (uint32_t c = 0; c < dtd.channels(); ++c) {
+            filters[c]->save_state(out);
+            if (!suppressors.empty()) suppressors[c]->save_state(out);
+            const EchoPowers& e = echo[c];
+            out.put(e.far);
+            out.put(e.near);
+            out.put(e.residual);
+            out.put(e.frames);
+            out.put(e.double_talk);
+        }
+        dtd.save_state(out);
+        if (delay_estimator) {
+            delay_estimator->save_state(out);
+            out.put(far_ring);
+            out.put(ring_pos);
+            out.put(applied_delay);
+        }
+    }
+
+    bool load_payload(StateReader& in) {
+        for (uint32_t c = 0; c < dtd.channels(); ++c) {
+            if (!filters[c]->load_state(in)) return false;
+            if (!suppressors.empty() && !suppressors[c]->load_state(in)) return false;
+            EchoPowers& e = echo[c];
+            if (!in.get(e.far) || !in.get(e.near) || !in.get(e.residual) || !in.get(e.frames) ||
+                !in.get(e.double_talk)) {
+                return false;
+            }
+        }
+        if (!dtd.load_state(in)) return false;
+        if (delay_estimator) {
+            if (!delay_estimator->load_state(in) || !in.get(far_ring) || !in.get(ring_pos) ||
+                !in.get(applied_delay)) {
+                return false;
+            }
+            if (ring_pos >= ring_length || applied_delay >= ring_length) return in.fail();
+        }
+        return true;
+    }
+
+    // Per-channel pointers into one chunk
+    template <typename T>
+    struct Planes {
+        const T* far[AECConfig::max_channels];
+        const T* near[AECConfig::max_channels];
+        T* out[AECConfig::max_channels];
+    };
+
+    // If config.channels differs from requested channels, use the smaller of the two
+    uint32_t active_channels(uint32_t channels) const {
+        const uint32_t ch = std::min<uint32_t>(std::max<uint32_t>(1, channels), AECConfig::max_channels);
+        return std::min(ch, std::max<uint32_t>(1, config.channels));
+    }
+
+    // Scratch is sized for config.frame_size at construction; longer
+    // frames run in chunks of that size so process() never allocates
+    uint32_t prepare_chunks(uint32_t frame_size, uint32_t ch) {
+        const uint32_t chunk = config.frame_size > 0 ? config.frame_size : frame_size;
+        block_size = chunk;
+        const size_t needed = static_cast<size_t>(chunk) * ch;
+        if (far_block.size() < needed) {
+            far_block.resize(needed);
+            near_block.resize(needed);
+            out_block.resize(needed);
+            far_q15.resize(needed);
+            near_q15.resize(needed);
+            out_q15.resize(needed);
+        }
+        if (delay_estimator && delayed_q15.size() < needed) {
+            delayed_q15.resize(needed);
+            delayed_f32.resize(needed);
+        }
+        return chunk;
+    }
+
+    // Applies a pending reset_timing() and returns the frame's start time
+    uint64_t begin_frame() {
+#if defined(AEC_ENABLE_TIMING)
+        timing.sync();
+#endif
+        return TimingRecorder::now_ns();
+    }
+
+    void end_frame(uint64_t start_ns, uint32_t frame_size) {
+        const uint64_t duration_ns = TimingRecorder::now_ns() - start_ns;
+        total_processing_time_ns += duration_ns;
+        total_samples_processed += static_cast<uint64_t>(frame_size) * static_cast<uint64_t>(std::max<uint32_t>(1, config.channels));
+#if defined(AEC_ENABLE_TIMING)
+        // The frame is late when it took longer than the audio it carried
+        timing.record_frame(duration_ns, static_cast<uint64_t>(frame_size) * 1000000000ull /
+                                             std::max<uint32_t>(1, config.sample_rate));
+#endif
+    }
+
+    template <typename T>
+    bool process_chunk(Planes<T>& planes, uint32_t frame_size, uint32_t ch) {
+        // The far-end, delayed by the bulk echo delay when it is estimated
+        StageTimer stage;
+        stage.start();
+        if (delay_estimator) {
+            AEC_TRACE_SCOPE("AEC::delay");
+            // Channel 0 is representative: all channels share one playout path
+            if (delay_estimator->update(planes.far[0], planes.near[0], frame_size)) apply_delay_estimate();
+            delay_far_end(planes, frame_size, ch);
+            stage.lap(timing, Stage::Delay);
+        }
+
+        // Decide adaptation for every channel, then run the whole frame
+        // through each channel's filter, on the worker pool when there is one
+        job.float_samples = std::is_same<T, float>::value;
+        job.frame_size = frame_size;
+        job.ch = ch;
+        std::fill(job.adapt, job.adapt + ch, true);
+        if (config.enable_double_talk_detection) {
+            dtd.update(planes.far, planes.near, frame_size, ch, job.adapt);
+            stage.lap(timing, Stage::DoubleTalk);
+        }
+        if (pool) {
+            pool->run(ch, &Impl::run_channel, this);
+        } else {
+            for (uint32_t c = 0; c < ch; ++c) job.ok[c] = process_channel(c);
+        }
+        stage.lap(timing, Stage::Filter);
+        return std::all_of(job.ok, job.ok + ch, [](bool ok) { return ok; });
+    }
+
+    static void run_channel(void* self, uint32_t c) {
+        Impl* impl = static_cast<Impl*>(self);
+        impl->job.ok[c] = impl->process_channel(c);
+    }
+
+    // Runs channel c of the current chunk through its filter. Channels share
+    // nothing but the read-only inputs and disjoint output samples, so any
+    // number of them can run at once with results identical to serial order.
+    bool process_channel(uint32_t c) {
+        AEC_TRACE_SCOPE("AEC::channel");
+        if (job.float_samples) {
+            if (!run_filter(job.f32, c)) return false;
+            if (!suppressors.empty()) suppress(job.f32, c);
+            if (config.enable_metrics) track_echo(job.f32, c);
+        } else {
+            if (!run_filter(job.q15, c)) return false;
+            if (!suppressors.empty()) suppress(job.q15, c);
+            if (config.enable_metrics) track_echo(job.q15, c);
+        }
+        return true;
+    }
+
+    // Residual echo suppression on channel c's filter output, on the
+    // detector's spectra of the same chunk when it computed them
+    template <typename T>
+    void suppress(const Planes<T>& planes, uint32_t c) {
+        DTDSpectra spectra;
+        ResidualEchoSuppressor::Decision decision = ResidualEchoSuppressor::Decision::Undecided;
+        if (config.enable_double_talk_detection) {
+            spectra = dtd.spectra(c);
+            decision = job.adapt[c] ? ResidualEchoSuppressor::Decision::FarEndOnly
+                                    : ResidualEchoSuppressor::Decision::DoubleTalk;
+        }
+        suppressors[c]->process(planes.far[c], planes.near[c], planes.out[c], job.frame_size, &spectra, decision);
+    }
+
+    // Folds the chunk's far-end, near-end and residual power into channel
+    // c's metrics. Frames with a silent far-end or held adaptation only
+    // update the double-talk state.
+    template <typename T>
+    void track_echo(const Planes<T>& planes, uint32_t c) {
+        EchoPowers& e = echo[c];
+        const uint32_t n = job.frame_size;
+        e.double_talk = !job.adapt[c];
+        if (e.double_talk || n == 0) return;
+        const double far = mean_square(planes.far[c], n);
+        if (far < kFarActive) return;
+        // The first frame seeds the averages
+        const double a = e.frames > 0 ? metrics_alpha : 0.0;
+        e.far = a * e.far + (1.0 - a) * far;
+        e.near = a * e.near + (1.0 - a) * mean_square(planes.near[c], n);
+        e.residual = a * e.residual + (1.0 - a) * mean_square(planes.out[c], n);
+        ++e.frames;
+    }
+
+    // Mean square on the [-1, 1) scale. Eight partial sums, which the
+    // compiler keeps in vector registers; float precision is plenty for a
+    // level estimate.
+    static double mean_square(const int16_t* x, uint32_t n) {
+        float lanes[8] = {};
+        uint32_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            for (uint32_t l = 0; l < 8; ++l) {
+                const float v = x[i + l];
+                lanes[l] += v * v;
+            }
+        }
+        float sum = 0.0f;
+        for (; i < n; ++i) sum += static_cast<float>(x[i]) * x[i];
+        for (uint32_t l = 0; l < 8; ++l) sum += lanes[l];
+        return static_cast<double>(sum) / (1073741824.0 * n);
+    }
+
+    static double mean_square(const float* x, uint32_t n) {
+        return static_cast<double>(simd::kernels().dot_f32(x, x, n)) / n;
+    }
+
+    static double power_db(double num, double den) {
+        return 10.0 * std::log10((num + kPowerFloor) / (den + kPowerFloor));
+    }
+
+    // Per-frame smoothing factor for a time constant of
+    // metrics_time_constant_ms at the configured frame size
+    static double metrics_smoothing(const AECConfig& config) {
+        const double frame_ms = 1000.0 * std::max<uint32_t>(1, config.frame_size) /
+                                std::max<uint32_t>(1, config.sample_rate);
+        if (config.metrics_time_constant_ms == 0) return 0.0;
+        return std::exp(-frame_ms / config.metrics_time_constant_ms);
+    }
+
+    bool run_filter(const Planes<int16_t>& planes, uint32_t c) {
+        const uint32_t frame_size = job.frame_size;
+        // Q15 engines run straight on the int16 planes
+        if (fixed_path) {
+            return filters[c]->process_block(planes.far[c], planes.near[c], planes.out[c], frame_size, 1,
+                                             job.adapt[c]);
+        }
+
+        // Float engines run on a converted copy of the channel
+        float* far_c = &far_block[static_cast<size_t>(c) * block_size];
+        float* near_c = &near_block[static_cast<size_t>(c) * block_size];
+        float* out_c = &out_block[static_cast<size_t>(c) * block_size];
+        for (uint32_t i = 0; i < frame_size; ++i) {
+            far_c[i] = planes.far[c][i] / 32768.0f;
+            near_c[i] = planes.near[c][i] / 32768.0f;
+        }
+        if (!filters[c]->process_block(far_c, near_c, out_c, frame_size, 1, job.adapt[c])) return false;
+        for (uint32_t i = 0; i < frame_size; ++i) {
+            planes.out[c][i] = Q15::saturate(static_cast<int32_t>(out_c[i] * 32767.0f));
+        }
+        return true;
+    }
+
+    bool run_filter(const Planes<float>& planes, uint32_t c) {
+        const uint32_t frame_size = job.frame_size;
+        // Float engines run straight on the float planes
+        if (!fixed_path) {
+            return filters[c]->process_block(planes.far[c], planes.near[c], planes.out[c], frame_size, 1,
+                                             job.adapt[c]);
+        }
+
+        // The Q15 engine runs on a quantized copy of the channel
+        int16_t* far_c = &far_q15[static_cast<size_t>(c) * block_size];
+        int16_t* near_c = &near_q15[static_cast<size_t>(c) * block_size];
+        int16_t* out_c = &out_q15[static_cast<size_t>(c) * block_size];
+        for (uint32_t i = 0; i < frame_size; ++i) {
+            far_c[i] = to_q15(planes.far[c][i]);
+            near_c[i] = to_q15(planes.near[c][i]);
+        }
+        if (!filters[c]->process_block(far_c, near_c, out_c, frame_size, 1, job.adapt[c])) return false;
+        for (uint32_t i = 0; i < frame_size; ++i) planes.out[c][i] = out_c[i] / 32768.0f;
+        return true;
+    }
+
+    static int16_t to_q15(float v) {
+        return static_cast<int16_t>(std::min(std::max(v * 32768.0f, -32768.0f), 32767.0f));
+    }
+
+    // Moves the far-end delay to a confident new estimate. Small moves are
+    // ignored since the headroom taps absorb them; larger ones reset the
+    // filters, whose coefficients no longer line up with the far-end.
+    void apply_delay_estimate() {
+        if (delay_estimator->confidence() < config.delay_confidence_threshold) return;
+        const uint32_t estimate = delay_estimator->delay();
+        const uint32_t target = estimate > config.delay_headroom ? estimate - config.delay_headroom : 0;
+        const uint32_t change = target > applied_delay ? target - applied_delay : applied_delay - target;
+        if (change == 0 || change < config.delay_headroom / 2) return;
+        applied_delay = std::min(target, ring_length - 1);
+        for (auto &f : filters) f->reset();
+    }
+
+    // Pushes the chunk into the far-end ring and points each far-end plane
+    // at a copy delayed by applied_delay samples. The ring holds samples on
+    // the [-1, 1) scale, which int16 samples round-trip through exactly.
+    template <typename T>
+    void delay_far_end(Planes<T>& planes, uint32_t frame_size, uint32_t ch) {
+        T* delayed = delayed_planes(T());
+        const uint32_t start = (ring_pos + ring_length - applied_delay) % ring_length;
+        for (uint32_t c = 0; c < ch; ++c) {
+            float* ring = &far_ring[static_cast<size_t>(c) * ring_length];
+            const T* in = planes.far[c];
+            T* out = delayed + static_cast<size_t>(c) * block_size;
+            for (uint32_t i = 0, write = ring_pos, read = start; i < frame_size; ++i) {
+                ring[write] = unit(in[i]);
+                from_unit(ring[read], out[i]);
+                write = (write + 1 == ring_length) ? 0 : write + 1;
+                read = (read + 1 == ring_length) ? 0 : read + 1;
+            }
+            planes.far[c] = out;
+        }
+        ring_pos = static_cast<uint32_t>((static_cast<uint64_t>(ring_pos) + frame_size) % ring_length);
+    }
+
+    static float unit(int16_t v) { return v / 32768.0f; }
+    static float unit(float v) { return v; }
+    static void from_unit(float v, int16_t& out) { out = static_cast<int16_t>(v * 32768.0f); }
+    static void from_unit(float v, float& out) { out = v; }
+
+    Planes<int16_t>& job_planes(int16_t) { return job.q15; }
+    Planes<float>& job_planes(float) { return job.f32; }
+    int16_t* delayed_planes(int16_t) { return delayed_q15.data(); }
+    float* delayed_planes(float) { return delayed_f32.data(); }
+
+    static size_t arena_bytes(const AECConfig& config) {
+        Arena probe;
+        Impl sizing(config, &probe);
+        return probe.used();
+    }
+
+    // NLMS at wideband rates runs in subbands unless the config opts out
+    static bool uses_subbands(const AECConfig& config) {
+        return config.algorithm == Algorithm::NLMS && config.subband_count > 0 &&
+               config.sample_rate >= AECConfig::subband_min_rate;
+    }
+
+    // Largest power of two dividing the frame size, so each frame is a whole
+    // number of PBFDAF blocks. Frames with less than kPBFDAFMinBlock in that
+    // factor (441 samples at 44.1 kHz) use kPBFDAFMinBlock and end in a
+    // partial block, which the filter handles at the cost of one more
+    // transform pair per frame; smaller blocks would cost a partition per
+    // few taps.
+    static constexpr uint32_t kPBFDAFMinBlock = 32;
+    static uint32_t pbfdaf_block_size(uint32_t frame_size) {
+        if (frame_size == 0) return 64;
+        uint32_t block = frame_size & (~frame_size + 1);
+        return std::min<uint32_t>(std::max(block, kPBFDAFMinBlock), 1024);
+    }
+
     AECConfig config;
-    std::vector<std::unique_ptr<NLMSFilter>> nlms_filters;
-    std::vector<DoubleTalkDetector> dtds;
+    Arena arena;
+    Arena* memory; // the arena, or the counting one while sizing
+    bool fixed_path; // Q15 NLMS on raw int16 samples, otherwise float engines
+    ArenaVector<ArenaPtr<AdaptiveFilter>> filters;
+    ArenaVector<float> far_block; // block_size samples per channel
+    ArenaVector<float> near_block;
+    ArenaVector<float> out_block;
+    ArenaVector<int16_t> far_q15; // the same slices for int16 samples
+    ArenaVector<int16_t> near_q15;
+    ArenaVector<int16_t> out_q15;
+    uint32_t block_size = 0;
+    MultiChannelDoubleTalkDetector dtd;
+    ArenaVector<ArenaPtr<ResidualEchoSuppressor>> suppressors; // config.enable_residual_echo_suppression
+    // The chunk being processed, shared with the channel tasks
+    struct ChunkJob {
+        Planes<int16_t> q15;
+        Planes<float> f32;
+        bool float_samples; // which of the two the chunk is in
+        uint32_t frame_size;
+        uint32_t ch;
+        bool adapt[AECConfig::max_channels];
+        bool ok[AECConfig::max_channels];
+    } job{};
+    // Smoothed powers behind the echo metrics
+    struct EchoPowers {
+        double far = 0.0;
+        double near = 0.0;
+        double residual = 0.0;
+        uint64_t frames = 0;
+        bool double_talk = false;
+    };
+    static constexpr double kFarActive = 1e-6; // -60 dBFS
+    static constexpr double kPowerFloor = 1e-15;
+    EchoPowers echo[AECConfig::max_channels];
+    double metrics_alpha;
+    // Parallel channels (config.worker_threads)
+    std::unique_ptr<WorkerPool> pool;
+    // Bulk delay compensation (config.enable_delay_estimation)
+    ArenaPtr<DelayEstimator> delay_estimator;
+    ArenaVector<float> far_ring; // ring_length samples per channel
+    ArenaVector<int16_t> delayed_q15; // block_size samples per channel
+    ArenaVector<float> delayed_f32;
+    uint32_t ring_channels = 0;
+    uint32_t ring_length = 0;
+    uint32_t ring_pos = 0;
+    uint32_t applied_delay = 0;
     uint64_t total_samples_processed;
     uint64_t total_processing_time_ns;
+    // Stage histograms (AEC_ENABLE_TIMING), read by monitoring threads
+    StageRecorder timing;
 };
 
 // AEC implementation
@@ -97,12 +791,37 @@ AEC::~AEC() = default;
 
 bool AEC::process(const int16_t* far_end, const int16_t* near_end,
                   int16_t* output, uint32_t frame_size, uint32_t channels) {
-    return pimpl->process(far_end, near_end, output, frame_size, channels);
+    AEC_TRACE_SCOPE("AEC::process");
+    return pimpl->process_interleaved(far_end, near_end, output, frame_size, channels);
+}
+
+bool AEC::process(const float* const* far_end, const float* const* near_end,
+                  float* const* output, uint32_t frame_size, uint32_t channels) {
+    AEC_TRACE_SCOPE("AEC::process");
+    return pimpl->process_planar(far_end, near_end, output, frame_size, channels);
+}
+
+bool AEC::process(const int16_t* const* far_end, const int16_t* const* near_end,
+                  int16_t* const* output, uint32_t frame_size, uint32_t channels) {
+    AEC_TRACE_SCOPE("AEC::process");
+    return pimpl->process_planar(far_end, near_end, output, frame_size, channels);
 }
 
 void AEC::reset() { pimpl->reset(); }
+size_t AEC::state_size() const { return pimpl->state_size(); }
+bool AEC::save_state(void* buffer, size_t capacity) const { return pimpl->save_state(buffer, capacity); }
+bool AEC::save_state(std::vector<uint8_t>& out) const { return pimpl->save_state(out); }
+bool AEC::load_state(const void* data, size_t size) { return pimpl->load_state(data, size); }
 double AEC::get_erle() const { return pimpl->get_erle(); }
 double AEC::get_latency_ms() const { return pimpl->get_latency_ms(); }
+AECMetrics AEC::get_metrics() const { return pimpl->get_metrics(); }
+TimingStats AEC::get_timing() const { return pimpl->get_timing(); }
+void AEC::reset_timing() { pimpl->reset_timing(); }
+uint32_t AEC::get_estimated_delay() const { return pimpl->get_estimated_delay(); }
+float AEC::get_delay_confidence() const { return pimpl->get_delay_confidence(); }
+uint32_t AEC::get_applied_delay() const { return pimpl->get_applied_delay(); }
+DTDTierCounters AEC::get_dtd_tier_counters() const { return pimpl->get_dtd_tier_counters(); }
+size_t AEC::memory_footprint() const { return pimpl->memory_footprint(); }
 
 std::unique_ptr<AEC> create_aec(const AECConfig& config) {
     return std::make_unique<AEC>(config);
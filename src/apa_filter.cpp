@@ -0,0 +1,308 @@
+#include "aec/apa_filter.hpp"
+#include "aec/simd_kernels.hpp"
+#include <vector>
+#include <initializer_list>
+#include <algorithm>
+#include <cmath>
+
+namespace aec {
+
+// Notation (Gay & Tavathia FAP, Gauss-Seidel solver after Albu et al.):
+//   x(n)    regressor [x(n), x(n-1), ..., x(n-L+1)]
+//   r(n)    sliding correlation r_k = x(n)^T x(n-k), k < N
+//   w_hat   auxiliary coefficients; the true filter is
+//           w = w_hat + mu * sum_k x(n-1-k) E_k(n-1), k < N-1
+//   R(n)    N x N matrix of x(n-i)^T x(n-j), built by shifting R(n-1)
+//   p(n)    first column of (R(n) + reg I)^-1, tracked by Gauss-Seidel
+//   e(n)    = [e(n); (1 - mu) e(n-1)]              (a priori error vector)
+//   eps(n)  = (R(n) + reg I)^-1 e(n)               (projected error)
+//   E(n)    = [0; E(n-1)] + eps(n)                 (accumulated error)
+// Only the oldest entry of E touches w_hat, so each sample costs one L-tap
+// dot product, one L-tap axpy and O(N^2) for the small system.
+class APAFilter::Impl {
+public:
+    Impl(uint32_t length, uint32_t order, float mu, float delta, Arena* arena)
+        : filter_length(std::max<uint32_t>(1, length)),
+          proj_order(std::min(std::max<uint32_t>(1, order), std::min<uint32_t>(32, std::max<uint32_t>(1, length)))),
+          history_length(filter_length + proj_order),
+          mu(std::min(std::max(static_cast<double>(mu), 1e-4), 1.0)),
+          regularization_floor(static_cast<double>(delta) + 1e-5 * static_cast<double>(filter_length)),
+          kernels(simd::kernels()),
+          w_hat(arena), history(arena), r(arena), R(arena), unit(arena), p(arena), err(arena), eps(arena),
+          E(arena) {
+        reset();
+    }
+
+    void reset() {
+        w_hat.assign(filter_length, 0.0f);
+        history.assign(2 * static_cast<size_t>(history_length), 0.0f);
+        r.assign(proj_order, 0.0);
+        R.assign(static_cast<size_t>(proj_order) * proj_order, 0.0);
+        p.assign(proj_order, 0.0);
+        unit.assign(proj_order, 0.0);
+        unit[0] = 1.0;
+        err.assign(proj_order, 0.0);
+        eps.assign(proj_order, 0.0);
+        E.assign(proj_order, 0.0);
+        pos = 0;
+        samples_since_refresh = 0;
+        pending = false;
+    }
+
+    void save_state(StateWriter& out) const {
+        for (const ArenaVector<double>* v : {&r, &R, &p, &err, &eps, &E}) out.put(*v);
+        out.put(w_hat);
+        out.put(history);
+        out.put(regularization);
+        out.put(pos);
+        out.put(samples_since_refresh);
+        out.put(pending);
+    }
+
+    bool load_state(StateReader& in) {
+        for (ArenaVector<double>* v : {&r, &R, &p, &err, &eps, &E}) {
+            if (!in.get(*v)) return false;
+        }
+        if (!in.get(w_hat) || !in.get(history) || !in.get(regularization) || !in.get(pos) ||
+            !in.get(samples_since_refresh) || !in.get(pending)) {
+            return false;
+        }
+        if (pos >= history_length) return in.fail();
+        return true;
+    }
+
+    float process(float far_end, float near_end, bool adapt) {
+        push(far_end);
+        update_correlation();
+
+        const float* x = &history[pos];
+        if (!adapt) {
+            if (pending) fold_pending();
+            return near_end - kernels.dot_f32(w_hat.data(), x, filter_length);
+        }
+
+        // Output of the true filter w(n-1) from w_hat and the pending E
+        double y = kernels.dot_f32(w_hat.data(), x, filter_length);
+        for (uint32_t k = 1; k < proj_order; ++k) y += mu * r[k] * E[k - 1];
+        const double e = static_cast<double>(near_end) - y;
+
+        project(e);
+        for (uint32_t k = proj_order - 1; k > 0; --k) E[k] = E[k - 1] + eps[k];
+        E[0] = eps[0];
+
+        // The oldest regressor leaves the projection: commit its share
+        const float* x_oldest = &history[pos + proj_order - 1];
+        kernels.axpy_f32(static_cast<float>(mu * E[proj_order - 1]), x_oldest, w_hat.data(), filter_length);
+        pending = true;
+
+        return static_cast<float>(e);
+    }
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) {
+        for (size_t j = 0; j < n; ++j) {
+            out[j * stride] = process(far[j * stride], near[j * stride], adapt);
+        }
+        return true;
+    }
+
+    float get_coeff_norm() const {
+        // True filter is w_hat plus the not-yet-committed projections, using
+        // the regressors x(n-1-k) relative to the next sample
+        double sum = 0.0;
+        for (uint32_t i = 0; i < filter_length; ++i) {
+            double w = w_hat[i];
+            for (uint32_t k = 0; k + 1 < proj_order; ++k) {
+                w += mu * E[k] * history[pos + k + i];
+            }
+            sum += w * w;
+        }
+        return static_cast<float>(std::sqrt(sum));
+    }
+
+    uint32_t get_order() const { return proj_order; }
+
+private:
+    void push(float sample) {
+        pos = (pos == 0) ? history_length - 1 : pos - 1;
+        history[pos] = sample;
+        history[pos + history_length] = sample;
+    }
+
+    // x(n-k) for k < history_length
+    double past(uint32_t k) const { return history[pos + k]; }
+
+    void update_correlation() {
+        if (++samples_since_refresh >= filter_length) {
+            // Exact recompute once per filter length bounds the drift of the
+            // recursive sums
+            samples_since_refresh = 0;
+            for (uint32_t k = 0; k < proj_order; ++k) {
+                r[k] = kernels.dot_f32(&history[pos], &history[pos + k], filter_length);
+            }
+        } else {
+            const double x_new = past(0);
+            const double x_old = past(filter_length);
+            for (uint32_t k = 0; k < proj_order; ++k) {
+                r[k] += x_new * past(k) - x_old * past(filter_length + k);
+            }
+        }
+
+        // R(n): lower-right block is R(n-1)'s upper-left, first row/col is r(n)
+        const uint32_t N = proj_order;
+        for (uint32_t i = N - 1; i > 0; --i) {
+            for (uint32_t j = N - 1; j > 0; --j) R[i * N + j] = R[(i - 1) * N + (j - 1)];
+        }
+        for (uint32_t k = 0; k < N; ++k) {
+            R[k] = r[k];
+            R[k * N] = r[k];
+        }
+
+        // Regularize relative to the window energy as well: speech leaves
+        // some bands nearly unexcited, and an absolute floor alone lets the
+        // projection blow up coefficients there when the far-end resumes
+        regularization = regularization_floor + kRelativeRegularization * std::max(0.0, r[0]);
+    }
+
+    // eps(n) = (R(n) + reg I)^-1 e(n) with the FAP error vector
+    // e(n) = [e; (1 - mu) e(n-1)]. The first column p(n) is tracked with
+    // Gauss-Seidel warm-started from p(n-1); R changes slowly, so one sweep
+    // normally suffices. e p + (1 - mu) [0; eps(n-1)] is then a close guess
+    // for eps, refined in place when mu < 1. A solve that does not settle
+    // within a few sweeps (ill-conditioned R, or far-end resuming after
+    // silence) drops to the next safer direction for this sample: e p, and
+    // if p itself is off, NLMS. The p iterate is kept so the next sample
+    // still starts warm.
+    void project(double e) {
+        const uint32_t N = proj_order;
+        const double leak = 1.0 - mu;
+        const bool p_settled = gauss_seidel(unit.data(), p.data(), kResidualTolerance);
+
+        for (uint32_t k = N - 1; k > 0; --k) {
+            err[k] = leak * err[k - 1];
+            eps[k] = e * p[k] + leak * eps[k - 1];
+        }
+        err[0] = e;
+        eps[0] = e * p[0];
+
+        bool settled = p_settled;
+        if (settled && leak != 0.0) {
+            double scale = 0.0;
+            for (double v : err) scale = std::max(scale, std::fabs(v));
+            settled = gauss_seidel(err.data(), eps.data(), kResidualTolerance * scale);
+        }
+        if (!settled) {
+            std::fill(err.begin() + 1, err.end(), 0.0);
+            if (p_settled) {
+                for (uint32_t k = 0; k < N; ++k) eps[k] = e * p[k];
+            } else {
+                std::fill(eps.begin(), eps.end(), 0.0);
+                eps[0] = e / (R[0] + regularization);
+            }
+        }
+    }
+
+    // Solves (R + reg I) x = rhs in place from the current x; returns false
+    // if the max-norm residual is still above tolerance after kMaxSweeps
+    bool gauss_seidel(const double* rhs, double* x, double tolerance) const {
+        const uint32_t N = proj_order;
+        for (uint32_t sweep = 0; sweep < kMaxSweeps; ++sweep) {
+            for (uint32_t i = 0; i < N; ++i) {
+                double s = rhs[i];
+                const double* row = &R[static_cast<size_t>(i) * N];
+                for (uint32_t j = 0; j < N; ++j) {
+                    if (j != i) s -= row[j] * x[j];
+                }
+                x[i] = s / (row[i] + regularization);
+            }
+            if (N == 1 || residual(rhs, x) <= tolerance) return true;
+        }
+        return false;
+    }
+
+    double residual(const double* rhs, const double* x) const {
+        const uint32_t N = proj_order;
+        double worst = 0.0;
+        for (uint32_t i = 0; i < N; ++i) {
+            const double* row = &R[static_cast<size_t>(i) * N];
+            double q = regularization * x[i] - rhs[i];
+            for (uint32_t j = 0; j < N; ++j) q += row[j] * x[j];
+            worst = std::max(worst, std::fabs(q));
+        }
+        return worst;
+    }
+
+    // Commit the pending projections into w_hat so it alone is the filter
+    void fold_pending() {
+        for (uint32_t k = 0; k + 1 < proj_order; ++k) {
+            // Regressor x(n-1-k) relative to the sample just pushed
+            kernels.axpy_f32(static_cast<float>(mu * E[k]), &history[pos + k + 1], w_hat.data(), filter_length);
+        }
+        std::fill(err.begin(), err.end(), 0.0);
+        std::fill(eps.begin(), eps.end(), 0.0);
+        std::fill(E.begin(), E.end(), 0.0);
+        pending = false;
+    }
+
+    static constexpr double kRelativeRegularization = 1e-2;
+    static constexpr uint32_t kMaxSweeps = 4;
+    static constexpr double kResidualTolerance = 0.25;
+
+    uint32_t filter_length;
+    uint32_t proj_order;
+    uint32_t history_length;
+    double mu;
+    double regularization_floor;
+    double regularization = 0.0;
+    const simd::Kernels& kernels;
+
+    ArenaVector<float> w_hat;
+    ArenaVector<float> history; // mirrored, newest sample at history[pos]
+    ArenaVector<double> r;
+    ArenaVector<double> R;      // proj_order x proj_order, row-major
+    ArenaVector<double> unit;   // [1, 0, ..., 0]
+    ArenaVector<double> p;
+    ArenaVector<double> err;
+    ArenaVector<double> eps;
+    ArenaVector<double> E;
+    uint32_t pos = 0;
+    uint32_t samples_since_refresh = 0;
+    bool pending = false;
+};
+
+// APAFilter implementation
+APAFilter::APAFilter(uint32_t length, uint32_t order, float mu, float delta, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, length, order, mu, delta, arena)) {}
+
+APAFilter::~APAFilter() = default;
+
+float APAFilter::process(float far_end, float near_end, bool adapt) {
+    return pimpl->process(far_end, near_end, adapt);
+}
+
+bool APAFilter::process_block(const float* far, const float* near, float* out,
+                              size_t n, size_t stride, bool adapt) {
+    return pimpl->process_block(far, near, out, n, stride, adapt);
+}
+
+void APAFilter::reset() {
+    pimpl->reset();
+}
+
+void APAFilter::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool APAFilter::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
+float APAFilter::get_coeff_norm() const {
+    return pimpl->get_coeff_norm();
+}
+
+uint32_t APAFilter::order() const {
+    return pimpl->get_order();
+}
+
+} // namespace aec
@@ -0,0 +1,78 @@
+#include "aec/arena.hpp"
+#include <algorithm>
+#include <cstdlib>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace aec {
+
+static constexpr size_t kHugePage = size_t(2) << 20;
+
+Arena::Arena(size_t capacity, bool huge_pages) : size(round_up(capacity)) {
+    if (size == 0) return;
+#if defined(__linux__)
+    if (huge_pages) {
+        const size_t length = (size + kHugePage - 1) / kHugePage * kHugePage;
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            huge = true;
+        } else {
+            // No reserved huge pages: ask for transparent ones instead
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) p = nullptr;
+#if defined(MADV_HUGEPAGE)
+            if (p) huge = madvise(p, length, MADV_HUGEPAGE) == 0;
+#endif
+        }
+        if (p) {
+            base = static_cast<char*>(p);
+            size = length;
+            mapped = true;
+            return;
+        }
+    }
+#else
+    (void)huge_pages;
+#endif
+#if defined(_WIN32)
+    base = static_cast<char*>(_aligned_malloc(size, alignment));
+#else
+    void* p = nullptr;
+    base = posix_memalign(&p, alignment, size) == 0 ? static_cast<char*>(p) : nullptr;
+#endif
+    if (!base) size = 0;
+}
+
+Arena::~Arena() {
+    if (!base) return;
+#if defined(__linux__)
+    if (mapped) {
+        munmap(base, size);
+        return;
+    }
+#endif
+#if defined(_WIN32)
+    _aligned_free(base);
+#else
+    std::free(base);
+#endif
+}
+
+void* Arena::allocate(size_t bytes, size_t align) {
+    align = std::max(align, alignment);
+    const size_t start = (offset + align - 1) & ~(align - 1);
+    if (!base) {
+        // Counting: record the space, let the caller use the heap
+        offset = start + round_up(bytes);
+        return nullptr;
+    }
+    if (start + bytes > size) return nullptr;
+    offset = start + round_up(bytes);
+    return base + start;
+}
+
+} // namespace aec
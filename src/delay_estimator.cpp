@@ -0,0 +1,224 @@
+#include "aec/delay_estimator.hpp"
+#include "aec/fft.hpp"
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+
+namespace aec {
+
+// The search runs on both signals decimated by `decimation` (boxcar average,
+// enough of a low-pass for a correlation peak), which divides the FFT size
+// and the analysis rate; the echo canceller's headroom taps absorb the
+// coarser resolution. In decimated samples, each analysis lays out one FFT
+// frame of size N >= max_lag + window:
+//   far:  x(t - max_lag - window + 1) .. x(t)     at [0, max_lag + window)
+//   near: y(t - window + 1) .. y(t)               at [max_lag, max_lag + window)
+// so the circular cross-correlation IFFT(Y conj(X)) at index k is the linear
+// correlation of the near window with the far end delayed by k, for every
+// k <= max_lag, with no wrap-around.
+class DelayEstimator::Impl {
+public:
+    Impl(uint32_t max_delay, uint32_t window, uint32_t decimation, Arena* arena)
+        : factor(std::max<uint32_t>(1, decimation)),
+          max_lag((max_delay + factor - 1) / factor),
+          window_length(round_up_pow2(std::max<uint32_t>(window / factor, 64))),
+          fft_size(round_up_pow2(max_lag + window_length)),
+          fft(fft_size, arena),
+          far_history(arena), near_history(arena), time_buf(arena), far_spectrum(arena),
+          near_spectrum(arena), cross(arena), correlation(arena) {
+        far_history.resize(static_cast<size_t>(max_lag) + window_length);
+        near_history.resize(window_length);
+        time_buf.resize(fft_size);
+        far_spectrum.resize(fft.bins());
+        near_spectrum.resize(fft.bins());
+        cross.resize(fft.bins());
+        correlation.resize(fft_size);
+        reset();
+    }
+
+    void reset() {
+        std::fill(far_history.begin(), far_history.end(), 0.0f);
+        std::fill(near_history.begin(), near_history.end(), 0.0f);
+        std::fill(cross.begin(), cross.end(), std::complex<float>(0.0f, 0.0f));
+        pending = 0;
+        phase = 0;
+        far_acc = near_acc = 0.0f;
+        analyses = 0;
+        estimate = 0;
+        estimate_confidence = 0.0f;
+    }
+
+    void save_state(StateWriter& out) const {
+        out.put(far_history);
+        out.put(near_history);
+        out.put(cross);
+        out.put(pending);
+        out.put(phase);
+        out.put(far_acc);
+        out.put(near_acc);
+        out.put(analyses);
+        out.put(estimate);
+        out.put(estimate_confidence);
+    }
+
+    bool load_state(StateReader& in) {
+        if (!in.get(far_history) || !in.get(near_history) || !in.get(cross) || !in.get(pending) ||
+            !in.get(phase) || !in.get(far_acc) || !in.get(near_acc) || !in.get(analyses) || !in.get(estimate) ||
+            !in.get(estimate_confidence)) {
+            return false;
+        }
+        if (pending >= window_length || phase >= factor || estimate > max_lag) return in.fail();
+        return true;
+    }
+
+    template <typename T>
+    bool update(const T* far, const T* near, uint32_t n, uint32_t stride) {
+        bool updated = false;
+        const float scale = 1.0f / (32768.0f * static_cast<float>(factor));
+        for (uint32_t i = 0; i < n; ++i) {
+            far_acc += pcm(far[i * stride]);
+            near_acc += pcm(near[i * stride]);
+            if (++phase < factor) continue;
+            far_history[far_history.size() - window_length + pending] = far_acc * scale;
+            near_history[pending] = near_acc * scale;
+            far_acc = near_acc = 0.0f;
+            phase = 0;
+            if (++pending == window_length) {
+                updated |= analyze();
+                // Slide the far history by one window; the near window is
+                // overwritten by the next one
+                std::copy(far_history.begin() + window_length, far_history.end(), far_history.begin());
+                pending = 0;
+            }
+        }
+        return updated;
+    }
+
+    uint32_t get_delay() const { return estimate * factor; }
+    float get_confidence() const { return estimate_confidence; }
+    uint32_t get_max_delay() const { return max_lag * factor; }
+
+private:
+    // Accumulation runs on the int16 scale; float samples are scaled up by a
+    // power of two, which is exact
+    static float pcm(int16_t v) { return static_cast<float>(v); }
+    static float pcm(float v) { return v * 32768.0f; }
+
+    static uint32_t round_up_pow2(uint32_t v) {
+        uint32_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    bool analyze() {
+        // Skip windows without far-end or near-end activity: they carry no
+        // delay information and would only pull the smoothed spectrum to zero
+        double far_energy = 0.0, near_energy = 0.0;
+        for (float v : far_history) far_energy += static_cast<double>(v) * v;
+        for (float v : near_history) near_energy += static_cast<double>(v) * v;
+        if (far_energy < kMinPower * far_history.size() || near_energy < kMinPower * near_history.size()) {
+            return false;
+        }
+
+        std::fill(time_buf.begin(), time_buf.end(), 0.0f);
+        std::copy(far_history.begin(), far_history.end(), time_buf.begin());
+        fft.forward(time_buf.data(), far_spectrum.data());
+
+        std::fill(time_buf.begin(), time_buf.end(), 0.0f);
+        std::copy(near_history.begin(), near_history.end(), time_buf.begin() + max_lag);
+        fft.forward(time_buf.data(), near_spectrum.data());
+
+        // Faster smoothing while the first analyses come in
+        ++analyses;
+        const float beta = std::max(kSmoothing, 1.0f / static_cast<float>(analyses));
+        for (size_t k = 0; k < cross.size(); ++k) {
+            std::complex<float> c = near_spectrum[k] * std::conj(far_spectrum[k]);
+            const float mag = std::abs(c);
+            c = mag > 1e-20f ? c / mag : std::complex<float>(0.0f, 0.0f);
+            cross[k] += beta * (c - cross[k]);
+        }
+        fft.inverse(cross.data(), correlation.data());
+
+        uint32_t best = 0;
+        for (uint32_t k = 1; k <= max_lag; ++k) {
+            if (correlation[k] > correlation[best]) best = k;
+        }
+        // Confidence is how far the peak stands above the strongest lag
+        // outside its main lobe: close to 1 for a single clear echo, close
+        // to 0 when several lags are equally plausible
+        float runner_up = 0.0f;
+        for (uint32_t k = 0; k <= max_lag; ++k) {
+            if (k + kMainLobe < best || k > best + kMainLobe) runner_up = std::max(runner_up, correlation[k]);
+        }
+        const float peak = correlation[best];
+        estimate = best;
+        estimate_confidence = peak > 0.0f ? std::max(0.0f, 1.0f - runner_up / peak) : 0.0f;
+        return true;
+    }
+
+    static constexpr float kSmoothing = 0.2f;
+    static constexpr uint32_t kMainLobe = 2;
+    static constexpr double kMinPower = 1e-8; // about -80 dBFS
+
+    uint32_t factor;
+    uint32_t max_lag; // in decimated samples, like window_length
+    uint32_t window_length;
+    uint32_t fft_size;
+    RealFFT fft;
+
+    ArenaVector<float> far_history;  // oldest first, newest window at the end
+    ArenaVector<float> near_history; // current window
+    ArenaVector<float> time_buf;
+    ArenaVector<std::complex<float>> far_spectrum;
+    ArenaVector<std::complex<float>> near_spectrum;
+    ArenaVector<std::complex<float>> cross; // smoothed PHAT cross-spectrum
+    ArenaVector<float> correlation;
+    uint32_t pending = 0; // decimated samples of the current window so far
+    uint32_t phase = 0;   // input samples in the current decimation group
+    float far_acc = 0.0f;
+    float near_acc = 0.0f;
+    uint32_t analyses = 0;
+    uint32_t estimate = 0;
+    float estimate_confidence = 0.0f;
+};
+
+// DelayEstimator implementation
+DelayEstimator::DelayEstimator(uint32_t max_delay, uint32_t window, uint32_t decimation, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, max_delay, window, decimation, arena)) {}
+
+DelayEstimator::~DelayEstimator() = default;
+
+void DelayEstimator::reset() {
+    pimpl->reset();
+}
+
+void DelayEstimator::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool DelayEstimator::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
+bool DelayEstimator::update(const int16_t* far, const int16_t* near, uint32_t n, uint32_t stride) {
+    return pimpl->update(far, near, n, stride);
+}
+
+bool DelayEstimator::update(const float* far, const float* near, uint32_t n, uint32_t stride) {
+    return pimpl->update(far, near, n, stride);
+}
+
+uint32_t DelayEstimator::delay() const {
+    return pimpl->get_delay();
+}
+
+float DelayEstimator::confidence() const {
+    return pimpl->get_confidence();
+}
+
+uint32_t DelayEstimator::max_delay() const {
+    return pimpl->get_max_delay();
+}
+
+} // namespace aec
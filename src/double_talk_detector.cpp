@@ -1,139 +1,246 @@
 #include "aec/double_talk_detector.hpp"
+#include "aec/trace.hpp"
 #include <cmath>
 #include <algorithm>
 
 namespace aec {
 
+// Samples on the [-1, 1) scale the detector works in. Scaling by a power of
+// two is exact, so int16 frames and the same frames as float agree bit for bit.
+static inline double unit(int16_t v) { return static_cast<double>(v) / 32768.0; }
+static inline double unit(float v) { return static_cast<double>(v); }
+
 DoubleTalkDetector::DoubleTalkDetector(uint32_t frame_size,
                                        float near_to_far_threshold,
                                        float coherence_threshold,
                                        float smoothing_alpha,
                                        uint32_t hangover_frames,
                                        bool use_frequency,
-                                       uint32_t freq_bins)
+                                       uint32_t freq_bins,
+                                       bool tiered,
+                                       float tier_near_ratio,
+                                       Arena* arena)
     : alpha(smoothing_alpha), sm_far(0.0f), sm_near(0.0f), sm_cross(0.0f),
       near_to_far_threshold(near_to_far_threshold), coherence_threshold(coherence_threshold),
       min_near_energy(1e-8f), hangover_frames(hangover_frames), hangover_counter(0),
-      adapt_allowed(true) {
-    (void)frame_size; // used indirectly when frequency mode chosen
-    this->use_frequency = use_frequency;
+      adapt_allowed(true), tiered(tiered), tier_near_ratio(tier_near_ratio),
+      use_frequency(use_frequency), fft_size(use_frequency ? transform_size(frame_size) : 0),
+      Sxx_sm(arena), Syy_sm(arena), Sxy_sm(arena), fft(use_frequency ? fft_size : 2, arena),
+      far_frame(arena), near_frame(arena), X(arena), Y(arena) {
     if (use_frequency) {
-        // Use frame_size as FFT size; keep only positive bins
-        fft_size = frame_size;
-        if (fft_size == 0) fft_size = 256;
+        // Keep only positive bins
         uint32_t max_bins = fft_size / 2;
         if (freq_bins == 0 || freq_bins > max_bins) freq_bins = max_bins;
         this->freq_bins = freq_bins;
         Sxx_sm.assign(this->freq_bins, 0.0);
         Syy_sm.assign(this->freq_bins, 0.0);
         Sxy_sm.assign(this->freq_bins, std::complex<double>(0.0, 0.0));
+        far_frame.resize(fft_size);
+        near_frame.resize(fft_size);
+        X.resize(fft.bins());
+        Y.resize(fft.bins());
     } else {
         this->freq_bins = 0;
     }
 }
 
+uint32_t DoubleTalkDetector::transform_size(uint32_t frame_size) {
+    if (frame_size == 0) return 256;
+    uint32_t size = 2;
+    while (size < frame_size) size <<= 1;
+    return size;
+}
+
 void DoubleTalkDetector::reset() {
     sm_far = sm_near = sm_cross = 0.0f;
     hangover_counter = 0;
     adapt_allowed = true;
+    counters = DTDTierCounters();
+}
+
+void DoubleTalkDetector::save_state(StateWriter& out) const {
+    out.put(sm_far);
+    out.put(sm_near);
+    out.put(sm_cross);
+    out.put(hangover_counter);
+    out.put(adapt_allowed);
+    out.put(Sxx_sm);
+    out.put(Syy_sm);
+    out.put(Sxy_sm);
+    out.put(last_coherence);
+    out.put(last_ratio);
+}
+
+bool DoubleTalkDetector::load_state(StateReader& in) {
+    return in.get(sm_far) && in.get(sm_near) && in.get(sm_cross) && in.get(hangover_counter) &&
+           in.get(adapt_allowed) && in.get(Sxx_sm) && in.get(Syy_sm) && in.get(Sxy_sm) &&
+           in.get(last_coherence) && in.get(last_ratio);
 }
 
 bool DoubleTalkDetector::update(const int16_t* far, const int16_t* near, uint32_t frame_size, uint32_t stride) {
+    return update_frame(far, near, frame_size, stride);
+}
+
+bool DoubleTalkDetector::update(const float* far, const float* near, uint32_t frame_size, uint32_t stride) {
+    return update_frame(far, near, frame_size, stride);
+}
+
+template <typename T>
+bool DoubleTalkDetector::update_frame(const T* far, const T* near, uint32_t frame_size, uint32_t stride) {
+    AEC_TRACE_SCOPE("DoubleTalkDetector::update");
+    has_spectra = false;
     // Time-domain energies (as fallback or to be combined)
     double far_pow = 0.0;
     double near_pow = 0.0;
+    double cross_pow = 0.0;
     for (uint32_t i = 0; i < frame_size; ++i) {
-        double f = static_cast<double>(far[i * stride]) / 32768.0;
-        double n = static_cast<double>(near[i * stride]) / 32768.0;
+        double f = unit(far[i * stride]);
+        double n = unit(near[i * stride]);
         far_pow += f * f;
         near_pow += n * n;
+        cross_pow += f * n;
     }
 
     far_pow /= static_cast<double>(frame_size);
     near_pow /= static_cast<double>(frame_size);
+    cross_pow /= static_cast<double>(frame_size);
 
-    // Update smoothed time-domain energies
-    sm_far = alpha * sm_far + (1.0f - alpha) * static_cast<float>(far_pow);
-    sm_near = alpha * sm_near + (1.0f - alpha) * static_cast<float>(near_pow);
-
-    bool dt_detected = false;
+    smooth_powers(far_pow, near_pow, cross_pow);
+    if (!use_frequency || freq_bins == 0) return finish(time_double_talk());
 
-    if (use_frequency && freq_bins > 0) {
-        // Compute naive DFT for near and far (only positive bins up to freq_bins)
-        // X[k] = sum_n x[n] * exp(-j*2pi*k*n/N)
-        std::vector<std::complex<double>> X(freq_bins);
-        std::vector<std::complex<double>> Y(freq_bins);
-        const double TWO_PI = 2.0 * M_PI;
-        for (uint32_t k = 0; k < freq_bins; ++k) {
-            std::complex<double> accX(0.0, 0.0);
-            std::complex<double> accY(0.0, 0.0);
-            for (uint32_t n = 0; n < frame_size; ++n) {
-                double angle = -TWO_PI * static_cast<double>(k) * static_cast<double>(n) / static_cast<double>(fft_size);
-                std::complex<double> w(std::cos(angle), std::sin(angle));
-                double f = static_cast<double>(far[n * stride]) / 32768.0;
-                double m = static_cast<double>(near[n * stride]) / 32768.0;
-                accX += w * f;
-                accY += w * m;
-            }
-            X[k] = accX;
-            Y[k] = accY;
-        }
+    // Frames the energy gate settles skip the transforms unless a later
+    // stage wants the spectra
+    Tier tier = classify();
+    if (tier != Tier::Coherence && !keep_spectra) return finish(tier == Tier::NearOnly);
 
-        // Update smoothed spectra
-        // Compute per-bin smoothed PSD/CSD and then compute a coherence averaged
-        // across bins that have significant joint energy. This avoids spuriously
-        // large coherence when signals occupy different frequency regions.
-        double max_sxx = 0.0;
-        double max_syy = 0.0;
-        for (uint32_t k = 0; k < freq_bins; ++k) {
-            double px = std::norm(X[k]);
-            double py = std::norm(Y[k]);
-            std::complex<double> pxy = X[k] * std::conj(Y[k]);
-
-            Sxx_sm[k] = static_cast<double>(alpha) * Sxx_sm[k] + (1.0 - static_cast<double>(alpha)) * px;
-            Syy_sm[k] = static_cast<double>(alpha) * Syy_sm[k] + (1.0 - static_cast<double>(alpha)) * py;
-            Sxy_sm[k] = static_cast<double>(alpha) * Sxy_sm[k] + (1.0 - static_cast<double>(alpha)) * pxy;
-
-            if (Sxx_sm[k] > max_sxx) max_sxx = Sxx_sm[k];
-            if (Syy_sm[k] > max_syy) max_syy = Syy_sm[k];
-        }
+    // X[k] = sum_n x[n] * exp(-j*2pi*k*n/N) for near and far. A frame
+    // longer than the transform is folded onto it, which gives the same
+    // bins as the direct sum.
+    std::fill(far_frame.begin(), far_frame.end(), 0.0);
+    std::fill(near_frame.begin(), near_frame.end(), 0.0);
+    for (uint32_t n = 0, pos = 0; n < frame_size; ++n) {
+        far_frame[pos] += unit(far[n * stride]);
+        near_frame[pos] += unit(near[n * stride]);
+        if (++pos == fft_size) pos = 0;
+    }
+    fft.forward(far_frame.data(), X.data());
+    fft.forward(near_frame.data(), Y.data());
+    has_spectra = true;
+    if (tier != Tier::Coherence) return finish(tier == Tier::NearOnly);
+    const double* y = reinterpret_cast<const double*>(Y.data());
+    return finish(coherence_double_talk(X.data(), y, y + 1, 2));
+}
 
-        double sum_coh = 0.0;
-        uint32_t valid_bins = 0;
-        double denom_threshold = 1e-6 * max_sxx * max_syy + 1e-24;
-        for (uint32_t k = 0; k < freq_bins; ++k) {
-            double denom = Sxx_sm[k] * Syy_sm[k];
-            if (denom >= denom_threshold) {
-                double coh = std::norm(Sxy_sm[k]) / (denom + 1e-24);
-                sum_coh += coh;
-                ++valid_bins;
-            }
-        }
+DTDSpectra DoubleTalkDetector::spectra() const {
+    DTDSpectra s;
+    if (!has_spectra) return s;
+    const double* y = reinterpret_cast<const double*>(Y.data());
+    s.far = X.data();
+    s.near_re = y;
+    s.near_im = y + 1;
+    s.stride = 2;
+    s.bins = fft.bins();
+    return s;
+}
 
-        double avg_coh = (valid_bins == 0) ? 0.0 : (sum_coh / static_cast<double>(valid_bins));
-        last_coherence = avg_coh;
+void DoubleTalkDetector::smooth_powers(double far_pow, double near_pow, double cross_pow) {
+    sm_far = alpha * sm_far + (1.0f - alpha) * static_cast<float>(far_pow);
+    sm_near = alpha * sm_near + (1.0f - alpha) * static_cast<float>(near_pow);
+    sm_cross = alpha * sm_cross + (1.0f - alpha) * static_cast<float>(cross_pow);
+}
 
-        // Combine time-domain power ratio with frequency coherence
-        if (sm_near >= min_near_energy) {
+DoubleTalkDetector::Tier DoubleTalkDetector::classify() {
+    Tier tier = Tier::Coherence;
+    if (tiered) {
+        // The same tests coherence_double_talk() applies before it looks at
+        // coherence, plus a ratio high enough that echo cannot explain it
+        if (sm_near < min_near_energy) {
+            tier = Tier::Silent;
+        } else {
             double ratio = sm_near / (sm_far + 1e-12);
             last_ratio = ratio;
-            if (ratio > near_to_far_threshold && avg_coh < coherence_threshold) {
-                dt_detected = true;
+            if (ratio <= near_to_far_threshold) {
+                tier = Tier::FarOnly;
+            } else if (ratio > tier_near_ratio) {
+                tier = Tier::NearOnly;
             }
         }
-    } else {
-        // Time-domain decision
-        if (sm_near < min_near_energy) {
-            dt_detected = false;
-        } else {
-            float ratio = sm_near / (sm_far + 1e-12f);
-            float coherence = (sm_cross * sm_cross) / (std::max(1e-12f, sm_far * sm_near));
-            if (ratio > near_to_far_threshold && coherence < coherence_threshold) {
-                dt_detected = true;
-            }
+    }
+    switch (tier) {
+    case Tier::Silent: ++counters.silent; break;
+    case Tier::FarOnly: ++counters.far_only; break;
+    case Tier::NearOnly: ++counters.near_only; break;
+    case Tier::Coherence: ++counters.coherence; break;
+    }
+    return tier;
+}
+
+bool DoubleTalkDetector::coherence_double_talk(const std::complex<double>* X, const double* yr_bins,
+                                               const double* yi_bins, size_t stride) {
+    // Update smoothed spectra
+    // Compute per-bin smoothed PSD/CSD and then compute a coherence averaged
+    // across bins that have significant joint energy. This avoids spuriously
+    // large coherence when signals occupy different frequency regions.
+    const double a = static_cast<double>(alpha);
+    const double b = 1.0 - a;
+    double max_sxx = 0.0;
+    double max_syy = 0.0;
+    for (uint32_t k = 0; k < freq_bins; ++k) {
+        const double xr = X[k].real(), xi = X[k].imag();
+        const double yr = yr_bins[k * stride], yi = yi_bins[k * stride];
+        double px = xr * xr + xi * xi;
+        double py = yr * yr + yi * yi;
+        // X * conj(Y), written out to stay clear of the NaN-checking
+        // complex multiply
+        std::complex<double> pxy(xr * yr + xi * yi, xi * yr - xr * yi);
+
+        Sxx_sm[k] = a * Sxx_sm[k] + b * px;
+        Syy_sm[k] = a * Syy_sm[k] + b * py;
+        Sxy_sm[k] = std::complex<double>(a * Sxy_sm[k].real() + b * pxy.real(),
+                                         a * Sxy_sm[k].imag() + b * pxy.imag());
+
+        max_sxx = std::max(max_sxx, Sxx_sm[k]);
+        max_syy = std::max(max_syy, Syy_sm[k]);
+    }
+
+    double sum_coh = 0.0;
+    uint32_t valid_bins = 0;
+    double denom_threshold = 1e-6 * max_sxx * max_syy + 1e-24;
+    for (uint32_t k = 0; k < freq_bins; ++k) {
+        // Computed for every bin and then selected, which keeps the loop
+        // free of hard-to-predict branches. |Sxy|^2 is written out since
+        // std::norm goes through std::abs (a hypot) for floating types.
+        double denom = Sxx_sm[k] * Syy_sm[k];
+        const double cr = Sxy_sm[k].real(), ci = Sxy_sm[k].imag();
+        double coh = (cr * cr + ci * ci) / (denom + 1e-24);
+        bool valid = denom >= denom_threshold;
+        sum_coh += valid ? coh : 0.0;
+        valid_bins += valid ? 1u : 0u;
+    }
+
+    double avg_coh = (valid_bins == 0) ? 0.0 : (sum_coh / static_cast<double>(valid_bins));
+    last_coherence = avg_coh;
+
+    // Combine time-domain power ratio with frequency coherence
+    bool dt_detected = false;
+    if (sm_near >= min_near_energy) {
+        double ratio = sm_near / (sm_far + 1e-12);
+        last_ratio = ratio;
+        if (ratio > near_to_far_threshold && avg_coh < coherence_threshold) {
+            dt_detected = true;
         }
     }
+    return dt_detected;
+}
 
+bool DoubleTalkDetector::time_double_talk() const {
+    if (sm_near < min_near_energy) return false;
+    float ratio = sm_near / (sm_far + 1e-12f);
+    float coherence = (sm_cross * sm_cross) / (std::max(1e-12f, sm_far * sm_near));
+    return ratio > near_to_far_threshold && coherence < coherence_threshold;
+}
+
+bool DoubleTalkDetector::finish(bool dt_detected) {
     if (dt_detected) {
         hangover_counter = hangover_frames;
         adapt_allowed = false;
@@ -149,4 +256,241 @@ bool DoubleTalkDetector::update(const int16_t* far, const int16_t* near, uint32_
     return adapt_allowed;
 }
 
+MultiChannelDoubleTalkDetector::MultiChannelDoubleTalkDetector(uint32_t channels,
+                                                               uint32_t frame_size,
+                                                               float near_to_far_threshold,
+                                                               float coherence_threshold,
+                                                               float smoothing_alpha,
+                                                               uint32_t hangover_frames,
+                                                               bool use_frequency,
+                                                               uint32_t freq_bins,
+                                                               bool tiered,
+                                                               float tier_near_ratio,
+                                                               Arena* arena)
+    : detectors(arena), fft(use_frequency ? DoubleTalkDetector::transform_size(frame_size) : 2, arena),
+      far_frame(arena), far_spectrum(arena), near_frames(arena), near_re(arena), near_im(arena),
+      near_pow(arena), cross_pow(arena), tiers(arena) {
+    channels = std::max<uint32_t>(1, channels);
+    detectors.reserve(channels);
+    for (uint32_t c = 0; c < channels; ++c) {
+        detectors.emplace_back(frame_size, near_to_far_threshold, coherence_threshold,
+                               smoothing_alpha, hangover_frames, use_frequency, freq_bins, tiered,
+                               tier_near_ratio, arena);
+    }
+    near_pow.resize(channels);
+    cross_pow.resize(channels);
+    tiers.resize(channels);
+    const DoubleTalkDetector& first = detectors.front();
+    if (first.use_frequency && first.freq_bins > 0) {
+        fft_size = first.fft_size;
+        fft.reserve_batch(channels);
+        far_frame.resize(fft_size);
+        far_spectrum.resize(fft.bins());
+        near_frames.resize(static_cast<size_t>(fft_size) * channels);
+        near_re.resize(static_cast<size_t>(fft.bins()) * channels);
+        near_im.resize(static_cast<size_t>(fft.bins()) * channels);
+    }
+}
+
+void MultiChannelDoubleTalkDetector::reset() {
+    for (auto& d : detectors) d.reset();
+}
+
+void MultiChannelDoubleTalkDetector::save_state(StateWriter& out) const {
+    for (const auto& d : detectors) d.save_state(out);
+}
+
+bool MultiChannelDoubleTalkDetector::load_state(StateReader& in) {
+    for (auto& d : detectors) {
+        if (!d.load_state(in)) return false;
+    }
+    return true;
+}
+
+void MultiChannelDoubleTalkDetector::set_keep_spectra(bool keep) {
+    keep_spectra = keep;
+    for (auto& d : detectors) d.set_keep_spectra(keep);
+}
+
+DTDSpectra MultiChannelDoubleTalkDetector::spectra(uint32_t c) const {
+    if (!shared) return detectors[c].spectra();
+    DTDSpectra s;
+    if (!shared_spectra || c >= spectra_stride) return s;
+    s.far = far_spectrum.data();
+    s.near_re = near_re.data() + c;
+    s.near_im = near_im.data() + c;
+    s.stride = spectra_stride;
+    s.bins = fft.bins();
+    return s;
+}
+
+DTDTierCounters MultiChannelDoubleTalkDetector::tier_counters() const {
+    DTDTierCounters total;
+    for (const auto& d : detectors) {
+        const DTDTierCounters& c = d.tier_counters();
+        total.silent += c.silent;
+        total.far_only += c.far_only;
+        total.near_only += c.near_only;
+        total.coherence += c.coherence;
+    }
+    return total;
+}
+
+// Channel c of an interleaved buffer, its samples `channels` apart
+template <typename T>
+struct InterleavedFrames {
+    const T* data;
+    uint32_t channels;
+    const T* channel(uint32_t c) const { return data + c; }
+    uint32_t stride() const { return channels; }
+    T at(uint32_t c, size_t i) const { return data[i * channels + c]; }
+};
+
+// Channel c of planar buffers, one pointer per channel
+template <typename T>
+struct PlanarFrames {
+    const T* const* data;
+    const T* channel(uint32_t c) const { return data[c]; }
+    uint32_t stride() const { return 1; }
+    T at(uint32_t c, size_t i) const { return data[c][i]; }
+};
+
+static bool same_far_end(const InterleavedFrames<int16_t>& far, uint32_t frame_size, uint32_t channels) {
+    // No early exit: the common case is a match, and the plain loop vectorizes
+    int16_t diff = 0;
+    for (uint32_t i = 0; i < frame_size; ++i) {
+        const int16_t* step = far.data + static_cast<size_t>(i) * channels;
+        const int16_t ref = step[0];
+        for (uint32_t c = 0; c < channels; ++c) diff |= static_cast<int16_t>(step[c] ^ ref);
+    }
+    return diff == 0;
+}
+
+template <typename T>
+static bool same_far_end(const PlanarFrames<T>& far, uint32_t frame_size, uint32_t channels) {
+    const T* ref = far.data[0];
+    bool diff = false;
+    for (uint32_t c = 1; c < channels; ++c) {
+        const T* plane = far.data[c];
+        if (plane == ref) continue;
+        for (uint32_t i = 0; i < frame_size; ++i) diff |= plane[i] != ref[i];
+    }
+    return !diff;
+}
+
+// Near-end power, cross power with the far-end and (when `frames` is set)
+// the folded frame for `Lanes` adjacent channels starting at `first`. The
+// lane accumulators stay in registers across the frame.
+template <uint32_t Lanes, typename Frames>
+static void accumulate_near(const Frames& far, const Frames& near, uint32_t first, uint32_t frame_size,
+                            double* frames, uint32_t fft_size, uint32_t frame_stride,
+                            double* near_pow, double* cross_pow) {
+    double np[Lanes] = {};
+    double cp[Lanes] = {};
+    for (uint32_t i = 0, pos = 0; i < frame_size; ++i) {
+        const double f = unit(far.at(0, i));
+        double* slot = frames ? frames + static_cast<size_t>(pos) * frame_stride : nullptr;
+        for (uint32_t l = 0; l < Lanes; ++l) {
+            const double n = unit(near.at(first + l, i));
+            np[l] += n * n;
+            cp[l] += f * n;
+            if (slot) slot[l] += n;
+        }
+        if (++pos == fft_size) pos = 0;
+    }
+    for (uint32_t l = 0; l < Lanes; ++l) {
+        near_pow[l] = np[l];
+        cross_pow[l] = cp[l];
+    }
+}
+
+template <typename Frames>
+void MultiChannelDoubleTalkDetector::update_frames(const Frames& far, const Frames& near, uint32_t frame_size,
+                                                   uint32_t channels, bool* adapt) {
+    AEC_TRACE_SCOPE("MultiChannelDoubleTalkDetector::update");
+    const uint32_t ch = std::min(std::max<uint32_t>(1, channels), this->channels());
+    shared = ch > 1 && same_far_end(far, frame_size, channels);
+    if (!shared) {
+        for (uint32_t c = 0; c < ch; ++c) {
+            adapt[c] = detectors[c].update(far.channel(c), near.channel(c), frame_size, far.stride());
+        }
+        return;
+    }
+
+    // Far-end power, frame and spectrum once, then the near-end channels in
+    // groups of four. Each accumulator sums in sample order, exactly as the
+    // per-channel detector does.
+    const bool frequency = fft_size > 0;
+    shared_spectra = false;
+    if (frequency) {
+        std::fill(far_frame.begin(), far_frame.end(), 0.0);
+        std::fill(near_frames.begin(), near_frames.begin() + static_cast<size_t>(fft_size) * ch, 0.0);
+    }
+    double far_pow = 0.0;
+    for (uint32_t i = 0, pos = 0; i < frame_size; ++i) {
+        const double f = unit(far.at(0, i));
+        far_pow += f * f;
+        if (frequency) {
+            far_frame[pos] += f;
+            if (++pos == fft_size) pos = 0;
+        }
+    }
+    double* frame_base = frequency ? near_frames.data() : nullptr;
+    uint32_t c = 0;
+    for (; c + 4 <= ch; c += 4) {
+        accumulate_near<4>(far, near, c, frame_size, frame_base ? frame_base + c : nullptr,
+                           fft_size, ch, &near_pow[c], &cross_pow[c]);
+    }
+    for (; c < ch; ++c) {
+        accumulate_near<1>(far, near, c, frame_size, frame_base ? frame_base + c : nullptr,
+                           fft_size, ch, &near_pow[c], &cross_pow[c]);
+    }
+
+    const double scale = static_cast<double>(frame_size);
+    far_pow /= scale;
+    for (c = 0; c < ch; ++c) detectors[c].smooth_powers(far_pow, near_pow[c] / scale, cross_pow[c] / scale);
+    if (!frequency) {
+        for (c = 0; c < ch; ++c) adapt[c] = detectors[c].finish(detectors[c].time_double_talk());
+        return;
+    }
+
+    // All near-end spectra in one batched transform, skipped when the energy
+    // gate settles every channel
+    bool any_coherence = false;
+    for (c = 0; c < ch; ++c) {
+        tiers[c] = detectors[c].classify();
+        any_coherence |= tiers[c] == DoubleTalkDetector::Tier::Coherence;
+    }
+    if (any_coherence || keep_spectra) {
+        fft.forward(far_frame.data(), far_spectrum.data());
+        fft.forward_batch(near_frames.data(), near_re.data(), near_im.data(), ch);
+        shared_spectra = true;
+        spectra_stride = ch;
+    }
+    for (c = 0; c < ch; ++c) {
+        DoubleTalkDetector& d = detectors[c];
+        const bool dt = tiers[c] == DoubleTalkDetector::Tier::Coherence
+                            ? d.coherence_double_talk(far_spectrum.data(), near_re.data() + c, near_im.data() + c, ch)
+                            : tiers[c] == DoubleTalkDetector::Tier::NearOnly;
+        adapt[c] = d.finish(dt);
+    }
+}
+
+
+void MultiChannelDoubleTalkDetector::update(const int16_t* far, const int16_t* near, uint32_t frame_size,
+                                            uint32_t channels, bool* adapt) {
+    update_frames(InterleavedFrames<int16_t>{far, channels}, InterleavedFrames<int16_t>{near, channels},
+                  frame_size, channels, adapt);
+}
+
+void MultiChannelDoubleTalkDetector::update(const int16_t* const* far, const int16_t* const* near,
+                                            uint32_t frame_size, uint32_t channels, bool* adapt) {
+    update_frames(PlanarFrames<int16_t>{far}, PlanarFrames<int16_t>{near}, frame_size, channels, adapt);
+}
+
+void MultiChannelDoubleTalkDetector::update(const float* const* far, const float* const* near,
+                                            uint32_t frame_size, uint32_t channels, bool* adapt) {
+    update_frames(PlanarFrames<float>{far}, PlanarFrames<float>{near}, frame_size, channels, adapt);
+}
+
 } // namespace aec
@@ -0,0 +1,232 @@
+#include "aec/fft.hpp"
+#include "aec/simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace aec {
+
+// Complex transform of half = size/2 points, radix-2 decimation in time.
+// Stage s (butterfly span h = 2^s) reads h consecutive twiddles
+// e^{-2*pi*i*k/(2h)}, so every stage streams its table instead of striding
+// through a shared one; the tables are stored back to back, h = 1 first.
+template <typename T>
+struct FFTPlan {
+    explicit FFTPlan(uint32_t size);
+
+    uint32_t n;
+    uint32_t half;
+    std::vector<std::complex<T>> stage_twiddles;   // forward, all stages
+    std::vector<std::complex<T>> inverse_twiddles; // conjugates of the above
+    std::vector<std::complex<T>> split_twiddles;   // e^{-2*pi*i*k/n}, k <= half
+    std::vector<uint32_t> bitrev;
+};
+
+template <typename T>
+FFTPlan<T>::FFTPlan(uint32_t size) : n(size < 2 ? 2 : size), half(n / 2) {
+    const double TWO_PI = 2.0 * M_PI;
+    for (uint32_t h = 1; h < half; h <<= 1) {
+        for (uint32_t k = 0; k < h; ++k) {
+            double a = -TWO_PI * static_cast<double>(k) / static_cast<double>(2 * h);
+            stage_twiddles.emplace_back(static_cast<T>(std::cos(a)), static_cast<T>(std::sin(a)));
+            inverse_twiddles.emplace_back(static_cast<T>(std::cos(a)), static_cast<T>(-std::sin(a)));
+        }
+    }
+    split_twiddles.resize(half + 1);
+    for (uint32_t k = 0; k <= half; ++k) {
+        double a = -TWO_PI * static_cast<double>(k) / static_cast<double>(n);
+        split_twiddles[k] = std::complex<T>(static_cast<T>(std::cos(a)), static_cast<T>(std::sin(a)));
+    }
+    bitrev.resize(half);
+    uint32_t bits = 0;
+    while ((1u << bits) < half) ++bits;
+    for (uint32_t i = 0; i < half; ++i) {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < bits; ++b) {
+            if (i & (1u << b)) r |= 1u << (bits - 1 - b);
+        }
+        bitrev[i] = r;
+    }
+}
+
+template <typename T>
+std::shared_ptr<const FFTPlan<T>> fft_plan(uint32_t size) {
+    static std::mutex mutex;
+    static std::map<uint32_t, std::shared_ptr<const FFTPlan<T>>> cache;
+    const uint32_t key = size < 2 ? 2 : size;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& plan = cache[key];
+    if (!plan) plan = std::make_shared<const FFTPlan<T>>(key);
+    return plan;
+}
+
+// One radix-2 stage over `groups` blocks of 2h points
+static void butterfly_stage(std::complex<float>* data, const std::complex<float>* w, size_t h, size_t groups) {
+    simd::kernels().butterfly_c32(reinterpret_cast<float*>(data), reinterpret_cast<const float*>(w), h, groups);
+}
+
+static void butterfly_stage(std::complex<double>* data, const std::complex<double>* w, size_t h, size_t groups) {
+    simd::kernels().butterfly_c64(reinterpret_cast<double*>(data), reinterpret_cast<const double*>(w), h, groups);
+}
+
+// The same stage for `count` transforms in split real/imaginary arrays,
+// interleaved point by point. The innermost loop runs across the transforms,
+// which share each twiddle.
+template <typename T>
+static void butterfly_stage_batch(T* re, T* im, const std::complex<T>* w, size_t h, size_t groups, size_t count) {
+    for (size_t g = 0; g < groups; ++g) {
+        for (size_t k = 0; k < h; ++k) {
+            const T wr = w[k].real();
+            const T wi = w[k].imag();
+            const size_t lo = (g * 2 * h + k) * count;
+            const size_t hi = lo + h * count;
+            for (size_t c = 0; c < count; ++c) {
+                const T tr = wr * re[hi + c] - wi * im[hi + c];
+                const T ti = wr * im[hi + c] + wi * re[hi + c];
+                const T ur = re[lo + c];
+                const T ui = im[lo + c];
+                re[lo + c] = ur + tr;
+                im[lo + c] = ui + ti;
+                re[hi + c] = ur - tr;
+                im[hi + c] = ui - ti;
+            }
+        }
+    }
+}
+
+static void butterfly_stage_batch(double* re, double* im, const std::complex<double>* w, size_t h, size_t groups,
+                                  size_t count) {
+    simd::kernels().butterfly_batch_f64(re, im, reinterpret_cast<const double*>(w), h, groups, count);
+}
+
+template <typename T>
+BasicRealFFT<T>::BasicRealFFT(uint32_t size, Arena* arena)
+    : n(size < 2 ? 2 : size), half(n / 2), shared_plan(fft_plan<T>(n)), work(half, arena),
+      batch_re(arena), batch_im(arena) {}
+
+template <typename T>
+void BasicRealFFT<T>::reserve_batch(uint32_t count) {
+    const size_t needed = static_cast<size_t>(half) * count;
+    if (batch_re.size() < needed) {
+        batch_re.resize(needed);
+        batch_im.resize(needed);
+    }
+}
+
+template <typename T>
+void BasicRealFFT<T>::complex_fft(std::complex<T>* data, bool inverse) const {
+    const FFTPlan<T>& p = *shared_plan;
+    for (uint32_t i = 0; i < half; ++i) {
+        uint32_t j = p.bitrev[i];
+        if (j > i) std::swap(data[i], data[j]);
+    }
+    const std::complex<T>* w = inverse ? p.inverse_twiddles.data() : p.stage_twiddles.data();
+    for (uint32_t h = 1; h < half; h <<= 1) {
+        butterfly_stage(data, w, h, half / (2 * h));
+        w += h;
+    }
+}
+
+// Split of the half-size complex transform Z into the spectrum of the real
+// sequence: out[k] = (a + b)/2 + s_k * (-j/2) * (a - b), with a = Z[k] and
+// b = conj(Z[half - k]). Shared by forward() and forward_batch() so both
+// round identically.
+template <typename T>
+static inline void split_bin(T ar, T ai, T br, T bi, T sr, T si, T& out_r, T& out_i) {
+    const T one_half = static_cast<T>(0.5);
+    const T er = one_half * (ar + br);
+    const T ei = one_half * (ai - bi);
+    const T odd_r = one_half * (ai + bi);
+    const T odd_i = -one_half * (ar - br);
+    const T p = sr * odd_r, q = si * odd_i;
+    const T s = sr * odd_i, t = si * odd_r;
+    out_r = er + (p - q);
+    out_i = ei + (s + t);
+}
+
+template <typename T>
+void BasicRealFFT<T>::forward(const T* in, std::complex<T>* out) {
+    const FFTPlan<T>& p = *shared_plan;
+    // Pack even/odd samples into a half-size complex sequence
+    for (uint32_t i = 0; i < half; ++i) {
+        work[i] = std::complex<T>(in[2 * i], in[2 * i + 1]);
+    }
+    complex_fft(work.data(), false);
+
+    const T* z = reinterpret_cast<const T*>(work.data());
+    T* o = reinterpret_cast<T*>(out);
+    for (uint32_t k = 0; k <= half; ++k) {
+        const T* a = z + 2 * (k == half ? 0 : k);
+        const T* b = z + 2 * (k == 0 ? 0 : half - k);
+        split_bin(a[0], a[1], b[0], b[1], p.split_twiddles[k].real(), p.split_twiddles[k].imag(),
+                  o[2 * k], o[2 * k + 1]);
+    }
+}
+
+template <typename T>
+void BasicRealFFT<T>::forward_batch(const T* in, T* out_re, T* out_im, uint32_t count) {
+    const FFTPlan<T>& p = *shared_plan;
+    reserve_batch(count);
+    T* re = batch_re.data();
+    T* im = batch_im.data();
+    // Pack even/odd samples straight into bit-reversed order
+    for (uint32_t i = 0; i < half; ++i) {
+        const T* even = in + static_cast<size_t>(2 * i) * count;
+        const T* odd = even + count;
+        T* dst_re = re + static_cast<size_t>(p.bitrev[i]) * count;
+        T* dst_im = im + static_cast<size_t>(p.bitrev[i]) * count;
+        for (uint32_t c = 0; c < count; ++c) {
+            dst_re[c] = even[c];
+            dst_im[c] = odd[c];
+        }
+    }
+    const std::complex<T>* w = p.stage_twiddles.data();
+    for (uint32_t h = 1; h < half; h <<= 1) {
+        butterfly_stage_batch(re, im, w, h, half / (2 * h), count);
+        w += h;
+    }
+
+    for (uint32_t k = 0; k <= half; ++k) {
+        const size_t a = static_cast<size_t>(k == half ? 0 : k) * count;
+        const size_t b = static_cast<size_t>(k == 0 ? 0 : half - k) * count;
+        const T sr = p.split_twiddles[k].real();
+        const T si = p.split_twiddles[k].imag();
+        T* dst_re = out_re + static_cast<size_t>(k) * count;
+        T* dst_im = out_im + static_cast<size_t>(k) * count;
+        for (uint32_t c = 0; c < count; ++c) {
+            split_bin(re[a + c], im[a + c], re[b + c], im[b + c], sr, si, dst_re[c], dst_im[c]);
+        }
+    }
+}
+
+template <typename T>
+void BasicRealFFT<T>::inverse(const std::complex<T>* in, T* out) {
+    const FFTPlan<T>& p = *shared_plan;
+    const std::complex<T> j(0, 1);
+    const T one_half = static_cast<T>(0.5);
+    for (uint32_t k = 0; k < half; ++k) {
+        std::complex<T> a = in[k];
+        std::complex<T> b = std::conj(in[half - k]);
+        std::complex<T> even = one_half * (a + b);
+        std::complex<T> odd = one_half * (a - b) * std::conj(p.split_twiddles[k]);
+        work[k] = even + j * odd;
+    }
+    complex_fft(work.data(), true);
+
+    const T scale = static_cast<T>(1) / static_cast<T>(half);
+    for (uint32_t i = 0; i < half; ++i) {
+        out[2 * i] = work[i].real() * scale;
+        out[2 * i + 1] = work[i].imag() * scale;
+    }
+}
+
+template struct FFTPlan<float>;
+template struct FFTPlan<double>;
+template std::shared_ptr<const FFTPlan<float>> fft_plan<float>(uint32_t);
+template std::shared_ptr<const FFTPlan<double>> fft_plan<double>(uint32_t);
+template class BasicRealFFT<float>;
+template class BasicRealFFT<double>;
+
+} // namespace aec
@@ -0,0 +1,292 @@
+#include "aec/ipnlms_filter.hpp"
+#include "aec/simd_kernels.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace aec {
+
+// IPNLMS update (Benesty & Gay, ICASSP 2002):
+//
+//   k_i = (1 - alpha) / (2L) + (1 + alpha) |w_i| / (2 ||w||_1 + eps)
+//   w_i += mu e k_i x_i / (sum_j k_j x_j^2 + delta')
+//
+// with delta' = (1 - alpha) / (2L) * delta, the regularization that makes it
+// equivalent to NLMS at alpha = -1. The history is mirrored with the newest
+// sample at history[pos], so tap i always pairs with lag i and a block of
+// taps is a contiguous range of both arrays.
+//
+// Tap skipping works on blocks of `block_size` taps. Skipped blocks are
+// frozen: their coefficients stay as they were and they are left out of the
+// output, the proportionate gains and the normalization. Their L1 norm is
+// cached when the active set is chosen, so ||w||_1 only costs a pass over the
+// active taps.
+class IPNLMSFilter::Impl {
+public:
+    Impl(uint32_t length, float mu, float delta, float alpha, Arena* arena)
+        : filter_length(std::max<uint32_t>(1, length)),
+          mu(mu),
+          alpha(std::min(std::max(alpha, -1.0f), 0.999f)),
+          uniform_gain((1.0f - this->alpha) / (2.0f * static_cast<float>(filter_length))),
+          regularization(uniform_gain * delta + 1e-20f),
+          kernels(simd::kernels()),
+          w(arena), history(arena), gained(arena), active(arena), block_energy(arena) {
+        configure_blocks(filter_length);
+        reset();
+    }
+
+    void reset() {
+        w.assign(filter_length, 0.0f);
+        history.assign(2 * static_cast<size_t>(filter_length), 0.0f);
+        gained.assign(filter_length, 0.0f);
+        block_energy.assign(num_blocks, 0.0f);
+        frozen_l1 = 0.0f;
+        active_l1 = 0.0f;
+        pos = 0;
+        activate_all();
+        probing = skipping;
+        samples_in_phase = 0;
+    }
+
+    void save_state(StateWriter& out) const {
+        out.put(w);
+        out.put(history);
+        out.put(pos);
+        // The active set as one flag per block, so the snapshot is the same
+        // size whatever is being skipped
+        out.put(num_blocks);
+        size_t r = 0;
+        for (uint32_t b = 0; b < num_blocks; ++b) {
+            const uint32_t start = b * block_size;
+            while (r < active.size() && active[r].start + active[r].length <= start) ++r;
+            out.put(static_cast<uint8_t>(r < active.size() && active[r].start <= start));
+        }
+        out.put(frozen_l1);
+        out.put(active_l1);
+        out.put(probing);
+        out.put(samples_in_phase);
+    }
+
+    bool load_state(StateReader& in) {
+        uint32_t blocks = 0;
+        if (!in.get(w) || !in.get(history) || !in.get(pos) || !in.get(blocks)) return false;
+        if (pos >= filter_length || blocks != num_blocks) return in.fail();
+        active.clear();
+        active_taps = 0;
+        for (uint32_t b = 0; b < num_blocks; ++b) {
+            uint8_t on = 0;
+            if (!in.get(on)) return false;
+            if (on) activate_block(b);
+        }
+        return in.get(frozen_l1) && in.get(active_l1) && in.get(probing) && in.get(samples_in_phase);
+    }
+
+    void enable_tap_skipping(uint32_t size, float threshold_db, uint32_t interval) {
+        skipping = size > 0 && size < filter_length;
+        configure_blocks(skipping ? size : filter_length);
+        skip_threshold = std::pow(10.0f, threshold_db / 10.0f);
+        recheck_interval = std::max<uint32_t>(1, interval);
+        reset();
+    }
+
+    uint32_t get_active_taps() const { return active_taps; }
+
+    float process(float far_end, float near_end, bool adapt) {
+        push(far_end);
+        const float* x = &history[pos];
+
+        float y = 0.0f;
+        for (const Run& run : active) {
+            y += kernels.dot_f32(&w[run.start], &x[run.start], run.length);
+        }
+        const float e = near_end - y;
+
+        if (adapt) update(x, e);
+        if (skipping) track();
+        return e;
+    }
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) {
+        for (size_t j = 0; j < n; ++j) {
+            out[j * stride] = process(far[j * stride], near[j * stride], adapt);
+        }
+        return true;
+    }
+
+    float get_coeff_norm() const {
+        double sum = 0.0;
+        for (float v : w) sum += static_cast<double>(v) * v;
+        return static_cast<float>(std::sqrt(sum));
+    }
+
+private:
+    void push(float sample) {
+        pos = (pos == 0) ? filter_length - 1 : pos - 1;
+        history[pos] = sample;
+        history[pos + filter_length] = sample;
+    }
+
+    void update(const float* x, float e) {
+        const float proportional_gain = (1.0f + alpha) / (2.0f * (frozen_l1 + active_l1) + 1e-6f);
+
+        // k_i x_i for the active taps, and sum k_i x_i^2 for the normalization
+        float power = 0.0f;
+        for (const Run& run : active) {
+            power += kernels.gain_f32(&gained[run.start], &w[run.start], &x[run.start],
+                                      uniform_gain, proportional_gain, run.length);
+        }
+
+        const float step = mu * e / (power + regularization);
+        active_l1 = 0.0f;
+        for (const Run& run : active) {
+            kernels.axpy_f32(step, &gained[run.start], &w[run.start], run.length);
+            active_l1 += kernels.abs_sum_f32(&w[run.start], run.length);
+        }
+    }
+
+    // Alternates between skipping (recheck_interval samples) and probing the
+    // whole filter (one filter length); block energies are evaluated at the
+    // end of each probe
+    void track() {
+        ++samples_in_phase;
+        if (probing) {
+            if (samples_in_phase < filter_length) return;
+            select_active_blocks();
+            probing = false;
+        } else {
+            if (samples_in_phase < recheck_interval) return;
+            activate_all();
+            probing = true;
+        }
+        samples_in_phase = 0;
+    }
+
+    void select_active_blocks() {
+        float strongest = 0.0f;
+        for (uint32_t b = 0; b < num_blocks; ++b) {
+            const uint32_t start = b * block_size;
+            block_energy[b] = kernels.dot_f32(&w[start], &w[start], block_length(b));
+            strongest = std::max(strongest, block_energy[b]);
+        }
+        if (strongest <= 0.0f) {
+            activate_all();
+            return;
+        }
+        active.clear();
+        active_taps = 0;
+        frozen_l1 = 0.0f;
+        active_l1 = 0.0f;
+        const float floor = strongest * skip_threshold;
+        for (uint32_t b = 0; b < num_blocks; ++b) {
+            const uint32_t start = b * block_size;
+            if (block_energy[b] < floor) {
+                frozen_l1 += kernels.abs_sum_f32(&w[start], block_length(b));
+                continue;
+            }
+            active_l1 += kernels.abs_sum_f32(&w[start], block_length(b));
+            activate_block(b);
+        }
+    }
+
+    // Appends block b to the active runs; blocks go in ascending order
+    void activate_block(uint32_t b) {
+        const uint32_t start = b * block_size;
+        if (!active.empty() && active.back().start + active.back().length == start) {
+            active.back().length += block_length(b);
+        } else {
+            active.push_back({start, block_length(b)});
+        }
+        active_taps += block_length(b);
+    }
+
+    void activate_all() {
+        active.assign(1, {0, filter_length});
+        active_taps = filter_length;
+        active_l1 += frozen_l1;
+        frozen_l1 = 0.0f;
+    }
+
+    void configure_blocks(uint32_t size) {
+        block_size = size;
+        num_blocks = (filter_length + block_size - 1) / block_size;
+        active.reserve(num_blocks);
+    }
+
+    uint32_t block_length(uint32_t b) const {
+        return std::min(block_size, filter_length - b * block_size);
+    }
+
+    uint32_t filter_length;
+    float mu;
+    float alpha;
+    float uniform_gain;
+    float regularization;
+    const simd::Kernels& kernels;
+
+    ArenaVector<float> w;
+    ArenaVector<float> history; // mirrored, newest sample at history[pos]
+    ArenaVector<float> gained;  // k_i x_i scratch
+    uint32_t pos = 0;
+
+    // Tap skipping
+    bool skipping = false;
+    uint32_t block_size = 0;
+    uint32_t num_blocks = 0;
+    float skip_threshold = 0.0f;
+    uint32_t recheck_interval = 0;
+    // Adjacent active blocks are merged into runs so the kernels see long,
+    // contiguous ranges
+    struct Run {
+        uint32_t start;
+        uint32_t length;
+    };
+    ArenaVector<Run> active;
+    ArenaVector<float> block_energy;
+    float frozen_l1 = 0.0f; // ||w||_1 over skipped blocks
+    float active_l1 = 0.0f; // ||w||_1 over active runs, as of the last update
+    uint32_t active_taps = 0;
+    bool probing = false;
+    uint32_t samples_in_phase = 0;
+};
+
+// IPNLMSFilter implementation
+IPNLMSFilter::IPNLMSFilter(uint32_t length, float mu, float delta, float alpha, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, length, mu, delta, alpha, arena)) {}
+
+IPNLMSFilter::~IPNLMSFilter() = default;
+
+float IPNLMSFilter::process(float far_end, float near_end, bool adapt) {
+    return pimpl->process(far_end, near_end, adapt);
+}
+
+bool IPNLMSFilter::process_block(const float* far, const float* near, float* out,
+                                 size_t n, size_t stride, bool adapt) {
+    return pimpl->process_block(far, near, out, n, stride, adapt);
+}
+
+void IPNLMSFilter::reset() {
+    pimpl->reset();
+}
+
+void IPNLMSFilter::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool IPNLMSFilter::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
+float IPNLMSFilter::get_coeff_norm() const {
+    return pimpl->get_coeff_norm();
+}
+
+void IPNLMSFilter::enable_tap_skipping(uint32_t block_size, float threshold_db, uint32_t recheck_interval) {
+    pimpl->enable_tap_skipping(block_size, threshold_db, recheck_interval);
+}
+
+uint32_t IPNLMSFilter::active_taps() const {
+    return pimpl->get_active_taps();
+}
+
+} // namespace aec
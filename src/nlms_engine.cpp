@@ -0,0 +1,53 @@
+#include "aec/nlms_filter.hpp"
+#include "aec/nlms_engine.hpp"
+#include "aec/simd_kernels.hpp"
+
+namespace aec {
+
+namespace {
+
+// The library is built for the baseline ISA, where the compiler cannot
+// vectorize the portable loops as well as the hand-written kernels (the Q15
+// update in particular), so the prebuilt engines run their fixed-size loops
+// through the kernel table selected for this CPU.
+struct DispatchedNLMSOps {
+    template <uint32_t N>
+    static float dot_f32(const float* a, const float* b) { return simd::kernels().dot_f32(a, b, N); }
+    template <uint32_t N>
+    static void axpy_f32(float alpha, const float* x, float* y) { simd::kernels().axpy_f32(alpha, x, y, N); }
+    template <uint32_t N>
+    static int32_t dot_q15(const int16_t* a, const int16_t* b) { return simd::kernels().dot_q15(a, b, N); }
+    template <uint32_t N>
+    static void update_q15(int16_t* w, const int16_t* x, int16_t e, int16_t step) {
+        simd::kernels().update_q15(w, x, e, step, N);
+    }
+};
+
+template <uint32_t Length>
+ArenaPtr<AdaptiveFilter> make_static(Arena* arena, float mu, float delta, bool use_fixed_point) {
+    if (use_fixed_point) {
+        return arena_new<StaticNLMSFilter<Length, int16_t, DispatchedNLMSOps>>(arena, mu, delta);
+    }
+    return arena_new<StaticNLMSFilter<Length, float, DispatchedNLMSOps>>(arena, mu, delta);
+}
+
+} // namespace
+
+ArenaPtr<AdaptiveFilter> create_nlms_filter(Arena* arena, uint32_t length, float mu, float delta,
+                                            bool use_fixed_point) {
+    switch (length) {
+    case 128: return make_static<128>(arena, mu, delta, use_fixed_point);
+    case 256: return make_static<256>(arena, mu, delta, use_fixed_point);
+    case 512: return make_static<512>(arena, mu, delta, use_fixed_point);
+    case 1024: return make_static<1024>(arena, mu, delta, use_fixed_point);
+    case 2048: return make_static<2048>(arena, mu, delta, use_fixed_point);
+    default: return arena_new<NLMSFilter>(arena, length, mu, delta, use_fixed_point, arena);
+    }
+}
+
+std::unique_ptr<AdaptiveFilter> create_nlms_filter(uint32_t length, float mu, float delta, bool use_fixed_point) {
+    // Without an arena every engine is a plain heap object
+    return std::unique_ptr<AdaptiveFilter>(create_nlms_filter(nullptr, length, mu, delta, use_fixed_point).release());
+}
+
+} // namespace aec
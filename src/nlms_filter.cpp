@@ -1,60 +1,98 @@
 #include "aec/nlms_filter.hpp"
 #include "aec/fixed_point.hpp"
+#include "aec/simd_kernels.hpp"
+#include "aec/trace.hpp"
 #include <vector>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 
 namespace aec {
 
+// The delay line is stored twice back to back ("mirrored"): sample i lives at
+// both x[i] and x[i + filter_length], so the window starting at x_index is
+// always filter_length contiguous samples and no per-tap modulo is needed.
+// Tap w[i] pairs with x[x_index + i], i.e. the same sample ordering as the
+// original circular-buffer indexing (x_index + i) % filter_length.
+//
+// The convolution and the coefficient update run through the SIMD kernel
+// table chosen for this CPU (see simd_kernels.hpp). The input power used for
+// normalization is a sliding-window sum updated in O(1) per sample: exact
+// integer arithmetic on the Q15 path, and recomputed from scratch once per
+// pass over the delay line on the float path to bound rounding drift.
 class NLMSFilter::Impl {
 public:
-    Impl(uint32_t length, float mu, float delta, bool use_fixed_point)
+    Impl(uint32_t length, float mu, float delta, bool use_fixed_point, Arena* arena)
         : filter_length(length), mu(mu), delta(delta),
-          use_fixed_point(use_fixed_point) {
+          use_fixed_point(use_fixed_point), w_float(arena), x_float(arena), w_fixed(arena), x_fixed(arena),
+          kernels(simd::kernels()) {
         reset();
     }
-    
+
     void reset() {
         if (use_fixed_point) {
-            w_fixed.assign(filter_length, Q15(0.0f));
-            x_fixed.assign(filter_length, Q15(0.0f));
+            w_fixed.assign(filter_length, 0);
+            x_fixed.assign(2 * static_cast<size_t>(filter_length), 0);
         } else {
             w_float.assign(filter_length, 0.0f);
-            x_float.assign(filter_length, 0.0f);
+            x_float.assign(2 * static_cast<size_t>(filter_length), 0.0f);
         }
         x_index = 0;
+        power_float_sum = 0.0f;
+        power_fixed_sum = 0;
+    }
+
+    void save_state(StateWriter& out) const {
+        out.put(w_float);
+        out.put(x_float);
+        out.put(w_fixed);
+        out.put(x_fixed);
+        out.put(static_cast<uint32_t>(x_index));
+        out.put(power_float_sum);
+        out.put(power_fixed_sum);
+    }
+
+    bool load_state(StateReader& in) {
+        uint32_t index = 0;
+        if (!in.get(w_float) || !in.get(x_float) || !in.get(w_fixed) || !in.get(x_fixed) || !in.get(index) ||
+            !in.get(power_float_sum) || !in.get(power_fixed_sum)) {
+            return false;
+        }
+        if (index >= filter_length) return in.fail();
+        x_index = index;
+        return true;
     }
-    
+
     float process_float(float far_end, float near_end, bool adapt) {
+        // Slide the power window: drop the sample being overwritten
+        const float leaving = x_float[x_index];
+        power_float_sum += far_end * far_end - leaving * leaving;
+
         // Update delay line
         x_float[x_index] = far_end;
-        
+        x_float[x_index + filter_length] = far_end;
+        const float* x = &x_float[x_index];
+
         // Compute filter output
-        float y = 0.0f;
-        for (size_t i = 0; i < filter_length; ++i) {
-            y += w_float[i] * x_float[(x_index + i) % filter_length];
-        }
-        
+        float y = kernels.dot_f32(w_float.data(), x, filter_length);
+
         // Error signal (echo cancelled output)
         float e = near_end - y;
-        
+
         // Compute input power
-        float power = delta;
-        for (size_t i = 0; i < filter_length; ++i) {
-            power += x_float[i] * x_float[i];
+        if (x_index == 0) {
+            power_float_sum = kernels.dot_f32(x_float.data(), x_float.data(), filter_length);
         }
-        
+        float power = delta + std::max(0.0f, power_float_sum);
+
         // Update filter coefficients if adaptation is allowed
         if (adapt) {
             float adaptation_step = mu / power;
-            for (size_t i = 0; i < filter_length; ++i) {
-                w_float[i] += adaptation_step * e * x_float[(x_index + i) % filter_length];
-            }
+            kernels.axpy_f32(adaptation_step * e, x, w_float.data(), filter_length);
         }
-        
-        // Update delay line index
-        x_index = (x_index + 1) % filter_length;
-        
+
+        advance();
+
         return e;
     }
 
@@ -64,76 +102,92 @@ public:
             for (auto v : w_float) sum += v * v;
         } else {
             for (auto v : w_fixed) {
-                float vf = static_cast<float>(v.raw()) / 32768.0f;
+                float vf = static_cast<float>(v) / 32768.0f;
                 sum += vf * vf;
             }
         }
         return std::sqrt(sum);
     }
-    
+
     int16_t process_fixed(int16_t far_end, int16_t near_end, bool adapt) {
-        Q15 far_end_q15 = Q15::from_raw(far_end);
         Q15 near_end_q15 = Q15::from_raw(near_end);
-        
+
+        // Slide the power window: drop the sample being overwritten
+        const int32_t leaving = x_fixed[x_index];
+        const int32_t entering = far_end;
+        power_fixed_sum += ((entering * entering) >> 15) - ((leaving * leaving) >> 15);
+
         // Update delay line
-        x_fixed[x_index] = far_end_q15;
-        
+        x_fixed[x_index] = far_end;
+        x_fixed[x_index + filter_length] = far_end;
+        const int16_t* x = &x_fixed[x_index];
+
         // Compute filter output
-        int32_t y_acc = 0;
-        for (size_t i = 0; i < filter_length; ++i) {
-            Q15 x_val = x_fixed[(x_index + i) % filter_length];
-            int32_t product = static_cast<int32_t>(x_val.raw()) * static_cast<int32_t>(w_fixed[i].raw());
-            y_acc += product;
-        }
-        
+        int32_t y_acc = kernels.dot_q15(x, w_fixed.data(), filter_length);
+
         // Convert to Q15 (right shift 15 bits)
         Q15 y_q15 = Q15::from_raw(static_cast<int16_t>(y_acc >> 15));
-        
+
         // Error signal
         Q15 e_q15 = near_end_q15 - y_q15;
-        
+
         // Compute input power (fixed-point approximation)
-        int32_t power_acc = static_cast<int32_t>(delta * 32768.0f * 32768.0f);
-        for (size_t i = 0; i < filter_length; ++i) {
-            int32_t x_val = static_cast<int32_t>(x_fixed[i].raw());
-            power_acc += (x_val * x_val) >> 15;
-        }
-        
+        int32_t power_acc = static_cast<int32_t>(delta * 32768.0f * 32768.0f) + power_fixed_sum;
+
         // Update coefficients (fixed-point) if adaptation is allowed
         float power_float = static_cast<float>(power_acc) / (32768.0f * 32768.0f);
         if (adapt) {
             float adaptation_step = mu / power_float;
             Q15 step_q15(adaptation_step);
-            for (size_t i = 0; i < filter_length; ++i) {
-                Q15 x_val = x_fixed[(x_index + i) % filter_length];
-                Q15 update = x_val * e_q15;
-                Q15 scaled_update = update * step_q15;
-                w_fixed[i] = w_fixed[i] + scaled_update;
-            }
+            kernels.update_q15(w_fixed.data(), x, e_q15.raw(), step_q15.raw(), filter_length);
         }
-        
-        // Update delay line index
-        x_index = (x_index + 1) % filter_length;
-        
+
+        advance();
+
         return e_q15.raw();
     }
-    
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) {
+        if (use_fixed_point) return false;
+        for (size_t j = 0; j < n; ++j) {
+            out[j * stride] = process_float(far[j * stride], near[j * stride], adapt);
+        }
+        return true;
+    }
+
+    bool process_block(const int16_t* far, const int16_t* near, int16_t* out,
+                       size_t n, size_t stride, bool adapt) {
+        if (!use_fixed_point) return false;
+        for (size_t j = 0; j < n; ++j) {
+            out[j * stride] = process_fixed(far[j * stride], near[j * stride], adapt);
+        }
+        return true;
+    }
+
 private:
+    void advance() {
+        if (++x_index == filter_length) x_index = 0;
+    }
+
     uint32_t filter_length;
     float mu;
     float delta;
     bool use_fixed_point;
-    
-    std::vector<float> w_float;
-    std::vector<float> x_float;
-    std::vector<Q15> w_fixed;
-    std::vector<Q15> x_fixed;
+
+    ArenaVector<float> w_float;
+    ArenaVector<float> x_float;  // mirrored, 2 * filter_length
+    ArenaVector<int16_t> w_fixed; // Q15
+    ArenaVector<int16_t> x_fixed; // Q15, mirrored, 2 * filter_length
     size_t x_index = 0;
+    float power_float_sum = 0.0f; // sum of x^2 over the delay line
+    int32_t power_fixed_sum = 0;  // sum of (x*x) >> 15 over the delay line
+    const simd::Kernels& kernels;
 };
 
 // NLMSFilter implementation
-NLMSFilter::NLMSFilter(uint32_t length, float mu, float delta, bool use_fixed_point)
-    : pimpl(std::make_unique<Impl>(length, mu, delta, use_fixed_point)) {}
+NLMSFilter::NLMSFilter(uint32_t length, float mu, float delta, bool use_fixed_point, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, length, mu, delta, use_fixed_point, arena)) {}
 
 NLMSFilter::~NLMSFilter() = default;
 
@@ -145,13 +199,32 @@ int16_t NLMSFilter::process_fixed(int16_t far_end, int16_t near_end, bool adapt)
     return pimpl->process_fixed(far_end, near_end, adapt);
 }
 
+bool NLMSFilter::process_block(const float* far, const float* near, float* out,
+                               size_t n, size_t stride, bool adapt) {
+    AEC_TRACE_SCOPE("NLMSFilter::process_block");
+    return pimpl->process_block(far, near, out, n, stride, adapt);
+}
+
+bool NLMSFilter::process_block(const int16_t* far, const int16_t* near, int16_t* out,
+                               size_t n, size_t stride, bool adapt) {
+    AEC_TRACE_SCOPE("NLMSFilter::process_block");
+    return pimpl->process_block(far, near, out, n, stride, adapt);
+}
+
 void NLMSFilter::reset() {
     pimpl->reset();
 }
 
+void NLMSFilter::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool NLMSFilter::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
 float NLMSFilter::get_coeff_norm() const {
     return pimpl->get_coeff_norm();
 }
 
 } // namespace aec
-
@@ -0,0 +1,251 @@
+#include "aec/pbfdaf_filter.hpp"
+#include "aec/fft.hpp"
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+
+namespace aec {
+
+class PBFDAFFilter::Impl {
+public:
+    Impl(uint32_t length, uint32_t block_size, float mu, float delta, Arena* arena)
+        : block(is_power_of_two(block_size) ? block_size : 64),
+          fft_size(2 * block), bins(block + 1),
+          num_partitions(std::max<uint32_t>(1, (length + block - 1) / block)),
+          mu(mu), delta(delta), fft(fft_size, arena),
+          X(arena), W(arena), power(arena), time_buf(arena), prev_far(arena), far_buf(arena), near_buf(arena),
+          out_buf(arena), spectrum(arena), err_spectrum(arena) {
+        time_buf.resize(fft_size);
+        prev_far.resize(block);
+        far_buf.resize(block);
+        near_buf.resize(block);
+        out_buf.resize(block);
+        spectrum.resize(bins);
+        err_spectrum.resize(bins);
+        reset();
+    }
+
+    void reset() {
+        std::fill(prev_far.begin(), prev_far.end(), 0.0f);
+        pending = 0;
+        X.assign(static_cast<size_t>(num_partitions) * bins, std::complex<float>(0.0f, 0.0f));
+        W.assign(static_cast<size_t>(num_partitions) * bins, std::complex<float>(0.0f, 0.0f));
+        power.assign(bins, 0.0f);
+        head = 0;
+        constrain_index = 0;
+    }
+
+    void save_state(StateWriter& out) const {
+        out.put(X);
+        out.put(W);
+        out.put(power);
+        out.put(prev_far);
+        out.put(far_buf);
+        out.put(near_buf);
+        out.put(pending);
+        out.put(head);
+        out.put(constrain_index);
+    }
+
+    bool load_state(StateReader& in) {
+        if (!in.get(X) || !in.get(W) || !in.get(power) || !in.get(prev_far) || !in.get(far_buf) ||
+            !in.get(near_buf) || !in.get(pending) || !in.get(head) || !in.get(constrain_index)) {
+            return false;
+        }
+        if (pending >= block || head >= num_partitions || constrain_index >= num_partitions) return in.fail();
+        return true;
+    }
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) {
+        // Samples gather in far_buf/near_buf until a block is complete; the
+        // outputs of a partial block go out at once (see process_partial)
+        for (size_t offset = 0; offset < n;) {
+            const uint32_t first = pending;
+            const uint32_t take = static_cast<uint32_t>(std::min<size_t>(block - first, n - offset));
+            const size_t base = offset * stride;
+            for (uint32_t i = 0; i < take; ++i) {
+                far_buf[first + i] = far[base + i * stride];
+                near_buf[first + i] = near[base + i * stride];
+            }
+            pending = first + take;
+            if (pending == block) {
+                std::copy(prev_far.begin(), prev_far.end(), time_buf.begin());
+                std::copy(far_buf.begin(), far_buf.end(), time_buf.begin() + block);
+                std::copy(far_buf.begin(), far_buf.end(), prev_far.begin());
+                process_one(adapt);
+                pending = 0;
+            } else {
+                process_partial();
+            }
+            for (uint32_t i = 0; i < take; ++i) out[base + i * stride] = out_buf[first + i];
+            offset += take;
+        }
+        return true;
+    }
+
+    float get_coeff_norm() const {
+        // Time-domain taps live in the first `block` samples of each partition
+        float sum = 0.0f;
+        for (uint32_t p = 0; p < num_partitions; ++p) {
+            fft.inverse(&W[static_cast<size_t>(p) * bins], time_buf.data());
+            for (uint32_t i = 0; i < block; ++i) sum += time_buf[i] * time_buf[i];
+        }
+        return std::sqrt(sum);
+    }
+
+    uint32_t get_block_size() const { return block; }
+    uint32_t get_partitions() const { return num_partitions; }
+
+private:
+    std::complex<float>* partition_input(uint32_t age) {
+        uint32_t slot = (head + num_partitions - age) % num_partitions;
+        return &X[static_cast<size_t>(slot) * bins];
+    }
+
+    // Outputs of the first `pending` samples of a block: overlap-save with
+    // the rest of the block zeroed, its spectrum in place of the newest
+    // partition. The weights only change at the block's end, so adaptation
+    // is as for whole blocks; the outputs leave out what partitions not yet
+    // constrained would wrap in from the block's later samples.
+    void process_partial() {
+        std::copy(prev_far.begin(), prev_far.end(), time_buf.begin());
+        std::copy(far_buf.begin(), far_buf.begin() + pending, time_buf.begin() + block);
+        std::fill(time_buf.begin() + block + pending, time_buf.end(), 0.0f);
+        fft.forward(time_buf.data(), err_spectrum.data());
+        for (uint32_t k = 0; k < bins; ++k) spectrum[k] = W[k] * err_spectrum[k];
+        for (uint32_t p = 1; p < num_partitions; ++p) {
+            const std::complex<float>* w = &W[static_cast<size_t>(p) * bins];
+            const std::complex<float>* x = partition_input(p - 1);
+            for (uint32_t k = 0; k < bins; ++k) spectrum[k] += w[k] * x[k];
+        }
+        fft.inverse(spectrum.data(), time_buf.data());
+        for (uint32_t i = 0; i < pending; ++i) out_buf[i] = near_buf[i] - time_buf[block + i];
+    }
+
+    void process_one(bool adapt) {
+        // Newest far-end spectrum replaces the oldest partition
+        head = (head + 1) % num_partitions;
+        std::complex<float>* x0 = partition_input(0);
+        for (uint32_t k = 0; k < bins; ++k) power[k] -= std::norm(x0[k]);
+        fft.forward(time_buf.data(), x0);
+        if (head == 0) {
+            // Recompute exactly once per ring cycle to bound float drift
+            std::fill(power.begin(), power.end(), 0.0f);
+            for (uint32_t p = 0; p < num_partitions; ++p) {
+                const std::complex<float>* x = partition_input(p);
+                for (uint32_t k = 0; k < bins; ++k) power[k] += std::norm(x[k]);
+            }
+        } else {
+            for (uint32_t k = 0; k < bins; ++k) {
+                power[k] = std::max(0.0f, power[k] + std::norm(x0[k]));
+            }
+        }
+
+        // Echo estimate: Y = sum_p W_p * X_{n-p}
+        std::fill(spectrum.begin(), spectrum.end(), std::complex<float>(0.0f, 0.0f));
+        for (uint32_t p = 0; p < num_partitions; ++p) {
+            const std::complex<float>* w = &W[static_cast<size_t>(p) * bins];
+            const std::complex<float>* x = partition_input(p);
+            for (uint32_t k = 0; k < bins; ++k) spectrum[k] += w[k] * x[k];
+        }
+        fft.inverse(spectrum.data(), time_buf.data());
+
+        // Overlap-save: only the last `block` outputs are valid linear convolution
+        for (uint32_t i = 0; i < block; ++i) {
+            out_buf[i] = near_buf[i] - time_buf[block + i];
+        }
+
+        if (!adapt) return;
+
+        std::fill(time_buf.begin(), time_buf.begin() + block, 0.0f);
+        std::copy(out_buf.begin(), out_buf.end(), time_buf.begin() + block);
+        fft.forward(time_buf.data(), err_spectrum.data());
+
+        // Per-bin normalized step. The regularization floor keeps bins with
+        // little far-end energy from amplifying near-end noise.
+        float mean_power = 0.0f;
+        for (uint32_t k = 0; k < bins; ++k) mean_power += power[k];
+        mean_power /= static_cast<float>(bins);
+        const float floor = delta * static_cast<float>(fft_size) * static_cast<float>(num_partitions)
+                          + 1e-2f * mean_power + 1e-20f;
+        const float gain = 2.0f * mu;
+        for (uint32_t k = 0; k < bins; ++k) {
+            err_spectrum[k] *= gain / (power[k] + floor);
+        }
+
+        for (uint32_t p = 0; p < num_partitions; ++p) {
+            std::complex<float>* w = &W[static_cast<size_t>(p) * bins];
+            const std::complex<float>* x = partition_input(p);
+            for (uint32_t k = 0; k < bins; ++k) w[k] += std::conj(x[k]) * err_spectrum[k];
+        }
+
+        // Gradient constraint, one partition per block (AUMDF): drop the
+        // circular-convolution half of the impulse response.
+        std::complex<float>* wc = &W[static_cast<size_t>(constrain_index) * bins];
+        fft.inverse(wc, time_buf.data());
+        std::fill(time_buf.begin() + block, time_buf.end(), 0.0f);
+        fft.forward(time_buf.data(), wc);
+        constrain_index = (constrain_index + 1) % num_partitions;
+    }
+
+    uint32_t block;
+    uint32_t fft_size;
+    uint32_t bins;
+    uint32_t num_partitions;
+    float mu;
+    float delta;
+    mutable RealFFT fft;
+
+    ArenaVector<std::complex<float>> X; // far-end spectra ring, num_partitions x bins
+    ArenaVector<std::complex<float>> W; // partition coefficients, num_partitions x bins
+    ArenaVector<float> power;           // far-end power summed over partitions, per bin
+    mutable ArenaVector<float> time_buf;
+    ArenaVector<float> prev_far;
+    ArenaVector<float> far_buf;  // the block being gathered, `pending` samples so far
+    ArenaVector<float> near_buf;
+    ArenaVector<float> out_buf;
+    ArenaVector<std::complex<float>> spectrum;
+    ArenaVector<std::complex<float>> err_spectrum;
+    uint32_t pending = 0;
+    uint32_t head = 0;
+    uint32_t constrain_index = 0;
+};
+
+// PBFDAFFilter implementation
+PBFDAFFilter::PBFDAFFilter(uint32_t length, uint32_t block_size, float mu, float delta, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, length, block_size, mu, delta, arena)) {}
+
+PBFDAFFilter::~PBFDAFFilter() = default;
+
+bool PBFDAFFilter::process_block(const float* far, const float* near, float* out,
+                                 size_t n, size_t stride, bool adapt) {
+    return pimpl->process_block(far, near, out, n, stride, adapt);
+}
+
+void PBFDAFFilter::reset() {
+    pimpl->reset();
+}
+
+void PBFDAFFilter::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool PBFDAFFilter::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
+float PBFDAFFilter::get_coeff_norm() const {
+    return pimpl->get_coeff_norm();
+}
+
+uint32_t PBFDAFFilter::block_size() const {
+    return pimpl->get_block_size();
+}
+
+uint32_t PBFDAFFilter::partitions() const {
+    return pimpl->get_partitions();
+}
+
+} // namespace aec
@@ -0,0 +1,204 @@
+#include "aec/resampler.hpp"
+#include "aec/simd_kernels.hpp"
+#include "aec/trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace aec {
+
+static constexpr uint32_t kMaxRatioTerm = 1024;
+static constexpr double kStopbandDb = 80.0;
+// Cutoff and transition width relative to the lower rate's Nyquist
+// frequency: the pass band ends at 0.82, the stop band starts at 1.0
+static constexpr double kCutoff = 0.91;
+static constexpr double kTransition = 0.18;
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        const uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser
+// window
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 64 && term > 1e-12 * sum; ++k) {
+        const double q = x / (2.0 * k);
+        term *= q * q;
+        sum += term;
+    }
+    return sum;
+}
+
+// The banks hold bank p (output phase p of `up`) as row p, tap j of a row
+// weighting the input j samples before the newest. Each channel's history
+// is mirrored like NLMSFilter's delay line (sample i at both i and i + taps,
+// newest first), so a bank always meets `taps` contiguous inputs.
+class Resampler::Impl {
+public:
+    Impl(uint32_t in_rate, uint32_t out_rate, uint32_t channels, Arena* arena)
+        : C(std::max<uint32_t>(1, channels)), bank(arena), history(arena), kernels(simd::kernels()) {
+        if (supports(in_rate, out_rate)) {
+            const uint32_t g = gcd(in_rate, out_rate);
+            L = out_rate / g;
+            M = in_rate / g;
+        }
+        design(std::min(in_rate, out_rate), in_rate);
+        history.resize(static_cast<size_t>(2) * T * C);
+        reset();
+    }
+
+    void reset() {
+        std::fill(history.begin(), history.end(), 0.0f);
+        pos = 0;
+        phase = 0;
+    }
+
+    template <typename T_in, typename T_out>
+    size_t process(const T_in* in, size_t frames, T_out* out) {
+        if (L == M) {
+            for (size_t i = 0; i < frames * C; ++i) out[i] = convert<T_out>(static_cast<float>(in[i]));
+            return frames;
+        }
+        size_t written = 0;
+        for (size_t f = 0; f < frames; ++f) {
+            pos = pos == 0 ? T - 1 : pos - 1;
+            for (uint32_t c = 0; c < C; ++c) {
+                float* h = &history[static_cast<size_t>(c) * 2 * T];
+                h[pos] = h[pos + T] = static_cast<float>(in[f * C + c]);
+            }
+            // Every output whose position falls at or after this input and
+            // before the next one
+            for (; phase < L; phase += M, ++written) {
+                const float* taps = &bank[static_cast<size_t>(phase) * T];
+                for (uint32_t c = 0; c < C; ++c) {
+                    const float* window = &history[static_cast<size_t>(c) * 2 * T + pos];
+                    out[written * C + c] = convert<T_out>(kernels.dot_f32(taps, window, T));
+                }
+            }
+            phase -= L;
+        }
+        return written;
+    }
+
+    size_t max_output(size_t frames) const {
+        return static_cast<size_t>((static_cast<uint64_t>(frames) * L + M - 1) / M);
+    }
+
+    uint32_t up() const { return L; }
+    uint32_t down() const { return M; }
+    uint32_t taps() const { return T; }
+    uint32_t latency() const {
+        return static_cast<uint32_t>((static_cast<uint64_t>(T) * L - 1 + M) / (2 * M));
+    }
+
+private:
+    // Kaiser-windowed sinc at the upsampled rate in_rate * L, with gain L to
+    // make up for the zeros upsampling inserts
+    void design(uint32_t lower_rate, uint32_t in_rate) {
+        if (L == M) {
+            T = 1;
+            bank.assign(1, 1.0f);
+            return;
+        }
+        const double pi = 3.14159265358979323846;
+        const double fs = static_cast<double>(in_rate) * L;
+        const double nyquist = 0.5 * lower_rate;
+        const double width = 2.0 * pi * kTransition * nyquist / fs;
+        const uint32_t length = static_cast<uint32_t>(std::ceil((kStopbandDb - 8.0) / (2.285 * width))) + 1;
+        // Rows padded to whole vectors
+        T = ((length + L - 1) / L + 7) & ~7u;
+
+        const uint32_t P = T * L;
+        const double fc = kCutoff * nyquist / fs;
+        const double beta = 0.1102 * (kStopbandDb - 8.7);
+        const double centre = 0.5 * (P - 1);
+        const double norm = bessel_i0(beta);
+        bank.assign(P, 0.0f);
+        for (uint32_t k = 0; k < P; ++k) {
+            const double t = k - centre;
+            const double r = t / centre;
+            const double window = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+            const double x = 2.0 * pi * fc * t;
+            const double sinc = std::abs(x) < 1e-12 ? 1.0 : std::sin(x) / x;
+            const double h = L * 2.0 * fc * sinc * window;
+            bank[static_cast<size_t>(k % L) * T + k / L] = static_cast<float>(h);
+        }
+    }
+
+    template <typename T_out>
+    static T_out convert(float v);
+
+    uint32_t C;
+    uint32_t L = 1; // up
+    uint32_t M = 1; // down
+    uint32_t T = 1; // taps per bank
+    ArenaVector<float> bank;
+    ArenaVector<float> history; // 2T mirrored samples per channel
+    const simd::Kernels& kernels;
+    uint32_t pos = 0;
+    uint32_t phase = 0; // next output's offset past the newest input, in 1/L samples
+};
+
+template <>
+float Resampler::Impl::convert<float>(float v) {
+    return v;
+}
+
+template <>
+int16_t Resampler::Impl::convert<int16_t>(float v) {
+    return static_cast<int16_t>(std::lrint(std::min(32767.0f, std::max(-32768.0f, v))));
+}
+
+// Resampler implementation
+Resampler::Resampler(uint32_t in_rate, uint32_t out_rate, uint32_t channels, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, in_rate, out_rate, channels, arena)) {}
+
+Resampler::~Resampler() = default;
+
+bool Resampler::supports(uint32_t in_rate, uint32_t out_rate) {
+    if (in_rate == 0 || out_rate == 0) return false;
+    const uint32_t g = gcd(in_rate, out_rate);
+    return in_rate / g <= kMaxRatioTerm && out_rate / g <= kMaxRatioTerm;
+}
+
+size_t Resampler::process(const float* in, size_t frames, float* out) {
+    AEC_TRACE_SCOPE("Resampler::process");
+    return pimpl->process(in, frames, out);
+}
+
+size_t Resampler::process(const int16_t* in, size_t frames, int16_t* out) {
+    AEC_TRACE_SCOPE("Resampler::process");
+    return pimpl->process(in, frames, out);
+}
+
+size_t Resampler::max_output(size_t frames) const {
+    return pimpl->max_output(frames);
+}
+
+void Resampler::reset() {
+    pimpl->reset();
+}
+
+uint32_t Resampler::up() const {
+    return pimpl->up();
+}
+
+uint32_t Resampler::down() const {
+    return pimpl->down();
+}
+
+uint32_t Resampler::taps_per_phase() const {
+    return pimpl->taps();
+}
+
+uint32_t Resampler::latency() const {
+    return pimpl->latency();
+}
+
+} // namespace aec
@@ -0,0 +1,322 @@
+#include "aec/residual_echo_suppressor.hpp"
+#include "aec/fft.hpp"
+#include "aec/trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <initializer_list>
+
+namespace aec {
+
+// Samples on the [-1, 1) scale, as in the double-talk detector
+static inline double unit(int16_t v) { return static_cast<double>(v) / 32768.0; }
+static inline double unit(float v) { return static_cast<double>(v); }
+static inline void from_unit(double v, int16_t& out) {
+    out = static_cast<int16_t>(std::lrint(std::min(std::max(v * 32768.0, -32768.0), 32767.0)));
+}
+static inline void from_unit(double v, float& out) { out = static_cast<float>(v); }
+
+// Exponential smoothing that settles on exact zero instead of running down
+// through denormals, which are slow on most CPUs: anything below about
+// 1e-46 is lost when the guard is added and taken away again
+static constexpr double kDenormalGuard = 1e-30;
+static inline double smooth(double state, double value, double a) {
+    return (a * state + (1.0 - a) * value + kDenormalGuard) - kDenormalGuard;
+}
+// The same guard for float state, which loses anything below about 1e-27
+static constexpr float kDenormalGuardF = 1e-20f;
+
+// Bins with less smoothed far-end power than this (about -60 dBFS in a
+// 256-point frame) teach no leak
+static constexpr double kFarActive = 1e-4;
+
+// The echo tail is measured by the error's cross-spectra with the far-end
+// of the frames before, over about kTailSamples. Near-end talk is not
+// correlated with the far-end, so it adds only the estimates' noise, which
+// the slower kTailAlpha keeps small and which is subtracted on average:
+// (1 - a) / (1 + a) * See * Sxx per lag.
+static constexpr uint32_t kTailSamples = 2048;
+static constexpr double kTailAlpha = 0.98;
+
+// Limits on the learned leak. Near-end talk quiet enough to pass the
+// detector looks like leak, so the leak stays within kLeakTailMargin times
+// the measured tail; the margin is wide because cutting the tail into
+// frames loses much of its coherence, and it reads several times low.
+// Within that the leak rises by at most kLeakRiseStep per frame (0.5 dB)
+// from kLeakFloor; it falls at the spectra's rate.
+static constexpr double kLeakTailMargin = 10.0;
+static constexpr double kLeakRiseStep = 1.122;
+static constexpr double kLeakFloor = 1e-4;
+
+class ResidualEchoSuppressor::Impl {
+public:
+    Impl(uint32_t frame_size, float over_suppression, float min_gain_db, float smoothing_alpha, Arena* arena)
+        : N(DoubleTalkDetector::transform_size(frame_size)), bins(N / 2 + 1), M(2 * N),
+          lags((kTailSamples + frame_size - 1) / std::max(frame_size, 1u)),
+          over(over_suppression), min_gain(std::pow(10.0, min_gain_db / 20.0)),
+          alpha(std::min(std::max(smoothing_alpha, 0.0f), 0.999f)), fft(N, arena), synthesis(M, arena),
+          input(arena), frame(arena), X(arena), Y(arena), E(arena), err_re(arena), err_im(arena), sxx(arena),
+          syy(arena), see(arena), sxe_re(arena), sxe_im(arena), history_re(arena), history_im(arena),
+          tail_re(arena), tail_im(arena), tail(arena), leak(arena), gain(arena), ring(arena) {
+        input.resize(N);
+        frame.resize(M);
+        X.resize(bins);
+        Y.resize(bins);
+        E.resize(M / 2 + 1);
+        err_re.resize(bins);
+        err_im.resize(bins);
+        tail.resize(bins);
+        gain.resize(bins);
+        reset();
+    }
+
+    void reset() {
+        for (ArenaVector<double>* v : {&sxx, &syy, &see, &sxe_re, &sxe_im, &leak}) {
+            v->assign(bins, 0.0);
+        }
+        for (ArenaVector<float>* v : {&history_re, &history_im, &tail_re, &tail_im}) {
+            v->assign(static_cast<size_t>(lags) * bins, 0.0f);
+        }
+        newest = 0;
+        ring.assign(M, 0.0f);
+        last_gain = 1.0;
+    }
+
+    void save_state(StateWriter& out) const {
+        for (const ArenaVector<double>* v : {&sxx, &syy, &see, &sxe_re, &sxe_im, &leak}) {
+            out.put(*v);
+        }
+        for (const ArenaVector<float>* v : {&history_re, &history_im, &tail_re, &tail_im, &ring}) {
+            out.put(*v);
+        }
+        out.put(newest);
+        out.put(last_gain);
+    }
+
+    bool load_state(StateReader& in) {
+        for (ArenaVector<double>* v : {&sxx, &syy, &see, &sxe_re, &sxe_im, &leak}) {
+            if (!in.get(*v)) return false;
+        }
+        for (ArenaVector<float>* v : {&history_re, &history_im, &tail_re, &tail_im, &ring}) {
+            if (!in.get(*v)) return false;
+        }
+        if (!in.get(newest) || !in.get(last_gain)) return false;
+        if (newest >= lags) return in.fail();
+        return true;
+    }
+
+    template <typename T>
+    void process(const T* far, const T* near, T* out, uint32_t n, const DTDSpectra* spectra, Decision decision) {
+        if (n <= N) {
+            process_frame(far, near, out, n, spectra, decision);
+            return;
+        }
+        // The detector folded this frame, so its spectra do not fit
+        for (uint32_t offset = 0; offset < n; offset += N) {
+            process_frame(far + offset, near + offset, out + offset, std::min(N, n - offset), nullptr, decision);
+        }
+    }
+
+    uint32_t transform_size() const { return N; }
+    float last_gain_db() const { return static_cast<float>(20.0 * std::log10(last_gain)); }
+
+private:
+    template <typename T>
+    void process_frame(const T* far, const T* near, T* out, uint32_t n, const DTDSpectra* spectra,
+                       Decision decision) {
+        // The error at twice the detector's size, so the gain's ringing has
+        // room; its even bins are the detector-sized spectrum
+        load(out, n, frame.data(), M);
+        synthesis.forward(frame.data(), E.data());
+        for (uint32_t k = 0; k < bins; ++k) {
+            err_re[k] = E[2 * k].real();
+            err_im[k] = E[2 * k].imag();
+        }
+        const std::complex<double>* x = X.data();
+        const double* yr = reinterpret_cast<const double*>(Y.data());
+        const double* yi = yr + 1;
+        size_t stride = 2;
+        if (spectra && spectra->far && spectra->bins == bins) {
+            x = spectra->far;
+            yr = spectra->near_re;
+            yi = spectra->near_im;
+            stride = spectra->stride;
+        } else {
+            load(far, n, input.data(), N);
+            fft.forward(input.data(), X.data());
+            load(near, n, input.data(), N);
+            fft.forward(input.data(), Y.data());
+        }
+        measure_tail();
+        newest = newest + 1 < lags ? newest + 1 : 0;
+        float* hr = &history_re[static_cast<size_t>(newest) * bins];
+        float* hi = &history_im[static_cast<size_t>(newest) * bins];
+        for (uint32_t k = 0; k < bins; ++k) {
+            hr[k] = static_cast<float>(x[k].real());
+            hi[k] = static_cast<float>(x[k].imag());
+        }
+
+        // Double-talk is when over-suppression would cost the most near-end
+        const double scale = decision == Decision::DoubleTalk ? 1.0 : over;
+        const bool learn = decision == Decision::FarEndOnly;
+        const double a = alpha;
+        const double bias = lags * (1.0 - kTailAlpha) / (1.0 + kTailAlpha);
+        for (uint32_t k = 0; k < bins; ++k) {
+            const double xr = x[k].real(), xi = x[k].imag();
+            const double nr = yr[k * stride], ni = yi[k * stride];
+            const double er = err_re[k], ei = err_im[k];
+            // X * conj(E), written out as in the detector
+            sxx[k] = smooth(sxx[k], xr * xr + xi * xi, a);
+            syy[k] = smooth(syy[k], nr * nr + ni * ni, a);
+            see[k] = smooth(see[k], er * er + ei * ei, a);
+            sxe_re[k] = smooth(sxe_re[k], xr * er + xi * ei, a);
+            sxe_im[k] = smooth(sxe_im[k], xi * er - xr * ei, a);
+
+            // Echo-only frames teach the bin's leak, the error left per unit
+            // of far-end power, which covers echo from before the frame
+            if (learn && sxx[k] > kFarActive) {
+                const double tail_gain = std::max(tail[k] - bias * see[k] * sxx[k], 0.0) / (sxx[k] * sxx[k]);
+                const double target = std::min(see[k] / sxx[k], kLeakTailMargin * tail_gain);
+                leak[k] = std::min(smooth(leak[k], target, a), std::max(leak[k], kLeakFloor) * kLeakRiseStep);
+            }
+            const double cxe = (sxe_re[k] * sxe_re[k] + sxe_im[k] * sxe_im[k]) / (sxx[k] * see[k] + 1e-24);
+            const double residual = std::min(std::max(cxe * see[k], leak[k] * sxx[k]), syy[k]);
+            gain[k] = std::max(min_gain, 1.0 - scale * residual / (see[k] + 1e-24));
+        }
+
+        // Smoothing across bins keeps each frame's filter short; the odd
+        // bins of the double-size transform take the mean of their neighbours
+        double sum = 0.0, previous = gain[0];
+        for (uint32_t k = 0; k < bins; ++k) {
+            const double g = 0.5 * gain[k] + 0.25 * (previous + gain[k + 1 < bins ? k + 1 : k]);
+            previous = gain[k];
+            gain[k] = g;
+            sum += g;
+        }
+        last_gain = sum / bins;
+        for (uint32_t k = 0; k < bins; ++k) {
+            E[2 * k] *= static_cast<float>(gain[k]);
+            if (k + 1 < bins) E[2 * k + 1] *= static_cast<float>(0.5 * (gain[k] + gain[k + 1]));
+        }
+        synthesis.inverse(E.data(), frame.data());
+
+        // Overlap-add: the gain rings past the frame's end into the next
+        // frames. The wrapped-around half of the spare room is ringing from
+        // before the frame, which has been played already and is dropped
+        for (uint32_t i = 0; i < n; ++i) from_unit(static_cast<double>(frame[i]) + ring[i], out[i]);
+        std::copy(ring.begin() + n, ring.end(), ring.begin());
+        std::fill(ring.end() - n, ring.end(), 0.0f);
+        const uint32_t spare = (M - n) / 2;
+        for (uint32_t j = 0; j < spare; ++j) ring[j] += frame[n + j];
+    }
+
+    // The tail's power gain times Sxx^2 per bin, the sum over lags of
+    // |Sxe_l|^2, from the far-end history before this frame's is added.
+    // Two passes per lag over contiguous bins, in float, so both vectorize.
+    void measure_tail() {
+        const float b = 1.0f - static_cast<float>(kTailAlpha);
+        const float a = static_cast<float>(kTailAlpha);
+        const float* er = err_re.data();
+        const float* ei = err_im.data();
+        float* t = tail.data();
+        std::fill(t, t + bins, 0.0f);
+        for (uint32_t l = 0; l < lags; ++l) {
+            const uint32_t slot = newest >= l ? newest - l : newest + lags - l;
+            const float* hr = &history_re[static_cast<size_t>(slot) * bins];
+            const float* hi = &history_im[static_cast<size_t>(slot) * bins];
+            float* sr = &tail_re[static_cast<size_t>(l) * bins];
+            float* si = &tail_im[static_cast<size_t>(l) * bins];
+            for (uint32_t k = 0; k < bins; ++k) {
+                // X_l * conj(E)
+                const float pr = hr[k] * er[k] + hi[k] * ei[k];
+                const float pi = hi[k] * er[k] - hr[k] * ei[k];
+                sr[k] = (a * sr[k] + b * pr + kDenormalGuardF) - kDenormalGuardF;
+                si[k] = (a * si[k] + b * pi + kDenormalGuardF) - kDenormalGuardF;
+            }
+            for (uint32_t k = 0; k < bins; ++k) t[k] += sr[k] * sr[k] + si[k] * si[k];
+        }
+    }
+
+    // Frame of n samples, zero-padded to `size`, into `dst`
+    template <typename T, typename U>
+    static void load(const T* in, uint32_t n, U* dst, uint32_t size) {
+        for (uint32_t i = 0; i < n; ++i) dst[i] = static_cast<U>(unit(in[i]));
+        std::fill(dst + n, dst + size, U(0));
+    }
+
+    uint32_t N;    // transform size, the detector's
+    uint32_t bins;
+    uint32_t M;    // synthesis transform size
+    uint32_t lags; // frames of far-end history
+    double over;
+    double min_gain;
+    double alpha;
+    RealFFTd fft;       // far and near, when not the detector's
+    RealFFT synthesis;  // the error, in float: only the gains need the precision
+    ArenaVector<double> input;
+    ArenaVector<float> frame;
+    ArenaVector<std::complex<double>> X;
+    ArenaVector<std::complex<double>> Y;
+    ArenaVector<std::complex<float>> E; // error, M/2 + 1 bins
+    ArenaVector<float> err_re;          // and its even bins, the detector-sized spectrum
+    ArenaVector<float> err_im;
+    // Smoothed power and cross spectra
+    ArenaVector<double> sxx;
+    ArenaVector<double> syy;
+    ArenaVector<double> see;
+    ArenaVector<double> sxe_re;
+    ArenaVector<double> sxe_im;
+    // Far-end spectra of the last `lags` frames, a ring with `newest` the
+    // last frame's, and the error's cross-spectra with each lag at kTailAlpha
+    ArenaVector<float> history_re;
+    ArenaVector<float> history_im;
+    ArenaVector<float> tail_re;
+    ArenaVector<float> tail_im;
+    ArenaVector<float> tail;
+    ArenaVector<double> leak; // See / Sxx over echo-only frames, within the kLeak* limits
+    ArenaVector<double> gain;
+    ArenaVector<float> ring; // overlap-add tail still to be played
+    uint32_t newest = 0;
+    double last_gain = 1.0;
+};
+
+// ResidualEchoSuppressor implementation
+ResidualEchoSuppressor::ResidualEchoSuppressor(uint32_t frame_size, float over_suppression, float min_gain_db,
+                                               float smoothing_alpha, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, frame_size, over_suppression, min_gain_db, smoothing_alpha, arena)) {}
+
+ResidualEchoSuppressor::~ResidualEchoSuppressor() = default;
+
+void ResidualEchoSuppressor::reset() {
+    pimpl->reset();
+}
+
+void ResidualEchoSuppressor::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool ResidualEchoSuppressor::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
+void ResidualEchoSuppressor::process(const int16_t* far, const int16_t* near, int16_t* out, uint32_t n,
+                                     const DTDSpectra* spectra, Decision decision) {
+    AEC_TRACE_SCOPE("ResidualEchoSuppressor::process");
+    pimpl->process(far, near, out, n, spectra, decision);
+}
+
+void ResidualEchoSuppressor::process(const float* far, const float* near, float* out, uint32_t n,
+                                     const DTDSpectra* spectra, Decision decision) {
+    AEC_TRACE_SCOPE("ResidualEchoSuppressor::process");
+    pimpl->process(far, near, out, n, spectra, decision);
+}
+
+uint32_t ResidualEchoSuppressor::transform_size() const {
+    return pimpl->transform_size();
+}
+
+float ResidualEchoSuppressor::last_gain_db() const {
+    return pimpl->last_gain_db();
+}
+
+} // namespace aec
@@ -0,0 +1,202 @@
+#include "aec/rls_filter.hpp"
+#include <vector>
+#include <initializer_list>
+#include <algorithm>
+#include <cmath>
+
+namespace aec {
+
+// Recursions follow the a posteriori LSL (Haykin, "Adaptive Filter Theory",
+// recursive LSL using a posteriori estimation errors). For stage m at time n:
+//
+//   delta_m(n) = lambda delta_m(n-1) + b_m(n-1) f_m(n) / gamma_m(n-1)
+//   f_m+1(n)   = f_m(n) - delta_m(n) / B_m(n-1) * b_m(n-1)
+//   b_m+1(n)   = b_m(n-1) - delta_m(n) / F_m(n) * f_m(n)
+//   F_m+1(n)   = F_m(n) - delta_m(n)^2 / B_m(n-1)
+//   B_m+1(n)   = B_m(n-1) - delta_m(n)^2 / F_m(n)
+//   gamma_m+1(n) = gamma_m(n) - b_m(n)^2 / B_m(n)
+//
+// and the joint process estimates the near-end signal from the orthogonal
+// backward errors b_0..b_{L-1}. State is kept in double: the lattice divides
+// by error energies that can get small, and float loses the recursion within
+// seconds at lambda close to 1.
+class RLSFilter::Impl {
+public:
+    Impl(uint32_t length, float lambda, float delta, Arena* arena)
+        : order(std::max<uint32_t>(1, length)),
+          lambda(std::min(std::max(static_cast<double>(lambda), 0.9), 0.999999)),
+          init_energy(std::max(static_cast<double>(delta), 1e-6)),
+          cross(arena), rho(arena), kappa(arena), gain_f(arena), gain_b(arena), b_prev(arena), b_cur(arena),
+          B_prev(arena), B_cur(arena), gamma_prev(arena), gamma_cur(arena) {
+        reset();
+    }
+
+    void reset() {
+        cross.assign(order, 0.0);
+        rho.assign(order, 0.0);
+        kappa.assign(order, 0.0);
+        gain_f.assign(order, 0.0);
+        gain_b.assign(order, 0.0);
+        b_prev.assign(order, 0.0);
+        b_cur.assign(order, 0.0);
+        B_prev.assign(order, init_energy);
+        B_cur.assign(order, init_energy);
+        gamma_prev.assign(order, 1.0);
+        gamma_cur.assign(order, 1.0);
+        F0 = init_energy;
+    }
+
+    void save_state(StateWriter& out) const {
+        for (const ArenaVector<double>* v : {&cross, &rho, &kappa, &gain_f, &gain_b, &b_prev, &b_cur, &B_prev,
+                                             &B_cur, &gamma_prev, &gamma_cur}) {
+            out.put(*v);
+        }
+        out.put(F0);
+    }
+
+    bool load_state(StateReader& in) {
+        for (ArenaVector<double>* v : {&cross, &rho, &kappa, &gain_f, &gain_b, &b_prev, &b_cur, &B_prev,
+                                       &B_cur, &gamma_prev, &gamma_cur}) {
+            if (!in.get(*v)) return false;
+        }
+        return in.get(F0);
+    }
+
+    float process(float far_end, float near_end, bool adapt) {
+        const double out = adapt ? adapt_sample(far_end, near_end) : filter_sample(far_end, near_end);
+        if (!std::isfinite(out)) {
+            // Numerical breakdown: restart rather than emit garbage
+            reset();
+            return near_end;
+        }
+        return static_cast<float>(out);
+    }
+
+    bool process_block(const float* far, const float* near, float* out,
+                       size_t n, size_t stride, bool adapt) {
+        for (size_t j = 0; j < n; ++j) {
+            out[j * stride] = process(far[j * stride], near[j * stride], adapt);
+        }
+        return true;
+    }
+
+    float get_coeff_norm() const {
+        double sum = 0.0;
+        for (double k : kappa) sum += k * k;
+        return static_cast<float>(std::sqrt(sum));
+    }
+
+private:
+    // Full time and order update; returns the a priori error
+    double adapt_sample(double x, double d) {
+        // Order-update of the prediction lattice
+        double f = x;
+        F0 = lambda * F0 + x * x;
+        double F = std::max(F0, kEnergyFloor);
+        b_cur[0] = x;
+        B_cur[0] = F;
+        gamma_cur[0] = 1.0;
+        for (uint32_t m = 0; m + 1 < order; ++m) {
+            const double bp = b_prev[m];
+            const double Bp = B_prev[m];
+            cross[m] = lambda * cross[m] + bp * f / gamma_prev[m];
+            const double c = cross[m];
+            gain_f[m] = -c / Bp;
+            gain_b[m] = -c / F;
+            const double f_next = f + gain_f[m] * bp;
+            b_cur[m + 1] = bp + gain_b[m] * f;
+            const double F_next = F - c * c / Bp;
+            B_cur[m + 1] = std::max(Bp - c * c / F, kEnergyFloor);
+            gamma_cur[m + 1] = clamp_gamma(gamma_cur[m] - b_cur[m] * b_cur[m] / B_cur[m]);
+            f = f_next;
+            F = std::max(F_next, kEnergyFloor);
+        }
+
+        // Joint process: remove the part of the near-end explained by each
+        // backward error in turn
+        double e = d;
+        for (uint32_t m = 0; m < order; ++m) {
+            rho[m] = lambda * rho[m] + b_cur[m] * e / gamma_cur[m];
+            kappa[m] = rho[m] / B_cur[m];
+            e -= kappa[m] * b_cur[m];
+        }
+        // a posteriori error -> a priori error via the conversion factor
+        const uint32_t last = order - 1;
+        const double gamma_full = clamp_gamma(gamma_cur[last] - b_cur[last] * b_cur[last] / B_cur[last]);
+
+        std::swap(b_prev, b_cur);
+        std::swap(B_prev, B_cur);
+        std::swap(gamma_prev, gamma_cur);
+        return e / gamma_full;
+    }
+
+    // Adaptation frozen: run the lattice and ladder with their last
+    // coefficients, which is a fixed FIR filter
+    double filter_sample(double x, double d) {
+        double f = x;
+        b_cur[0] = x;
+        for (uint32_t m = 0; m + 1 < order; ++m) {
+            const double bp = b_prev[m];
+            b_cur[m + 1] = bp + gain_b[m] * f;
+            f += gain_f[m] * bp;
+        }
+        double e = d;
+        for (uint32_t m = 0; m < order; ++m) e -= kappa[m] * b_cur[m];
+        std::swap(b_prev, b_cur);
+        return e;
+    }
+
+    static constexpr double kEnergyFloor = 1e-12;
+    static constexpr double kGammaFloor = 1e-6;
+
+    static double clamp_gamma(double g) {
+        return std::min(1.0, std::max(g, kGammaFloor));
+    }
+
+    uint32_t order;
+    double lambda;
+    double init_energy;
+    double F0 = 0.0;
+
+    ArenaVector<double> cross;      // forward/backward cross-correlation per stage
+    ArenaVector<double> rho;        // joint-process cross-correlation
+    ArenaVector<double> kappa;      // ladder coefficients
+    ArenaVector<double> gain_f;     // forward reflection coefficients
+    ArenaVector<double> gain_b;     // backward reflection coefficients
+    ArenaVector<double> b_prev, b_cur;
+    ArenaVector<double> B_prev, B_cur;
+    ArenaVector<double> gamma_prev, gamma_cur;
+};
+
+// RLSFilter implementation
+RLSFilter::RLSFilter(uint32_t length, float lambda, float delta, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, length, lambda, delta, arena)) {}
+
+RLSFilter::~RLSFilter() = default;
+
+float RLSFilter::process(float far_end, float near_end, bool adapt) {
+    return pimpl->process(far_end, near_end, adapt);
+}
+
+bool RLSFilter::process_block(const float* far, const float* near, float* out,
+                              size_t n, size_t stride, bool adapt) {
+    return pimpl->process_block(far, near, out, n, stride, adapt);
+}
+
+void RLSFilter::reset() {
+    pimpl->reset();
+}
+
+void RLSFilter::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool RLSFilter::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
+float RLSFilter::get_coeff_norm() const {
+    return pimpl->get_coeff_norm();
+}
+
+} // namespace aec
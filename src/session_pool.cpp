@@ -0,0 +1,348 @@
+#include "aec/session_pool.hpp"
+#include "aec/double_talk_detector.hpp"
+#include "aec/fixed_point.hpp"
+#include "aec/simd_kernels.hpp"
+#include "aec/trace.hpp"
+#include "aec/worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace aec {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t elapsed_ns(Clock::time_point from, Clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+// Rounds a row length up to a whole number of 64-byte cache lines
+size_t padded(size_t count, size_t element_size) {
+    const size_t per_line = 64 / element_size;
+    return (count + per_line - 1) / per_line * per_line;
+}
+
+// A thread's share of the batch: entries [next, end) packed into one word
+// (next in the low half), so the owner taking from the front and thieves
+// taking from the back agree through a single compare-and-swap
+uint64_t pack(uint32_t next, uint32_t end) { return static_cast<uint64_t>(end) << 32 | next; }
+uint32_t range_next(uint64_t range) { return static_cast<uint32_t>(range); }
+uint32_t range_end(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+
+} // namespace
+
+// The NLMS arithmetic is NLMSFilter's, operating on one session's row of
+// the shared arrays; see nlms_filter.cpp for the mirrored delay line and the
+// sliding power sum.
+class AECSessionPool::Impl {
+public:
+    Impl(const AECConfig& config, uint32_t max_sessions, uint32_t worker_threads)
+        : config(config),
+          capacity(max_sessions),
+          length(std::max<uint32_t>(1, config.filter_length)),
+          fixed(config.use_fixed_point),
+          kernels(simd::kernels()),
+          w_stride(padded(length, fixed ? sizeof(int16_t) : sizeof(float))),
+          x_stride(padded(2 * static_cast<size_t>(length), fixed ? sizeof(int16_t) : sizeof(float))),
+          lanes(worker_threads + 1) {
+        if (fixed) {
+            w_fixed.assign(capacity * w_stride, 0);
+            x_fixed.assign(capacity * x_stride, 0);
+            power_fixed.assign(capacity, 0);
+        } else {
+            w_float.assign(capacity * w_stride, 0.0f);
+            x_float.assign(capacity * x_stride, 0.0f);
+            power_float.assign(capacity, 0.0f);
+            far_block.resize(static_cast<size_t>(lanes.size()) * config.frame_size);
+            near_block.resize(far_block.size());
+            out_block.resize(far_block.size());
+        }
+        x_index.assign(capacity, 0);
+        active.assign(capacity, 0);
+        batch_stamp.assign(capacity, 0);
+        session_counters.assign(capacity, SessionStats());
+        dtds.assign(capacity, DoubleTalkDetector(config.frame_size,
+                                                 config.dtd_near_to_far_threshold,
+                                                 config.dtd_coherence_threshold,
+                                                 config.dtd_smoothing_alpha,
+                                                 config.dtd_hangover_frames,
+                                                 config.dtd_use_frequency,
+                                                 config.dtd_freq_bins,
+                                                 config.dtd_tiered,
+                                                 config.dtd_tier_near_ratio));
+#if defined(AEC_ENABLE_TRACING)
+        // As in AEC: the constructing thread usually runs batches too, so it
+        // gets its trace ring here rather than on the first frame
+        trace::register_thread();
+#endif
+        if (worker_threads > 0) pool = std::make_unique<WorkerPool>(worker_threads, config.pin_worker_threads);
+    }
+
+    int32_t open_session() {
+        for (uint32_t s = 0; s < capacity; ++s) {
+            if (!active[s]) {
+                active[s] = 1;
+                reset_session(s);
+                return static_cast<int32_t>(s);
+            }
+        }
+        return -1;
+    }
+
+    void close_session(uint32_t s) {
+        if (s < capacity) active[s] = 0;
+    }
+
+    void reset_session(uint32_t s) {
+        if (s >= capacity) return;
+        if (fixed) {
+            std::fill_n(&w_fixed[s * w_stride], w_stride, 0);
+            std::fill_n(&x_fixed[s * x_stride], x_stride, 0);
+            power_fixed[s] = 0;
+        } else {
+            std::fill_n(&w_float[s * w_stride], w_stride, 0.0f);
+            std::fill_n(&x_float[s * x_stride], x_stride, 0.0f);
+            power_float[s] = 0.0f;
+        }
+        x_index[s] = 0;
+        dtds[s].reset();
+        session_counters[s] = SessionStats();
+    }
+
+    uint32_t active_sessions() const {
+        return static_cast<uint32_t>(std::count(active.begin(), active.end(), 1));
+    }
+
+    uint32_t max_sessions() const { return capacity; }
+
+    bool process(const SessionFrame* frames, uint32_t count) {
+        const Clock::time_point start = Clock::now();
+        ++batch;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t s = frames[i].session;
+            if (s >= capacity || !active[s] || batch_stamp[s] == batch) return false;
+            batch_stamp[s] = batch;
+        }
+
+        // Even split, remainder to the first lanes
+        job_frames = frames;
+        const uint32_t n = static_cast<uint32_t>(lanes.size());
+        for (uint32_t p = 0; p < n; ++p) {
+            const uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * p / n);
+            const uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (p + 1) / n);
+            lanes[p].range.store(pack(begin, end), std::memory_order_relaxed);
+            lanes[p].steals = 0;
+            lanes[p].busy_ns = 0;
+        }
+        if (pool && count > 1) {
+            pool->run(n, &Impl::run_lane, this);
+        } else {
+            for (uint32_t p = 0; p < n; ++p) run_lane(this, p);
+        }
+
+        for (const Lane& lane : lanes) {
+            totals.steals += lane.steals;
+            totals.processing_ns += lane.busy_ns;
+        }
+        totals.batches += 1;
+        totals.frames += count;
+        totals.samples += static_cast<uint64_t>(count) * config.frame_size;
+        totals.wall_ns += elapsed_ns(start, Clock::now());
+        return true;
+    }
+
+    SessionStats session_stats(uint32_t s) const { return s < capacity ? session_counters[s] : SessionStats(); }
+
+    SessionPoolStats stats() const {
+        SessionPoolStats out = totals;
+        if (out.wall_ns > 0 && config.sample_rate > 0) {
+            out.realtime_factor = static_cast<double>(out.samples) / config.sample_rate / (out.wall_ns * 1e-9);
+        }
+        return out;
+    }
+
+    void reset_stats() {
+        totals = SessionPoolStats();
+        std::fill(session_counters.begin(), session_counters.end(), SessionStats());
+    }
+
+private:
+    // Works through lane p's range, then steals from the others until no
+    // lane has frames left. The clock is read once per frame.
+    static void run_lane(void* self, uint32_t p) {
+        Impl* impl = static_cast<Impl*>(self);
+        Lane& own = impl->lanes[p];
+        const uint32_t n = static_cast<uint32_t>(impl->lanes.size());
+        Clock::time_point last = Clock::now();
+        const Clock::time_point first = last;
+        for (;;) {
+            uint64_t range = own.range.load(std::memory_order_acquire);
+            while (range_next(range) < range_end(range)) {
+                const uint32_t i = range_next(range);
+                if (!own.range.compare_exchange_weak(range, pack(i + 1, range_end(range)),
+                                                     std::memory_order_acq_rel)) {
+                    continue;
+                }
+                const SessionFrame& frame = impl->job_frames[i];
+                impl->process_frame(frame, p);
+                const Clock::time_point now = Clock::now();
+                SessionStats& counters = impl->session_counters[frame.session];
+                counters.frames += 1;
+                counters.samples += impl->config.frame_size;
+                counters.processing_ns += elapsed_ns(last, now);
+                last = now;
+                range = own.range.load(std::memory_order_acquire);
+            }
+            if (!impl->steal(p, n)) break;
+            ++own.steals;
+        }
+        own.busy_ns = elapsed_ns(first, last);
+    }
+
+    // Moves the back half of the first non-empty lane's range to lane p
+    bool steal(uint32_t p, uint32_t n) {
+        for (uint32_t k = 1; k < n; ++k) {
+            Lane& victim = lanes[(p + k) % n];
+            uint64_t range = victim.range.load(std::memory_order_acquire);
+            while (range_next(range) < range_end(range)) {
+                const uint32_t next = range_next(range);
+                const uint32_t end = range_end(range);
+                const uint32_t split = end - (end - next + 1) / 2;
+                if (victim.range.compare_exchange_weak(range, pack(next, split), std::memory_order_acq_rel)) {
+                    lanes[p].range.store(pack(split, end), std::memory_order_release);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void process_frame(const SessionFrame& frame, uint32_t p) {
+        const uint32_t s = frame.session;
+        const uint32_t n = config.frame_size;
+        bool adapt = true;
+        if (config.enable_double_talk_detection) adapt = dtds[s].update(frame.far_end, frame.near_end, n);
+        if (fixed) {
+            process_fixed(s, frame.far_end, frame.near_end, frame.output, n, adapt);
+            return;
+        }
+        // Same sample conversion as AEC's float path
+        float* far = &far_block[static_cast<size_t>(p) * n];
+        float* near = &near_block[static_cast<size_t>(p) * n];
+        float* out = &out_block[static_cast<size_t>(p) * n];
+        for (uint32_t i = 0; i < n; ++i) {
+            far[i] = frame.far_end[i] / 32768.0f;
+            near[i] = frame.near_end[i] / 32768.0f;
+        }
+        process_float(s, far, near, out, n, adapt);
+        for (uint32_t i = 0; i < n; ++i) {
+            frame.output[i] = Q15::saturate(static_cast<int32_t>(out[i] * 32767.0f));
+        }
+    }
+
+    void process_float(uint32_t s, const float* far, const float* near, float* out, uint32_t n, bool adapt) {
+        float* w = &w_float[s * w_stride];
+        float* xs = &x_float[s * x_stride];
+        uint32_t index = x_index[s];
+        float power_sum = power_float[s];
+        for (uint32_t j = 0; j < n; ++j) {
+            const float leaving = xs[index];
+            power_sum += far[j] * far[j] - leaving * leaving;
+            xs[index] = far[j];
+            xs[index + length] = far[j];
+            const float* x = &xs[index];
+            const float e = near[j] - kernels.dot_f32(w, x, length);
+            if (index == 0) power_sum = kernels.dot_f32(xs, xs, length);
+            const float power = config.delta + std::max(0.0f, power_sum);
+            if (adapt) kernels.axpy_f32(config.mu / power * e, x, w, length);
+            out[j] = e;
+            if (++index == length) index = 0;
+        }
+        x_index[s] = index;
+        power_float[s] = power_sum;
+    }
+
+    void process_fixed(uint32_t s, const int16_t* far, const int16_t* near, int16_t* out, uint32_t n, bool adapt) {
+        int16_t* w = &w_fixed[s * w_stride];
+        int16_t* xs = &x_fixed[s * x_stride];
+        uint32_t index = x_index[s];
+        int32_t power_sum = power_fixed[s];
+        const int32_t delta_q30 = static_cast<int32_t>(config.delta * 32768.0f * 32768.0f);
+        for (uint32_t j = 0; j < n; ++j) {
+            const int32_t leaving = xs[index];
+            const int32_t entering = far[j];
+            power_sum += ((entering * entering) >> 15) - ((leaving * leaving) >> 15);
+            xs[index] = far[j];
+            xs[index + length] = far[j];
+            const int16_t* x = &xs[index];
+            const Q15 y = Q15::from_raw(static_cast<int16_t>(kernels.dot_q15(x, w, length) >> 15));
+            const Q15 e = Q15::from_raw(near[j]) - y;
+            if (adapt) {
+                const float power = static_cast<float>(delta_q30 + power_sum) / (32768.0f * 32768.0f);
+                kernels.update_q15(w, x, e.raw(), Q15(config.mu / power).raw(), length);
+            }
+            out[j] = e.raw();
+            if (++index == length) index = 0;
+        }
+        x_index[s] = index;
+        power_fixed[s] = power_sum;
+    }
+
+    // Per-thread share of the batch, one cache line each
+    struct alignas(64) Lane {
+        std::atomic<uint64_t> range{0};
+        uint64_t steals = 0;
+        uint64_t busy_ns = 0;
+    };
+
+    AECConfig config;
+    uint32_t capacity;
+    uint32_t length;
+    bool fixed;
+    const simd::Kernels& kernels;
+    // Session s owns row s of each array: w_stride coefficients and a
+    // mirrored delay line of x_stride samples
+    size_t w_stride;
+    size_t x_stride;
+    std::vector<float> w_float;
+    std::vector<float> x_float;
+    std::vector<int16_t> w_fixed; // Q15
+    std::vector<int16_t> x_fixed; // Q15
+    std::vector<float> power_float;
+    std::vector<int32_t> power_fixed;
+    std::vector<uint32_t> x_index;
+    std::vector<uint8_t> active;
+    std::vector<uint64_t> batch_stamp; // last batch naming the session
+    std::vector<SessionStats> session_counters;
+    std::vector<DoubleTalkDetector> dtds;
+    // Float conversion scratch, frame_size samples per lane
+    std::vector<float> far_block;
+    std::vector<float> near_block;
+    std::vector<float> out_block;
+    std::vector<Lane> lanes;
+    std::unique_ptr<WorkerPool> pool;
+    const SessionFrame* job_frames = nullptr;
+    uint64_t batch = 0;
+    SessionPoolStats totals;
+};
+
+AECSessionPool::AECSessionPool(const AECConfig& config, uint32_t max_sessions, uint32_t worker_threads)
+    : pimpl(std::make_unique<Impl>(config, max_sessions, worker_threads)) {}
+AECSessionPool::~AECSessionPool() = default;
+
+int32_t AECSessionPool::open_session() { return pimpl->open_session(); }
+void AECSessionPool::close_session(uint32_t session) { pimpl->close_session(session); }
+void AECSessionPool::reset_session(uint32_t session) { pimpl->reset_session(session); }
+uint32_t AECSessionPool::active_sessions() const { return pimpl->active_sessions(); }
+uint32_t AECSessionPool::max_sessions() const { return pimpl->max_sessions(); }
+
+bool AECSessionPool::process(const SessionFrame* frames, uint32_t count) { return pimpl->process(frames, count); }
+
+SessionStats AECSessionPool::session_stats(uint32_t session) const { return pimpl->session_stats(session); }
+SessionPoolStats AECSessionPool::stats() const { return pimpl->stats(); }
+void AECSessionPool::reset_stats() { pimpl->reset_stats(); }
+
+} // namespace aec
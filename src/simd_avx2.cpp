@@ -0,0 +1,308 @@
+#include "aec/simd_kernels.hpp"
+#include <immintrin.h>
+
+namespace aec {
+namespace simd {
+
+// Local copy of Q15::saturate: this file is built with ISA-specific flags, so
+// it must not instantiate inline functions shared with other translation units
+static inline int16_t sat16(int32_t v) {
+    return static_cast<int16_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+static inline float hsum_ps(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+static inline int32_t hsum_epi32(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+// (a * b) >> 15 truncated to 16 bits, per lane
+static inline __m256i mul_q15(__m256i a, __m256i b) {
+    __m256i lo = _mm256_mullo_epi16(a, b);
+    __m256i hi = _mm256_mulhi_epi16(a, b);
+    return _mm256_or_si256(_mm256_slli_epi16(hi, 1), _mm256_srli_epi16(lo, 15));
+}
+
+static float dot_f32_avx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float acc = hsum_ps(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+static void axpy_f32_avx2(float alpha, const float* x, float* y, size_t n) {
+    const __m256 va = _mm256_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+static float gain_f32_avx2(float* out, const float* w, const float* x, float base, float slope, size_t n) {
+    const __m256 vb = _mm256_set1_ps(base);
+    const __m256 vs = _mm256_set1_ps(slope);
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vw = _mm256_and_ps(_mm256_loadu_ps(w + i), abs_mask);
+        __m256 g = _mm256_mul_ps(_mm256_fmadd_ps(vs, vw, vb), vx);
+        _mm256_storeu_ps(out + i, g);
+        acc = _mm256_fmadd_ps(g, vx, acc);
+    }
+    float sum = hsum_ps(acc);
+    for (; i < n; ++i) {
+        out[i] = (base + slope * (w[i] < 0.0f ? -w[i] : w[i])) * x[i];
+        sum += out[i] * x[i];
+    }
+    return sum;
+}
+
+static float abs_sum_f32_avx2(const float* x, size_t n) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_and_ps(_mm256_loadu_ps(x + i), abs_mask));
+        acc1 = _mm256_add_ps(acc1, _mm256_and_ps(_mm256_loadu_ps(x + i + 8), abs_mask));
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_ps(acc0, _mm256_and_ps(_mm256_loadu_ps(x + i), abs_mask));
+    }
+    float sum = hsum_ps(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += x[i] < 0.0f ? -x[i] : x[i];
+    return sum;
+}
+
+// (a + ib) * (c + id) for four interleaved complex pairs
+static inline __m256 cmul_ps(__m256 w, __m256 x) {
+    __m256 im = _mm256_mul_ps(_mm256_movehdup_ps(w), _mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm256_fmaddsub_ps(_mm256_moveldup_ps(w), x, im);
+}
+
+static void butterfly_c32_avx2(float* data, const float* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        float* lo = data + g * 4 * h;
+        float* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k + 4 <= h; k += 4) {
+            __m256 t = cmul_ps(_mm256_loadu_ps(w + 2 * k), _mm256_loadu_ps(hi + 2 * k));
+            __m256 u = _mm256_loadu_ps(lo + 2 * k);
+            _mm256_storeu_ps(lo + 2 * k, _mm256_add_ps(u, t));
+            _mm256_storeu_ps(hi + 2 * k, _mm256_sub_ps(u, t));
+        }
+        for (; k < h; ++k) {
+            const float wr = w[2 * k], wi = w[2 * k + 1];
+            const float xr = hi[2 * k], xi = hi[2 * k + 1];
+            const float tr = wr * xr - wi * xi, ti = wr * xi + wi * xr;
+            const float ur = lo[2 * k], ui = lo[2 * k + 1];
+            lo[2 * k] = ur + tr;
+            lo[2 * k + 1] = ui + ti;
+            hi[2 * k] = ur - tr;
+            hi[2 * k + 1] = ui - ti;
+        }
+    }
+}
+
+// (a + ib) * (c + id) for one double-precision pair, without fused
+// multiply-adds
+static inline __m128d cmul_pd(__m128d w, __m128d x) {
+    __m128d re = _mm_mul_pd(_mm_movedup_pd(w), x);
+    __m128d im = _mm_mul_pd(_mm_unpackhi_pd(w, w), _mm_shuffle_pd(x, x, 1));
+    return _mm_addsub_pd(re, im);
+}
+
+// (a + ib) * (c + id) for two interleaved double-precision pairs, without
+// fused multiply-adds
+static inline __m256d cmul_pd(__m256d w, __m256d x) {
+    __m256d re = _mm256_mul_pd(_mm256_movedup_pd(w), x);
+    __m256d im = _mm256_mul_pd(_mm256_permute_pd(w, 0xf), _mm256_permute_pd(x, 0x5));
+    return _mm256_addsub_pd(re, im);
+}
+
+static void butterfly_c64_avx2(double* data, const double* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        double* lo = data + g * 4 * h;
+        double* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k + 2 <= h; k += 2) {
+            const __m256d t = cmul_pd(_mm256_loadu_pd(w + 2 * k), _mm256_loadu_pd(hi + 2 * k));
+            const __m256d u = _mm256_loadu_pd(lo + 2 * k);
+            _mm256_storeu_pd(lo + 2 * k, _mm256_add_pd(u, t));
+            _mm256_storeu_pd(hi + 2 * k, _mm256_sub_pd(u, t));
+        }
+        // One pair at a time, still in intrinsics: GCC turns the scalar form
+        // into vfmaddsub here, even with -ffp-contract=off
+        for (; k < h; ++k) {
+            const __m128d t = cmul_pd(_mm_loadu_pd(w + 2 * k), _mm_loadu_pd(hi + 2 * k));
+            const __m128d u = _mm_loadu_pd(lo + 2 * k);
+            _mm_storeu_pd(lo + 2 * k, _mm_add_pd(u, t));
+            _mm_storeu_pd(hi + 2 * k, _mm_sub_pd(u, t));
+        }
+    }
+}
+
+static void butterfly_batch_f64_avx2(double* re, double* im, const double* w, size_t h, size_t groups, size_t count) {
+    for (size_t g = 0; g < groups; ++g) {
+        for (size_t k = 0; k < h; ++k) {
+            const double wr = w[2 * k], wi = w[2 * k + 1];
+            double* lr = re + (g * 2 * h + k) * count;
+            double* li = im + (g * 2 * h + k) * count;
+            double* hr = lr + h * count;
+            double* hi = li + h * count;
+            size_t c = 0;
+            const __m256d vwr = _mm256_set1_pd(wr), vwi = _mm256_set1_pd(wi);
+            for (; c + 4 <= count; c += 4) {
+                const __m256d xr = _mm256_loadu_pd(hr + c), xi = _mm256_loadu_pd(hi + c);
+                const __m256d tr = _mm256_sub_pd(_mm256_mul_pd(vwr, xr), _mm256_mul_pd(vwi, xi));
+                const __m256d ti = _mm256_add_pd(_mm256_mul_pd(vwr, xi), _mm256_mul_pd(vwi, xr));
+                const __m256d ur = _mm256_loadu_pd(lr + c), ui = _mm256_loadu_pd(li + c);
+                _mm256_storeu_pd(lr + c, _mm256_add_pd(ur, tr));
+                _mm256_storeu_pd(li + c, _mm256_add_pd(ui, ti));
+                _mm256_storeu_pd(hr + c, _mm256_sub_pd(ur, tr));
+                _mm256_storeu_pd(hi + c, _mm256_sub_pd(ui, ti));
+            }
+            for (; c < count; ++c) {
+                const double p = wr * hr[c], q = wi * hi[c];
+                const double s = wr * hi[c], t = wi * hr[c];
+                const double tr = p - q, ti = s + t;
+                const double ur = lr[c], ui = li[c];
+                lr[c] = ur + tr;
+                li[c] = ui + ti;
+                hr[c] = ur - tr;
+                hi[c] = ui - ti;
+            }
+        }
+    }
+}
+
+static void cmac_rows_scalar_tail(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                                  const float* x_re, const float* x_im, size_t k, size_t lanes, size_t rows) {
+    for (; k < lanes; ++k) {
+        float yr = y_re[k], yi = y_im[k];
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            yr += w_re[o] * x_re[o] - w_im[o] * x_im[o];
+            yi += w_re[o] * x_im[o] + w_im[o] * x_re[o];
+        }
+        y_re[k] = yr;
+        y_im[k] = yi;
+    }
+}
+
+static void cupdate_rows_scalar_tail(float* w_re, float* w_im, const float* a, const float* b,
+                                     const float* x_re, const float* x_im, size_t k, size_t lanes, size_t rows) {
+    for (; k < lanes; ++k) {
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            w_re[o] += a[k] * x_re[o] + b[k] * x_im[o];
+            w_im[o] += b[k] * x_re[o] - a[k] * x_im[o];
+        }
+    }
+}
+
+// One vector of bands at a time, its sums kept in registers across the rows
+static void cmac_rows_f32_avx2(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                               const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    size_t k = 0;
+    for (; k + 8 <= lanes; k += 8) {
+        __m256 rr = _mm256_loadu_ps(y_re + k), ii = _mm256_setzero_ps();
+        __m256 ri = _mm256_loadu_ps(y_im + k), ir = _mm256_setzero_ps();
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const __m256 wr = _mm256_loadu_ps(w_re + o), wi = _mm256_loadu_ps(w_im + o);
+            const __m256 xr = _mm256_loadu_ps(x_re + o), xi = _mm256_loadu_ps(x_im + o);
+            rr = _mm256_fmadd_ps(wr, xr, rr);
+            ii = _mm256_fmadd_ps(wi, xi, ii);
+            ri = _mm256_fmadd_ps(wr, xi, ri);
+            ir = _mm256_fmadd_ps(wi, xr, ir);
+        }
+        _mm256_storeu_ps(y_re + k, _mm256_sub_ps(rr, ii));
+        _mm256_storeu_ps(y_im + k, _mm256_add_ps(ri, ir));
+    }
+    cmac_rows_scalar_tail(y_re, y_im, w_re, w_im, x_re, x_im, k, lanes, rows);
+}
+
+static void cupdate_rows_f32_avx2(float* w_re, float* w_im, const float* a, const float* b,
+                                  const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    size_t k = 0;
+    for (; k + 8 <= lanes; k += 8) {
+        const __m256 va = _mm256_loadu_ps(a + k), vb = _mm256_loadu_ps(b + k);
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const __m256 xr = _mm256_loadu_ps(x_re + o), xi = _mm256_loadu_ps(x_im + o);
+            const __m256 wr = _mm256_fmadd_ps(vb, xi, _mm256_fmadd_ps(va, xr, _mm256_loadu_ps(w_re + o)));
+            const __m256 wi = _mm256_fnmadd_ps(va, xi, _mm256_fmadd_ps(vb, xr, _mm256_loadu_ps(w_im + o)));
+            _mm256_storeu_ps(w_re + o, wr);
+            _mm256_storeu_ps(w_im + o, wi);
+        }
+    }
+    cupdate_rows_scalar_tail(w_re, w_im, a, b, x_re, x_im, k, lanes, rows);
+}
+
+static int32_t dot_q15_avx2(const int16_t* a, const int16_t* b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+    uint32_t sum = static_cast<uint32_t>(hsum_epi32(acc));
+    for (; i < n; ++i) sum += static_cast<uint32_t>(static_cast<int32_t>(a[i]) * b[i]);
+    return static_cast<int32_t>(sum);
+}
+
+static void update_q15_avx2(int16_t* w, const int16_t* x, int16_t e, int16_t step, size_t n) {
+    const __m256i ve = _mm256_set1_epi16(e);
+    const __m256i vs = _mm256_set1_epi16(step);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i vx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        __m256i vw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        __m256i scaled = mul_q15(mul_q15(vx, ve), vs);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(w + i), _mm256_adds_epi16(vw, scaled));
+    }
+    for (; i < n; ++i) {
+        int16_t update = static_cast<int16_t>((static_cast<int32_t>(x[i]) * e) >> 15);
+        int16_t scaled = static_cast<int16_t>((static_cast<int32_t>(update) * step) >> 15);
+        w[i] = sat16(static_cast<int32_t>(w[i]) + scaled);
+    }
+}
+
+const Kernels& avx2_kernels() {
+    static const Kernels k = {
+        "avx2",
+        dot_f32_avx2,
+        axpy_f32_avx2,
+        gain_f32_avx2,
+        abs_sum_f32_avx2,
+        butterfly_c32_avx2,
+        butterfly_c64_avx2,
+        butterfly_batch_f64_avx2,
+        cmac_rows_f32_avx2,
+        cupdate_rows_f32_avx2,
+        dot_q15_avx2,
+        update_q15_avx2,
+    };
+    return k;
+}
+
+} // namespace simd
+} // namespace aec
@@ -0,0 +1,271 @@
+#include "aec/simd_kernels.hpp"
+#include <immintrin.h>
+
+namespace aec {
+namespace simd {
+
+// Local copy of Q15::saturate: this file is built with ISA-specific flags, so
+// it must not instantiate inline functions shared with other translation units
+static inline int16_t sat16(int32_t v) {
+    return static_cast<int16_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+// (a * b) >> 15 truncated to 16 bits, per lane
+static inline __m512i mul_q15(__m512i a, __m512i b) {
+    __m512i lo = _mm512_mullo_epi16(a, b);
+    __m512i hi = _mm512_mulhi_epi16(a, b);
+    return _mm512_or_si512(_mm512_slli_epi16(hi, 1), _mm512_srli_epi16(lo, 15));
+}
+
+static float dot_f32_avx512(const float* a, const float* b, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    float acc = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+static void axpy_f32_avx512(float alpha, const float* x, float* y, size_t n) {
+    const __m512 va = _mm512_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+static float gain_f32_avx512(float* out, const float* w, const float* x, float base, float slope, size_t n) {
+    const __m512 vb = _mm512_set1_ps(base);
+    const __m512 vs = _mm512_set1_ps(slope);
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 vx = _mm512_loadu_ps(x + i);
+        __m512 vw = _mm512_abs_ps(_mm512_loadu_ps(w + i));
+        __m512 g = _mm512_mul_ps(_mm512_fmadd_ps(vs, vw, vb), vx);
+        _mm512_storeu_ps(out + i, g);
+        acc = _mm512_fmadd_ps(g, vx, acc);
+    }
+    float sum = _mm512_reduce_add_ps(acc);
+    for (; i < n; ++i) {
+        out[i] = (base + slope * (w[i] < 0.0f ? -w[i] : w[i])) * x[i];
+        sum += out[i] * x[i];
+    }
+    return sum;
+}
+
+static float abs_sum_f32_avx512(const float* x, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_add_ps(acc0, _mm512_abs_ps(_mm512_loadu_ps(x + i)));
+        acc1 = _mm512_add_ps(acc1, _mm512_abs_ps(_mm512_loadu_ps(x + i + 16)));
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_ps(acc0, _mm512_abs_ps(_mm512_loadu_ps(x + i)));
+    }
+    float sum = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += x[i] < 0.0f ? -x[i] : x[i];
+    return sum;
+}
+
+// (a + ib) * (c + id) for eight interleaved complex pairs
+static inline __m512 cmul_ps(__m512 w, __m512 x) {
+    __m512 im = _mm512_mul_ps(_mm512_movehdup_ps(w), _mm512_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm512_fmaddsub_ps(_mm512_moveldup_ps(w), x, im);
+}
+
+static void butterfly_c32_avx512(float* data, const float* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        float* lo = data + g * 4 * h;
+        float* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k + 8 <= h; k += 8) {
+            __m512 t = cmul_ps(_mm512_loadu_ps(w + 2 * k), _mm512_loadu_ps(hi + 2 * k));
+            __m512 u = _mm512_loadu_ps(lo + 2 * k);
+            _mm512_storeu_ps(lo + 2 * k, _mm512_add_ps(u, t));
+            _mm512_storeu_ps(hi + 2 * k, _mm512_sub_ps(u, t));
+        }
+        for (; k < h; ++k) {
+            const float wr = w[2 * k], wi = w[2 * k + 1];
+            const float xr = hi[2 * k], xi = hi[2 * k + 1];
+            const float tr = wr * xr - wi * xi, ti = wr * xi + wi * xr;
+            const float ur = lo[2 * k], ui = lo[2 * k + 1];
+            lo[2 * k] = ur + tr;
+            lo[2 * k + 1] = ui + ti;
+            hi[2 * k] = ur - tr;
+            hi[2 * k + 1] = ui - ti;
+        }
+    }
+}
+
+// (a + ib) * (c + id) for one double-precision pair, without fused
+// multiply-adds
+static inline __m128d cmul_pd(__m128d w, __m128d x) {
+    __m128d re = _mm_mul_pd(_mm_movedup_pd(w), x);
+    __m128d im = _mm_mul_pd(_mm_unpackhi_pd(w, w), _mm_shuffle_pd(x, x, 1));
+    return _mm_addsub_pd(re, im);
+}
+
+// (a + ib) * (c + id) for four interleaved double-precision pairs, without
+// fused multiply-adds: subtract in the real lanes, add in the imaginary ones
+static inline __m512d cmul_pd(__m512d w, __m512d x) {
+    __m512d re = _mm512_mul_pd(_mm512_movedup_pd(w), x);
+    __m512d im = _mm512_mul_pd(_mm512_permute_pd(w, 0xff), _mm512_permute_pd(x, 0x55));
+    return _mm512_mask_sub_pd(_mm512_add_pd(re, im), 0x55, re, im);
+}
+
+static void butterfly_c64_avx512(double* data, const double* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        double* lo = data + g * 4 * h;
+        double* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k + 4 <= h; k += 4) {
+            const __m512d t = cmul_pd(_mm512_loadu_pd(w + 2 * k), _mm512_loadu_pd(hi + 2 * k));
+            const __m512d u = _mm512_loadu_pd(lo + 2 * k);
+            _mm512_storeu_pd(lo + 2 * k, _mm512_add_pd(u, t));
+            _mm512_storeu_pd(hi + 2 * k, _mm512_sub_pd(u, t));
+        }
+        // One pair at a time, still in intrinsics: GCC turns the scalar form
+        // into vfmaddsub here, even with -ffp-contract=off
+        for (; k < h; ++k) {
+            const __m128d t = cmul_pd(_mm_loadu_pd(w + 2 * k), _mm_loadu_pd(hi + 2 * k));
+            const __m128d u = _mm_loadu_pd(lo + 2 * k);
+            _mm_storeu_pd(lo + 2 * k, _mm_add_pd(u, t));
+            _mm_storeu_pd(hi + 2 * k, _mm_sub_pd(u, t));
+        }
+    }
+}
+
+static void butterfly_batch_f64_avx512(double* re, double* im, const double* w, size_t h, size_t groups, size_t count) {
+    for (size_t g = 0; g < groups; ++g) {
+        for (size_t k = 0; k < h; ++k) {
+            double* lr = re + (g * 2 * h + k) * count;
+            double* li = im + (g * 2 * h + k) * count;
+            double* hr = lr + h * count;
+            double* hi = li + h * count;
+            const __m512d vwr = _mm512_set1_pd(w[2 * k]), vwi = _mm512_set1_pd(w[2 * k + 1]);
+            size_t c = 0;
+            for (; c + 8 <= count; c += 8) {
+                const __m512d xr = _mm512_loadu_pd(hr + c), xi = _mm512_loadu_pd(hi + c);
+                const __m512d tr = _mm512_sub_pd(_mm512_mul_pd(vwr, xr), _mm512_mul_pd(vwi, xi));
+                const __m512d ti = _mm512_add_pd(_mm512_mul_pd(vwr, xi), _mm512_mul_pd(vwi, xr));
+                const __m512d ur = _mm512_loadu_pd(lr + c), ui = _mm512_loadu_pd(li + c);
+                _mm512_storeu_pd(lr + c, _mm512_add_pd(ur, tr));
+                _mm512_storeu_pd(li + c, _mm512_add_pd(ui, ti));
+                _mm512_storeu_pd(hr + c, _mm512_sub_pd(ur, tr));
+                _mm512_storeu_pd(hi + c, _mm512_sub_pd(ui, ti));
+            }
+            for (; c < count; ++c) {
+                const double p = w[2 * k] * hr[c], q = w[2 * k + 1] * hi[c];
+                const double s = w[2 * k] * hi[c], t = w[2 * k + 1] * hr[c];
+                const double tr = p - q, ti = s + t;
+                const double ur = lr[c], ui = li[c];
+                lr[c] = ur + tr;
+                li[c] = ui + ti;
+                hr[c] = ur - tr;
+                hi[c] = ui - ti;
+            }
+        }
+    }
+}
+
+static inline __mmask16 lane_mask(size_t left) {
+    return left >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << left) - 1);
+}
+
+// One vector of bands at a time, its sums kept in registers across the
+// rows; the last partial vector is masked
+static void cmac_rows_f32_avx512(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                                 const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    for (size_t k = 0; k < lanes; k += 16) {
+        const __mmask16 m = lane_mask(lanes - k);
+        __m512 rr = _mm512_maskz_loadu_ps(m, y_re + k), ii = _mm512_setzero_ps();
+        __m512 ri = _mm512_maskz_loadu_ps(m, y_im + k), ir = _mm512_setzero_ps();
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const __m512 wr = _mm512_maskz_loadu_ps(m, w_re + o), wi = _mm512_maskz_loadu_ps(m, w_im + o);
+            const __m512 xr = _mm512_maskz_loadu_ps(m, x_re + o), xi = _mm512_maskz_loadu_ps(m, x_im + o);
+            rr = _mm512_fmadd_ps(wr, xr, rr);
+            ii = _mm512_fmadd_ps(wi, xi, ii);
+            ri = _mm512_fmadd_ps(wr, xi, ri);
+            ir = _mm512_fmadd_ps(wi, xr, ir);
+        }
+        _mm512_mask_storeu_ps(y_re + k, m, _mm512_sub_ps(rr, ii));
+        _mm512_mask_storeu_ps(y_im + k, m, _mm512_add_ps(ri, ir));
+    }
+}
+
+static void cupdate_rows_f32_avx512(float* w_re, float* w_im, const float* a, const float* b,
+                                    const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    for (size_t k = 0; k < lanes; k += 16) {
+        const __mmask16 m = lane_mask(lanes - k);
+        const __m512 va = _mm512_maskz_loadu_ps(m, a + k), vb = _mm512_maskz_loadu_ps(m, b + k);
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const __m512 xr = _mm512_maskz_loadu_ps(m, x_re + o), xi = _mm512_maskz_loadu_ps(m, x_im + o);
+            const __m512 wr = _mm512_fmadd_ps(vb, xi, _mm512_fmadd_ps(va, xr, _mm512_maskz_loadu_ps(m, w_re + o)));
+            const __m512 wi = _mm512_fnmadd_ps(va, xi, _mm512_fmadd_ps(vb, xr, _mm512_maskz_loadu_ps(m, w_im + o)));
+            _mm512_mask_storeu_ps(w_re + o, m, wr);
+            _mm512_mask_storeu_ps(w_im + o, m, wi);
+        }
+    }
+}
+
+static int32_t dot_q15_avx512(const int16_t* a, const int16_t* b, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+    }
+    uint32_t sum = static_cast<uint32_t>(_mm512_reduce_add_epi32(acc));
+    for (; i < n; ++i) sum += static_cast<uint32_t>(static_cast<int32_t>(a[i]) * b[i]);
+    return static_cast<int32_t>(sum);
+}
+
+static void update_q15_avx512(int16_t* w, const int16_t* x, int16_t e, int16_t step, size_t n) {
+    const __m512i ve = _mm512_set1_epi16(e);
+    const __m512i vs = _mm512_set1_epi16(step);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512i vx = _mm512_loadu_si512(x + i);
+        __m512i vw = _mm512_loadu_si512(w + i);
+        __m512i scaled = mul_q15(mul_q15(vx, ve), vs);
+        _mm512_storeu_si512(w + i, _mm512_adds_epi16(vw, scaled));
+    }
+    for (; i < n; ++i) {
+        int16_t update = static_cast<int16_t>((static_cast<int32_t>(x[i]) * e) >> 15);
+        int16_t scaled = static_cast<int16_t>((static_cast<int32_t>(update) * step) >> 15);
+        w[i] = sat16(static_cast<int32_t>(w[i]) + scaled);
+    }
+}
+
+const Kernels& avx512_kernels() {
+    static const Kernels k = {
+        "avx512",
+        dot_f32_avx512,
+        axpy_f32_avx512,
+        gain_f32_avx512,
+        abs_sum_f32_avx512,
+        butterfly_c32_avx512,
+        butterfly_c64_avx512,
+        butterfly_batch_f64_avx512,
+        cmac_rows_f32_avx512,
+        cupdate_rows_f32_avx512,
+        dot_q15_avx512,
+        update_q15_avx512,
+    };
+    return k;
+}
+
+} // namespace simd
+} // namespace aec
@@ -0,0 +1,111 @@
+#include "aec/simd_kernels.hpp"
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace aec {
+namespace simd {
+
+#if defined(AEC_HAVE_SSE41)
+const Kernels& sse41_kernels();
+#endif
+#if defined(AEC_HAVE_AVX2)
+const Kernels& avx2_kernels();
+#endif
+#if defined(AEC_HAVE_AVX512)
+const Kernels& avx512_kernels();
+#endif
+#if defined(AEC_HAVE_NEON)
+const Kernels& neon_kernels();
+#endif
+
+namespace {
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2 = false;  // AVX2 + FMA with OS support for YMM state
+    bool avx512 = false; // AVX-512F + BW with OS support for ZMM state
+};
+
+CpuFeatures detect_cpu() {
+    CpuFeatures f;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    f.sse41 = __builtin_cpu_supports("sse4.1");
+    f.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    f.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4];
+    __cpuid(regs, 0);
+    const int max_leaf = regs[0];
+    __cpuid(regs, 1);
+    f.sse41 = (regs[2] & (1 << 19)) != 0;
+    const bool fma = (regs[2] & (1 << 12)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymm_state = (xcr0 & 0x6) == 0x6;
+    const bool zmm_state = (xcr0 & 0xe6) == 0xe6;
+    if (max_leaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        f.avx2 = ymm_state && fma && (regs[1] & (1 << 5)) != 0;
+        f.avx512 = zmm_state && (regs[1] & (1 << 16)) != 0 && (regs[1] & (1 << 30)) != 0;
+    }
+#endif
+    return f;
+}
+
+const Kernels& select_kernels() {
+#if defined(AEC_HAVE_NEON)
+    return neon_kernels();
+#else
+    const CpuFeatures f = detect_cpu();
+    (void)f;
+#if defined(AEC_HAVE_AVX512)
+    if (f.avx512) return avx512_kernels();
+#endif
+#if defined(AEC_HAVE_AVX2)
+    if (f.avx2) return avx2_kernels();
+#endif
+#if defined(AEC_HAVE_SSE41)
+    if (f.sse41) return sse41_kernels();
+#endif
+    return scalar_kernels();
+#endif
+}
+
+} // namespace
+
+const Kernels& kernels() {
+    static const Kernels& selected = select_kernels();
+    return selected;
+}
+
+const char* active_kernel_name() {
+    return kernels().name;
+}
+
+const Kernels* find_kernels(const char* name) {
+    if (!name) return nullptr;
+    if (std::strcmp(name, "scalar") == 0) return &scalar_kernels();
+#if defined(AEC_HAVE_NEON)
+    if (std::strcmp(name, "neon") == 0) return &neon_kernels();
+#else
+    const CpuFeatures f = detect_cpu();
+    (void)f;
+#if defined(AEC_HAVE_SSE41)
+    if (std::strcmp(name, "sse4.1") == 0) return f.sse41 ? &sse41_kernels() : nullptr;
+#endif
+#if defined(AEC_HAVE_AVX2)
+    if (std::strcmp(name, "avx2") == 0) return f.avx2 ? &avx2_kernels() : nullptr;
+#endif
+#if defined(AEC_HAVE_AVX512)
+    if (std::strcmp(name, "avx512") == 0) return f.avx512 ? &avx512_kernels() : nullptr;
+#endif
+#endif
+    return nullptr;
+}
+
+} // namespace simd
+} // namespace aec
@@ -0,0 +1,275 @@
+#include "aec/simd_kernels.hpp"
+#include "aec/fixed_point.hpp"
+#include <cmath>
+#include <arm_neon.h>
+
+namespace aec {
+namespace simd {
+
+static inline float hsum_f32(float32x4_t v) {
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+static inline int32_t hsum_s32(int32x4_t v) {
+    int32x2_t s = vadd_s32(vget_low_s32(v), vget_high_s32(v));
+    return vget_lane_s32(vpadd_s32(s, s), 0);
+}
+
+// (a * b) >> 15 truncated to 16 bits, per lane
+static inline int16x8_t mul_q15(int16x8_t a, int16x8_t b) {
+    int32x4_t lo = vmull_s16(vget_low_s16(a), vget_low_s16(b));
+    int32x4_t hi = vmull_s16(vget_high_s16(a), vget_high_s16(b));
+    return vcombine_s16(vshrn_n_s32(lo, 15), vshrn_n_s32(hi, 15));
+}
+
+static float dot_f32_neon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float acc = hsum_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+static void axpy_f32_neon(float alpha, const float* x, float* y, size_t n) {
+    const float32x4_t va = vdupq_n_f32(alpha);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), va, vld1q_f32(x + i)));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+static float gain_f32_neon(float* out, const float* w, const float* x, float base, float slope, size_t n) {
+    const float32x4_t vb = vdupq_n_f32(base);
+    const float32x4_t vs = vdupq_n_f32(slope);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t vx = vld1q_f32(x + i);
+        float32x4_t g = vmulq_f32(vmlaq_f32(vb, vs, vabsq_f32(vld1q_f32(w + i))), vx);
+        vst1q_f32(out + i, g);
+        acc = vmlaq_f32(acc, g, vx);
+    }
+    float sum = hsum_f32(acc);
+    for (; i < n; ++i) {
+        out[i] = (base + slope * std::fabs(w[i])) * x[i];
+        sum += out[i] * x[i];
+    }
+    return sum;
+}
+
+static float abs_sum_f32_neon(const float* x, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vaddq_f32(acc0, vabsq_f32(vld1q_f32(x + i)));
+        acc1 = vaddq_f32(acc1, vabsq_f32(vld1q_f32(x + i + 4)));
+    }
+    float sum = hsum_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) sum += std::fabs(x[i]);
+    return sum;
+}
+
+static void butterfly_c32_neon(float* data, const float* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        float* lo = data + g * 4 * h;
+        float* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k + 4 <= h; k += 4) {
+            // De-interleaved loads: val[0] real parts, val[1] imaginary parts
+            float32x4x2_t vw = vld2q_f32(w + 2 * k);
+            float32x4x2_t vx = vld2q_f32(hi + 2 * k);
+            float32x4x2_t vu = vld2q_f32(lo + 2 * k);
+            float32x4_t tr = vmlsq_f32(vmulq_f32(vw.val[0], vx.val[0]), vw.val[1], vx.val[1]);
+            float32x4_t ti = vmlaq_f32(vmulq_f32(vw.val[0], vx.val[1]), vw.val[1], vx.val[0]);
+            float32x4x2_t out_lo, out_hi;
+            out_lo.val[0] = vaddq_f32(vu.val[0], tr);
+            out_lo.val[1] = vaddq_f32(vu.val[1], ti);
+            out_hi.val[0] = vsubq_f32(vu.val[0], tr);
+            out_hi.val[1] = vsubq_f32(vu.val[1], ti);
+            vst2q_f32(lo + 2 * k, out_lo);
+            vst2q_f32(hi + 2 * k, out_hi);
+        }
+        for (; k < h; ++k) {
+            const float wr = w[2 * k], wi = w[2 * k + 1];
+            const float xr = hi[2 * k], xi = hi[2 * k + 1];
+            const float tr = wr * xr - wi * xi, ti = wr * xi + wi * xr;
+            const float ur = lo[2 * k], ui = lo[2 * k + 1];
+            lo[2 * k] = ur + tr;
+            lo[2 * k + 1] = ui + ti;
+            hi[2 * k] = ur - tr;
+            hi[2 * k + 1] = ui - ti;
+        }
+    }
+}
+
+// (a + ib) * (c + id) for one double-precision pair, without fused
+// multiply-adds; the sign vector turns the add into a subtract in the real lane
+static inline float64x2_t cmul_pd(float64x2_t w, float64x2_t x) {
+    static const double sign[2] = {-1.0, 1.0};
+    float64x2_t re = vmulq_f64(vdupq_laneq_f64(w, 0), x);
+    float64x2_t im = vmulq_f64(vdupq_laneq_f64(w, 1), vextq_f64(x, x, 1));
+    return vaddq_f64(re, vmulq_f64(im, vld1q_f64(sign)));
+}
+
+static void butterfly_c64_neon(double* data, const double* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        double* lo = data + g * 4 * h;
+        double* hi = lo + 2 * h;
+        for (size_t k = 0; k < h; ++k) {
+            const float64x2_t t = cmul_pd(vld1q_f64(w + 2 * k), vld1q_f64(hi + 2 * k));
+            const float64x2_t u = vld1q_f64(lo + 2 * k);
+            vst1q_f64(lo + 2 * k, vaddq_f64(u, t));
+            vst1q_f64(hi + 2 * k, vsubq_f64(u, t));
+        }
+    }
+}
+
+static void butterfly_batch_f64_neon(double* re, double* im, const double* w, size_t h, size_t groups, size_t count) {
+    for (size_t g = 0; g < groups; ++g) {
+        for (size_t k = 0; k < h; ++k) {
+            const double wr = w[2 * k], wi = w[2 * k + 1];
+            double* lr = re + (g * 2 * h + k) * count;
+            double* li = im + (g * 2 * h + k) * count;
+            double* hr = lr + h * count;
+            double* hi = li + h * count;
+            size_t c = 0;
+            const float64x2_t vwr = vdupq_n_f64(wr), vwi = vdupq_n_f64(wi);
+            for (; c + 2 <= count; c += 2) {
+                const float64x2_t xr = vld1q_f64(hr + c), xi = vld1q_f64(hi + c);
+                const float64x2_t tr = vsubq_f64(vmulq_f64(vwr, xr), vmulq_f64(vwi, xi));
+                const float64x2_t ti = vaddq_f64(vmulq_f64(vwr, xi), vmulq_f64(vwi, xr));
+                const float64x2_t ur = vld1q_f64(lr + c), ui = vld1q_f64(li + c);
+                vst1q_f64(lr + c, vaddq_f64(ur, tr));
+                vst1q_f64(li + c, vaddq_f64(ui, ti));
+                vst1q_f64(hr + c, vsubq_f64(ur, tr));
+                vst1q_f64(hi + c, vsubq_f64(ui, ti));
+            }
+            for (; c < count; ++c) {
+                const double p = wr * hr[c], q = wi * hi[c];
+                const double s = wr * hi[c], t = wi * hr[c];
+                const double tr = p - q, ti = s + t;
+                const double ur = lr[c], ui = li[c];
+                lr[c] = ur + tr;
+                li[c] = ui + ti;
+                hr[c] = ur - tr;
+                hi[c] = ui - ti;
+            }
+        }
+    }
+}
+
+static void cmac_rows_scalar_tail(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                                  const float* x_re, const float* x_im, size_t k, size_t lanes, size_t rows) {
+    for (; k < lanes; ++k) {
+        float yr = y_re[k], yi = y_im[k];
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            yr += w_re[o] * x_re[o] - w_im[o] * x_im[o];
+            yi += w_re[o] * x_im[o] + w_im[o] * x_re[o];
+        }
+        y_re[k] = yr;
+        y_im[k] = yi;
+    }
+}
+
+static void cupdate_rows_scalar_tail(float* w_re, float* w_im, const float* a, const float* b,
+                                     const float* x_re, const float* x_im, size_t k, size_t lanes, size_t rows) {
+    for (; k < lanes; ++k) {
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            w_re[o] += a[k] * x_re[o] + b[k] * x_im[o];
+            w_im[o] += b[k] * x_re[o] - a[k] * x_im[o];
+        }
+    }
+}
+
+// One vector of bands at a time, its sums kept in registers across the rows
+static void cmac_rows_f32_neon(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                               const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    size_t k = 0;
+    for (; k + 4 <= lanes; k += 4) {
+        float32x4_t rr = vld1q_f32(y_re + k), ii = vdupq_n_f32(0.0f);
+        float32x4_t ri = vld1q_f32(y_im + k), ir = vdupq_n_f32(0.0f);
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const float32x4_t wr = vld1q_f32(w_re + o), wi = vld1q_f32(w_im + o);
+            const float32x4_t xr = vld1q_f32(x_re + o), xi = vld1q_f32(x_im + o);
+            rr = vmlaq_f32(rr, wr, xr);
+            ii = vmlaq_f32(ii, wi, xi);
+            ri = vmlaq_f32(ri, wr, xi);
+            ir = vmlaq_f32(ir, wi, xr);
+        }
+        vst1q_f32(y_re + k, vsubq_f32(rr, ii));
+        vst1q_f32(y_im + k, vaddq_f32(ri, ir));
+    }
+    cmac_rows_scalar_tail(y_re, y_im, w_re, w_im, x_re, x_im, k, lanes, rows);
+}
+
+static void cupdate_rows_f32_neon(float* w_re, float* w_im, const float* a, const float* b,
+                                  const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    size_t k = 0;
+    for (; k + 4 <= lanes; k += 4) {
+        const float32x4_t va = vld1q_f32(a + k), vb = vld1q_f32(b + k);
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const float32x4_t xr = vld1q_f32(x_re + o), xi = vld1q_f32(x_im + o);
+            vst1q_f32(w_re + o, vmlaq_f32(vmlaq_f32(vld1q_f32(w_re + o), va, xr), vb, xi));
+            vst1q_f32(w_im + o, vmlsq_f32(vmlaq_f32(vld1q_f32(w_im + o), vb, xr), va, xi));
+        }
+    }
+    cupdate_rows_scalar_tail(w_re, w_im, a, b, x_re, x_im, k, lanes, rows);
+}
+
+static int32_t dot_q15_neon(const int16_t* a, const int16_t* b, size_t n) {
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t va = vld1q_s16(a + i);
+        int16x8_t vb = vld1q_s16(b + i);
+        acc = vmlal_s16(acc, vget_low_s16(va), vget_low_s16(vb));
+        acc = vmlal_s16(acc, vget_high_s16(va), vget_high_s16(vb));
+    }
+    uint32_t sum = static_cast<uint32_t>(hsum_s32(acc));
+    for (; i < n; ++i) sum += static_cast<uint32_t>(static_cast<int32_t>(a[i]) * b[i]);
+    return static_cast<int32_t>(sum);
+}
+
+static void update_q15_neon(int16_t* w, const int16_t* x, int16_t e, int16_t step, size_t n) {
+    const int16x8_t ve = vdupq_n_s16(e);
+    const int16x8_t vs = vdupq_n_s16(step);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t scaled = mul_q15(mul_q15(vld1q_s16(x + i), ve), vs);
+        vst1q_s16(w + i, vqaddq_s16(vld1q_s16(w + i), scaled));
+    }
+    for (; i < n; ++i) {
+        int16_t update = static_cast<int16_t>((static_cast<int32_t>(x[i]) * e) >> 15);
+        int16_t scaled = static_cast<int16_t>((static_cast<int32_t>(update) * step) >> 15);
+        w[i] = Q15::saturate(static_cast<int32_t>(w[i]) + scaled);
+    }
+}
+
+const Kernels& neon_kernels() {
+    static const Kernels k = {
+        "neon",
+        dot_f32_neon,
+        axpy_f32_neon,
+        gain_f32_neon,
+        abs_sum_f32_neon,
+        butterfly_c32_neon,
+        butterfly_c64_neon,
+        butterfly_batch_f64_neon,
+        cmac_rows_f32_neon,
+        cupdate_rows_f32_neon,
+        dot_q15_neon,
+        update_q15_neon,
+    };
+    return k;
+}
+
+} // namespace simd
+} // namespace aec
@@ -0,0 +1,152 @@
+#include "aec/simd_kernels.hpp"
+#include "aec/fixed_point.hpp"
+#include <cmath>
+
+namespace aec {
+namespace simd {
+
+static float dot_f32_scalar(const float* a, const float* b, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+static void axpy_f32_scalar(float alpha, const float* x, float* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) y[i] += alpha * x[i];
+}
+
+static float gain_f32_scalar(float* out, const float* w, const float* x, float base, float slope, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = (base + slope * std::fabs(w[i])) * x[i];
+        acc += out[i] * x[i];
+    }
+    return acc;
+}
+
+static float abs_sum_f32_scalar(const float* x, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; ++i) acc += std::fabs(x[i]);
+    return acc;
+}
+
+static void butterfly_c32_scalar(float* data, const float* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        float* lo = data + g * 4 * h;
+        float* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k < h; ++k) {
+            const float wr = w[2 * k], wi = w[2 * k + 1];
+            const float xr = hi[2 * k], xi = hi[2 * k + 1];
+            const float tr = wr * xr - wi * xi, ti = wr * xi + wi * xr;
+            const float ur = lo[2 * k], ui = lo[2 * k + 1];
+            lo[2 * k] = ur + tr;
+            lo[2 * k + 1] = ui + ti;
+            hi[2 * k] = ur - tr;
+            hi[2 * k + 1] = ui - ti;
+        }
+    }
+}
+
+static void butterfly_c64_scalar(double* data, const double* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        double* lo = data + g * 4 * h;
+        double* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k < h; ++k) {
+            const double wr = w[2 * k], wi = w[2 * k + 1];
+            const double xr = hi[2 * k], xi = hi[2 * k + 1];
+            const double p = wr * xr, q = wi * xi;
+            const double s = wr * xi, t = wi * xr;
+            const double tr = p - q, ti = s + t;
+            const double ur = lo[2 * k], ui = lo[2 * k + 1];
+            lo[2 * k] = ur + tr;
+            lo[2 * k + 1] = ui + ti;
+            hi[2 * k] = ur - tr;
+            hi[2 * k + 1] = ui - ti;
+        }
+    }
+}
+
+static void butterfly_batch_f64_scalar(double* re, double* im, const double* w, size_t h, size_t groups, size_t count) {
+    for (size_t g = 0; g < groups; ++g) {
+        for (size_t k = 0; k < h; ++k) {
+            const double wr = w[2 * k], wi = w[2 * k + 1];
+            double* lr = re + (g * 2 * h + k) * count;
+            double* li = im + (g * 2 * h + k) * count;
+            double* hr = lr + h * count;
+            double* hi = li + h * count;
+            for (size_t c = 0; c < count; ++c) {
+                const double p = wr * hr[c], q = wi * hi[c];
+                const double s = wr * hi[c], t = wi * hr[c];
+                const double tr = p - q, ti = s + t;
+                const double ur = lr[c], ui = li[c];
+                lr[c] = ur + tr;
+                li[c] = ui + ti;
+                hr[c] = ur - tr;
+                hi[c] = ui - ti;
+            }
+        }
+    }
+}
+
+static void cmac_rows_f32_scalar(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                                 const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    for (size_t r = 0; r < rows; ++r) {
+        const size_t o = r * lanes;
+        for (size_t k = 0; k < lanes; ++k) {
+            y_re[k] += w_re[o + k] * x_re[o + k] - w_im[o + k] * x_im[o + k];
+            y_im[k] += w_re[o + k] * x_im[o + k] + w_im[o + k] * x_re[o + k];
+        }
+    }
+}
+
+static void cupdate_rows_f32_scalar(float* w_re, float* w_im, const float* a, const float* b,
+                                    const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    for (size_t r = 0; r < rows; ++r) {
+        const size_t o = r * lanes;
+        for (size_t k = 0; k < lanes; ++k) {
+            w_re[o + k] += a[k] * x_re[o + k] + b[k] * x_im[o + k];
+            w_im[o + k] += b[k] * x_re[o + k] - a[k] * x_im[o + k];
+        }
+    }
+}
+
+static int32_t dot_q15_scalar(const int16_t* a, const int16_t* b, size_t n) {
+    // Unsigned accumulation gives the wrap-around behaviour of the SIMD
+    // kernels without signed-overflow UB
+    uint32_t acc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        acc += static_cast<uint32_t>(static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]));
+    }
+    return static_cast<int32_t>(acc);
+}
+
+static void update_q15_scalar(int16_t* w, const int16_t* x, int16_t e, int16_t step, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        int16_t update = static_cast<int16_t>((static_cast<int32_t>(x[i]) * e) >> 15);
+        int16_t scaled = static_cast<int16_t>((static_cast<int32_t>(update) * step) >> 15);
+        w[i] = Q15::saturate(static_cast<int32_t>(w[i]) + scaled);
+    }
+}
+
+const Kernels& scalar_kernels() {
+    static const Kernels k = {
+        "scalar",
+        dot_f32_scalar,
+        axpy_f32_scalar,
+        gain_f32_scalar,
+        abs_sum_f32_scalar,
+        butterfly_c32_scalar,
+        butterfly_c64_scalar,
+        butterfly_batch_f64_scalar,
+        cmac_rows_f32_scalar,
+        cupdate_rows_f32_scalar,
+        dot_q15_scalar,
+        update_q15_scalar,
+    };
+    return k;
+}
+
+} // namespace simd
+} // namespace aec
@@ -0,0 +1,286 @@
+#include "aec/simd_kernels.hpp"
+#include <smmintrin.h>
+
+namespace aec {
+namespace simd {
+
+// Local copy of Q15::saturate: this file is built with ISA-specific flags, so
+// it must not instantiate inline functions shared with other translation units
+static inline int16_t sat16(int32_t v) {
+    return static_cast<int16_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+static inline float hsum_ps(__m128 v) {
+    __m128 shuf = _mm_movehdup_ps(v);
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+static inline int32_t hsum_epi32(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+// (a * b) >> 15 truncated to 16 bits, per lane
+static inline __m128i mul_q15(__m128i a, __m128i b) {
+    __m128i lo = _mm_mullo_epi16(a, b);
+    __m128i hi = _mm_mulhi_epi16(a, b);
+    return _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+}
+
+static float dot_f32_sse41(const float* a, const float* b, size_t n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float acc = hsum_ps(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+static void axpy_f32_sse41(float alpha, const float* x, float* y, size_t n) {
+    const __m128 va = _mm_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+static float gain_f32_sse41(float* out, const float* w, const float* x, float base, float slope, size_t n) {
+    const __m128 vb = _mm_set1_ps(base);
+    const __m128 vs = _mm_set1_ps(slope);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 acc = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vw = _mm_and_ps(_mm_loadu_ps(w + i), abs_mask);
+        __m128 g = _mm_mul_ps(_mm_add_ps(vb, _mm_mul_ps(vs, vw)), vx);
+        _mm_storeu_ps(out + i, g);
+        acc = _mm_add_ps(acc, _mm_mul_ps(g, vx));
+    }
+    float sum = hsum_ps(acc);
+    for (; i < n; ++i) {
+        out[i] = (base + slope * (w[i] < 0.0f ? -w[i] : w[i])) * x[i];
+        sum += out[i] * x[i];
+    }
+    return sum;
+}
+
+static float abs_sum_f32_sse41(const float* x, size_t n) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_and_ps(_mm_loadu_ps(x + i), abs_mask));
+        acc1 = _mm_add_ps(acc1, _mm_and_ps(_mm_loadu_ps(x + i + 4), abs_mask));
+    }
+    float sum = hsum_ps(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += x[i] < 0.0f ? -x[i] : x[i];
+    return sum;
+}
+
+// (a + ib) * (c + id) for two interleaved complex pairs
+static inline __m128 cmul_ps(__m128 w, __m128 x) {
+    __m128 re = _mm_mul_ps(_mm_moveldup_ps(w), x);
+    __m128 im = _mm_mul_ps(_mm_movehdup_ps(w), _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_addsub_ps(re, im);
+}
+
+static void butterfly_c32_sse41(float* data, const float* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        float* lo = data + g * 4 * h;
+        float* hi = lo + 2 * h;
+        size_t k = 0;
+        for (; k + 2 <= h; k += 2) {
+            __m128 t = cmul_ps(_mm_loadu_ps(w + 2 * k), _mm_loadu_ps(hi + 2 * k));
+            __m128 u = _mm_loadu_ps(lo + 2 * k);
+            _mm_storeu_ps(lo + 2 * k, _mm_add_ps(u, t));
+            _mm_storeu_ps(hi + 2 * k, _mm_sub_ps(u, t));
+        }
+        for (; k < h; ++k) {
+            const float wr = w[2 * k], wi = w[2 * k + 1];
+            const float xr = hi[2 * k], xi = hi[2 * k + 1];
+            const float tr = wr * xr - wi * xi, ti = wr * xi + wi * xr;
+            const float ur = lo[2 * k], ui = lo[2 * k + 1];
+            lo[2 * k] = ur + tr;
+            lo[2 * k + 1] = ui + ti;
+            hi[2 * k] = ur - tr;
+            hi[2 * k + 1] = ui - ti;
+        }
+    }
+}
+
+// (a + ib) * (c + id) for one double-precision pair, without fused
+// multiply-adds
+static inline __m128d cmul_pd(__m128d w, __m128d x) {
+    __m128d re = _mm_mul_pd(_mm_movedup_pd(w), x);
+    __m128d im = _mm_mul_pd(_mm_unpackhi_pd(w, w), _mm_shuffle_pd(x, x, 1));
+    return _mm_addsub_pd(re, im);
+}
+
+static void butterfly_c64_sse41(double* data, const double* w, size_t h, size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        double* lo = data + g * 4 * h;
+        double* hi = lo + 2 * h;
+        for (size_t k = 0; k < h; ++k) {
+            const __m128d t = cmul_pd(_mm_loadu_pd(w + 2 * k), _mm_loadu_pd(hi + 2 * k));
+            const __m128d u = _mm_loadu_pd(lo + 2 * k);
+            _mm_storeu_pd(lo + 2 * k, _mm_add_pd(u, t));
+            _mm_storeu_pd(hi + 2 * k, _mm_sub_pd(u, t));
+        }
+    }
+}
+
+static void butterfly_batch_f64_sse41(double* re, double* im, const double* w, size_t h, size_t groups, size_t count) {
+    for (size_t g = 0; g < groups; ++g) {
+        for (size_t k = 0; k < h; ++k) {
+            const double wr = w[2 * k], wi = w[2 * k + 1];
+            double* lr = re + (g * 2 * h + k) * count;
+            double* li = im + (g * 2 * h + k) * count;
+            double* hr = lr + h * count;
+            double* hi = li + h * count;
+            size_t c = 0;
+            const __m128d vwr = _mm_set1_pd(wr), vwi = _mm_set1_pd(wi);
+            for (; c + 2 <= count; c += 2) {
+                const __m128d xr = _mm_loadu_pd(hr + c), xi = _mm_loadu_pd(hi + c);
+                const __m128d tr = _mm_sub_pd(_mm_mul_pd(vwr, xr), _mm_mul_pd(vwi, xi));
+                const __m128d ti = _mm_add_pd(_mm_mul_pd(vwr, xi), _mm_mul_pd(vwi, xr));
+                const __m128d ur = _mm_loadu_pd(lr + c), ui = _mm_loadu_pd(li + c);
+                _mm_storeu_pd(lr + c, _mm_add_pd(ur, tr));
+                _mm_storeu_pd(li + c, _mm_add_pd(ui, ti));
+                _mm_storeu_pd(hr + c, _mm_sub_pd(ur, tr));
+                _mm_storeu_pd(hi + c, _mm_sub_pd(ui, ti));
+            }
+            for (; c < count; ++c) {
+                const double p = wr * hr[c], q = wi * hi[c];
+                const double s = wr * hi[c], t = wi * hr[c];
+                const double tr = p - q, ti = s + t;
+                const double ur = lr[c], ui = li[c];
+                lr[c] = ur + tr;
+                li[c] = ui + ti;
+                hr[c] = ur - tr;
+                hi[c] = ui - ti;
+            }
+        }
+    }
+}
+
+static void cmac_rows_scalar_tail(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                                  const float* x_re, const float* x_im, size_t k, size_t lanes, size_t rows) {
+    for (; k < lanes; ++k) {
+        float yr = y_re[k], yi = y_im[k];
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            yr += w_re[o] * x_re[o] - w_im[o] * x_im[o];
+            yi += w_re[o] * x_im[o] + w_im[o] * x_re[o];
+        }
+        y_re[k] = yr;
+        y_im[k] = yi;
+    }
+}
+
+static void cupdate_rows_scalar_tail(float* w_re, float* w_im, const float* a, const float* b,
+                                     const float* x_re, const float* x_im, size_t k, size_t lanes, size_t rows) {
+    for (; k < lanes; ++k) {
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            w_re[o] += a[k] * x_re[o] + b[k] * x_im[o];
+            w_im[o] += b[k] * x_re[o] - a[k] * x_im[o];
+        }
+    }
+}
+
+// One vector of bands at a time, its sums kept in registers across the rows
+static void cmac_rows_f32_sse41(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                                const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    size_t k = 0;
+    for (; k + 4 <= lanes; k += 4) {
+        __m128 rr = _mm_loadu_ps(y_re + k), ii = _mm_setzero_ps();
+        __m128 ri = _mm_loadu_ps(y_im + k), ir = _mm_setzero_ps();
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const __m128 wr = _mm_loadu_ps(w_re + o), wi = _mm_loadu_ps(w_im + o);
+            const __m128 xr = _mm_loadu_ps(x_re + o), xi = _mm_loadu_ps(x_im + o);
+            rr = _mm_add_ps(rr, _mm_mul_ps(wr, xr));
+            ii = _mm_add_ps(ii, _mm_mul_ps(wi, xi));
+            ri = _mm_add_ps(ri, _mm_mul_ps(wr, xi));
+            ir = _mm_add_ps(ir, _mm_mul_ps(wi, xr));
+        }
+        _mm_storeu_ps(y_re + k, _mm_sub_ps(rr, ii));
+        _mm_storeu_ps(y_im + k, _mm_add_ps(ri, ir));
+    }
+    cmac_rows_scalar_tail(y_re, y_im, w_re, w_im, x_re, x_im, k, lanes, rows);
+}
+
+static void cupdate_rows_f32_sse41(float* w_re, float* w_im, const float* a, const float* b,
+                                   const float* x_re, const float* x_im, size_t lanes, size_t rows) {
+    size_t k = 0;
+    for (; k + 4 <= lanes; k += 4) {
+        const __m128 va = _mm_loadu_ps(a + k), vb = _mm_loadu_ps(b + k);
+        for (size_t r = 0, o = k; r < rows; ++r, o += lanes) {
+            const __m128 xr = _mm_loadu_ps(x_re + o), xi = _mm_loadu_ps(x_im + o);
+            const __m128 dr = _mm_add_ps(_mm_mul_ps(va, xr), _mm_mul_ps(vb, xi));
+            const __m128 di = _mm_sub_ps(_mm_mul_ps(vb, xr), _mm_mul_ps(va, xi));
+            _mm_storeu_ps(w_re + o, _mm_add_ps(_mm_loadu_ps(w_re + o), dr));
+            _mm_storeu_ps(w_im + o, _mm_add_ps(_mm_loadu_ps(w_im + o), di));
+        }
+    }
+    cupdate_rows_scalar_tail(w_re, w_im, a, b, x_re, x_im, k, lanes, rows);
+}
+
+static int32_t dot_q15_sse41(const int16_t* a, const int16_t* b, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+    }
+    uint32_t sum = static_cast<uint32_t>(hsum_epi32(acc));
+    for (; i < n; ++i) sum += static_cast<uint32_t>(static_cast<int32_t>(a[i]) * b[i]);
+    return static_cast<int32_t>(sum);
+}
+
+static void update_q15_sse41(int16_t* w, const int16_t* x, int16_t e, int16_t step, size_t n) {
+    const __m128i ve = _mm_set1_epi16(e);
+    const __m128i vs = _mm_set1_epi16(step);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i vx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+        __m128i vw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+        __m128i scaled = mul_q15(mul_q15(vx, ve), vs);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(w + i), _mm_adds_epi16(vw, scaled));
+    }
+    for (; i < n; ++i) {
+        int16_t update = static_cast<int16_t>((static_cast<int32_t>(x[i]) * e) >> 15);
+        int16_t scaled = static_cast<int16_t>((static_cast<int32_t>(update) * step) >> 15);
+        w[i] = sat16(static_cast<int32_t>(w[i]) + scaled);
+    }
+}
+
+const Kernels& sse41_kernels() {
+    static const Kernels k = {
+        "sse4.1",
+        dot_f32_sse41,
+        axpy_f32_sse41,
+        gain_f32_sse41,
+        abs_sum_f32_sse41,
+        butterfly_c32_sse41,
+        butterfly_c64_sse41,
+        butterfly_batch_f64_sse41,
+        cmac_rows_f32_sse41,
+        cupdate_rows_f32_sse41,
+        dot_q15_sse41,
+        update_q15_sse41,
+    };
+    return k;
+}
+
+} // namespace simd
+} // namespace aec
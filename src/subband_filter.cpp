@@ -0,0 +1,287 @@
+#include "aec/subband_filter.hpp"
+#include "aec/fft.hpp"
+#include "aec/simd_kernels.hpp"
+#include "aec/trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <initializer_list>
+
+namespace aec {
+
+// Prototype length in bands: long enough that a band's neighbours are down
+// in the stop band before they alias at the decimated rate
+static constexpr uint32_t kPrototypeFactor = 4;
+
+// Every band advances one sample per frame, so the filters run band-major:
+// history and coefficient rows hold one tap of all bands side by side (real
+// and imaginary parts split, rows padded to whole vectors), and each tap is
+// one pass across the bands on the SIMD kernel table. The history rows are
+// mirrored like NLMSFilter's delay line (row i at both i and i + taps),
+// newest first, so the window is always `taps` contiguous rows.
+class SubbandFilter::Impl {
+public:
+    Impl(uint32_t length, uint32_t bands, float mu, float delta, Arena* arena)
+        : M(is_power_of_two(bands) && bands >= 8 && bands <= 512 ? bands : 64),
+          D(M / 2), L(kPrototypeFactor * M), K(M / 2 + 1), row((K + 7) & ~7u),
+          // The bands also see the prototype's own spread, L / D samples
+          N((std::max<uint32_t>(1, length) + D - 1) / D + L / D),
+          mu(mu), delta(delta), fft(M, arena),
+          analysis(arena), synthesis(arena), far_in(arena), near_in(arena), fold(arena),
+          far_spec(arena), near_spec(arena), err_spec(arena), frame_out(arena), ola(arena), pending(arena),
+          xr(arena), xi(arena), wr(arena), wi(arena), yr(arena), yi(arena), step_re(arena), step_im(arena),
+          power(arena), kernels(simd::kernels()) {
+        design_prototype();
+        far_in.resize(L);
+        near_in.resize(L);
+        fold.resize(M);
+        far_spec.resize(K);
+        near_spec.resize(K);
+        err_spec.resize(K);
+        frame_out.resize(M);
+        ola.resize(L);
+        pending.resize(D);
+        yr.resize(row);
+        yi.resize(row);
+        step_re.resize(row);
+        step_im.resize(row);
+        reset();
+    }
+
+    void reset() {
+        std::fill(far_in.begin(), far_in.end(), 0.0f);
+        std::fill(near_in.begin(), near_in.end(), 0.0f);
+        std::fill(ola.begin(), ola.end(), 0.0f);
+        std::fill(pending.begin(), pending.end(), 0.0f);
+        xr.assign(static_cast<size_t>(2) * N * row, 0.0f);
+        xi.assign(xr.size(), 0.0f);
+        wr.assign(static_cast<size_t>(N) * row, 0.0f);
+        wi.assign(wr.size(), 0.0f);
+        power.assign(K, 0.0);
+        fill = 0;
+        x_index = 0;
+        frames = 0;
+    }
+
+    void save_state(StateWriter& out) const {
+        for (const ArenaVector<float>* v : {&far_in, &near_in, &ola, &pending, &xr, &xi, &wr, &wi}) out.put(*v);
+        out.put(power);
+        out.put(fill);
+        out.put(x_index);
+        out.put(frames);
+    }
+
+    bool load_state(StateReader& in) {
+        for (ArenaVector<float>* v : {&far_in, &near_in, &ola, &pending, &xr, &xi, &wr, &wi}) {
+            if (!in.get(*v)) return false;
+        }
+        if (!in.get(power) || !in.get(fill) || !in.get(x_index) || !in.get(frames)) return false;
+        if (fill >= D || x_index >= N) return in.fail();
+        return true;
+    }
+
+    bool process_block(const float* far, const float* near, float* out, size_t n, size_t stride, bool adapt) {
+        // New samples fill the tail of the analysis windows; each output
+        // sample comes from the last frame's synthesis
+        for (size_t i = 0; i < n; ++i) {
+            far_in[L - D + fill] = far[i * stride];
+            near_in[L - D + fill] = near[i * stride];
+            out[i * stride] = pending[fill];
+            if (++fill == D) {
+                process_frame(adapt);
+                fill = 0;
+            }
+        }
+        return true;
+    }
+
+    float get_coeff_norm() const {
+        // Band b stands for bins b and M - b of the fullband response; the
+        // two edge bands have no mirror. By Parseval the fullband taps' norm
+        // is then about the bands' total over M.
+        double sum = 0.0;
+        for (uint32_t i = 0; i < N; ++i) {
+            const float* r = &wr[static_cast<size_t>(i) * row];
+            const float* im = &wi[static_cast<size_t>(i) * row];
+            for (uint32_t k = 0; k < K; ++k) {
+                const double tap = static_cast<double>(r[k]) * r[k] + static_cast<double>(im[k]) * im[k];
+                sum += (k == 0 || k == K - 1) ? tap : 2.0 * tap;
+            }
+        }
+        return static_cast<float>(std::sqrt(sum / M));
+    }
+
+    uint32_t bands() const { return M; }
+    uint32_t decimation() const { return D; }
+    uint32_t taps() const { return N; }
+    uint32_t latency() const { return L; }
+
+private:
+    // Root-raised-cosine prototype with full roll-off: its autocorrelation
+    // is a Nyquist pulse, so analysis and synthesis with the same window
+    // cancel each other's time aliasing (to about -44 dB at 4 * bands taps)
+    // and the band edges fall where the decimated spectrum folds. The
+    // synthesis window is scaled for unit gain.
+    void design_prototype() {
+        analysis.resize(L);
+        synthesis.resize(L);
+        const double pi = 3.14159265358979323846;
+        const double centre = 0.5 * (L - 1);
+        double energy = 0.0;
+        for (uint32_t l = 0; l < L; ++l) {
+            const double t = (l - centre) / M;
+            const double d = 1.0 - 16.0 * t * t;
+            const double h = std::abs(d) < 1e-9 ? 1.0 : 4.0 * std::cos(2.0 * pi * t) / (pi * d);
+            analysis[l] = static_cast<float>(h / M);
+            energy += (h / M) * (h / M);
+        }
+        for (uint32_t l = 0; l < L; ++l) synthesis[l] = static_cast<float>(analysis[l] * D / energy);
+    }
+
+    // Windows the last L samples, folds them to M points and transforms:
+    // bin k is band k at this frame
+    void analyze(const ArenaVector<float>& in, std::complex<float>* spec) {
+        std::fill(fold.begin(), fold.end(), 0.0f);
+        for (uint32_t l = 0; l < L; ++l) fold[l & (M - 1)] += analysis[l] * in[l];
+        fft.forward(fold.data(), spec);
+    }
+
+    void process_frame(bool adapt) {
+        analyze(far_in, far_spec.data());
+        analyze(near_in, near_spec.data());
+        std::copy(far_in.begin() + D, far_in.end(), far_in.begin());
+        std::copy(near_in.begin() + D, near_in.end(), near_in.begin());
+
+        // Newest band samples go in front of the history
+        const size_t oldest = static_cast<size_t>(x_index + N - 1) * row;
+        x_index = x_index == 0 ? N - 1 : x_index - 1;
+        float* new_re = &xr[static_cast<size_t>(x_index) * row];
+        float* new_im = &xi[static_cast<size_t>(x_index) * row];
+        double mean_power = 0.0;
+        for (uint32_t k = 0; k < K; ++k) {
+            const double leaving = static_cast<double>(xr[oldest + k]) * xr[oldest + k] +
+                                   static_cast<double>(xi[oldest + k]) * xi[oldest + k];
+            new_re[k] = new_re[static_cast<size_t>(N) * row + k] = far_spec[k].real();
+            new_im[k] = new_im[static_cast<size_t>(N) * row + k] = far_spec[k].imag();
+            power[k] = std::max(0.0, power[k] + std::norm(far_spec[k]) - leaving);
+        }
+        // Recompute once per pass over the history to bound drift
+        if (++frames % N == 0) {
+            std::fill(power.begin(), power.end(), 0.0);
+            for (uint32_t i = 0; i < N; ++i) {
+                const float* x_re = new_re + static_cast<size_t>(i) * row;
+                const float* x_im = new_im + static_cast<size_t>(i) * row;
+                for (uint32_t k = 0; k < K; ++k) {
+                    power[k] += static_cast<double>(x_re[k]) * x_re[k] + static_cast<double>(x_im[k]) * x_im[k];
+                }
+            }
+        }
+        for (uint32_t k = 0; k < K; ++k) mean_power += power[k];
+        mean_power /= K;
+
+        // Echo estimate y = sum_i w_i x_i in every band at once
+        std::fill(yr.begin(), yr.end(), 0.0f);
+        std::fill(yi.begin(), yi.end(), 0.0f);
+        kernels.cmac_rows_f32(yr.data(), yi.data(), wr.data(), wi.data(), new_re, new_im, row, N);
+
+        // Per-band NLMS step; the floor keeps bands without far-end energy
+        // from amplifying near-end noise, as in PBFDAFFilter
+        const double floor = delta * N + 1e-2 * mean_power + 1e-20;
+        for (uint32_t k = 0; k < K; ++k) {
+            err_spec[k] = near_spec[k] - std::complex<float>(yr[k], yi[k]);
+            const float g = static_cast<float>(mu / (power[k] + floor));
+            step_re[k] = g * err_spec[k].real();
+            step_im[k] = g * err_spec[k].imag();
+        }
+        // w += g * e * conj(x)
+        if (adapt) kernels.cupdate_rows_f32(wr.data(), wi.data(), step_re.data(), step_im.data(), new_re, new_im, row, N);
+
+        // Weighted overlap-add of the residual frame
+        fft.inverse(err_spec.data(), frame_out.data());
+        for (uint32_t l = 0; l < L; ++l) ola[l] += synthesis[l] * frame_out[l & (M - 1)];
+        std::copy(ola.begin(), ola.begin() + D, pending.begin());
+        std::copy(ola.begin() + D, ola.end(), ola.begin());
+        std::fill(ola.end() - D, ola.end(), 0.0f);
+    }
+
+    uint32_t M;   // bands, also the transform size
+    uint32_t D;   // decimation
+    uint32_t L;   // prototype length
+    uint32_t K;   // bands carrying a real signal
+    uint32_t row; // K padded to whole vectors
+    uint32_t N;   // taps per band
+    float mu;
+    float delta;
+    RealFFT fft;
+
+    ArenaVector<float> analysis;  // prototype
+    ArenaVector<float> synthesis; // prototype scaled for unit gain
+    ArenaVector<float> far_in;    // last L input samples, oldest first
+    ArenaVector<float> near_in;
+    ArenaVector<float> fold;
+    ArenaVector<std::complex<float>> far_spec;
+    ArenaVector<std::complex<float>> near_spec;
+    ArenaVector<std::complex<float>> err_spec;
+    ArenaVector<float> frame_out;
+    ArenaVector<float> ola;       // synthesis overlap-add
+    ArenaVector<float> pending;   // the last frame's D output samples
+    ArenaVector<float> xr;        // far-end band history, 2N mirrored rows
+    ArenaVector<float> xi;
+    ArenaVector<float> wr;        // coefficients, N rows
+    ArenaVector<float> wi;
+    ArenaVector<float> yr;        // echo estimate per band
+    ArenaVector<float> yi;
+    ArenaVector<float> step_re;   // normalized error per band
+    ArenaVector<float> step_im;
+    ArenaVector<double> power;    // far-end power over each band's window
+    const simd::Kernels& kernels;
+    uint32_t fill = 0;
+    uint32_t x_index = 0;
+    uint64_t frames = 0;
+};
+
+// SubbandFilter implementation
+SubbandFilter::SubbandFilter(uint32_t length, uint32_t bands, float mu, float delta, Arena* arena)
+    : pimpl(arena_new<Impl>(arena, length, bands, mu, delta, arena)) {}
+
+SubbandFilter::~SubbandFilter() = default;
+
+bool SubbandFilter::process_block(const float* far, const float* near, float* out,
+                                  size_t n, size_t stride, bool adapt) {
+    AEC_TRACE_SCOPE("SubbandFilter::process_block");
+    return pimpl->process_block(far, near, out, n, stride, adapt);
+}
+
+void SubbandFilter::reset() {
+    pimpl->reset();
+}
+
+void SubbandFilter::save_state(StateWriter& out) const {
+    pimpl->save_state(out);
+}
+
+bool SubbandFilter::load_state(StateReader& in) {
+    return pimpl->load_state(in);
+}
+
+float SubbandFilter::get_coeff_norm() const {
+    return pimpl->get_coeff_norm();
+}
+
+uint32_t SubbandFilter::bands() const {
+    return pimpl->bands();
+}
+
+uint32_t SubbandFilter::decimation() const {
+    return pimpl->decimation();
+}
+
+uint32_t SubbandFilter::taps_per_band() const {
+    return pimpl->taps();
+}
+
+uint32_t SubbandFilter::latency() const {
+    return pimpl->latency();
+}
+
+} // namespace aec
@@ -0,0 +1,54 @@
+#include "aec/timing.hpp"
+#include <algorithm>
+
+namespace aec {
+
+uint64_t timing_bucket_floor(uint32_t b) {
+    if (b < 4) return b;
+    if (b >= kTimingBuckets) return UINT64_MAX;
+    const uint32_t msb = b / 4 + 1;
+    return static_cast<uint64_t>(4 + b % 4) << (msb - 2);
+}
+
+// Upper edge of the bucket holding the `fraction` quantile of `count` samples
+static uint64_t percentile(const StageTiming& t, double fraction) {
+    if (t.count == 0) return 0;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(t.count) + 0.5));
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < kTimingBuckets; ++b) {
+        seen += t.histogram[b];
+        if (seen >= rank) return std::min(timing_bucket_floor(b + 1) - 1, t.max_ns);
+    }
+    return t.max_ns;
+}
+
+TimingStats TimingRecorder::snapshot() const {
+    TimingStats stats;
+    if (reset_pending.load()) return stats;
+    for (uint32_t s = 0; s < kTimingStages; ++s) {
+        const Counters& c = stages[s];
+        StageTiming& t = stats.stages[s];
+        for (uint32_t b = 0; b < kTimingBuckets; ++b) t.histogram[b] = c.histogram[b].load(std::memory_order_relaxed);
+        t.total_ns = c.total_ns.load(std::memory_order_relaxed);
+        t.max_ns = c.max_ns.load(std::memory_order_relaxed);
+        for (uint64_t n : t.histogram) t.count += n;
+        t.p50_ns = percentile(t, 0.50);
+        t.p99_ns = percentile(t, 0.99);
+    }
+    stats.frames = stats.stage(Stage::Frame).count;
+    stats.overruns = overruns.load(std::memory_order_relaxed);
+    stats.worst_overrun_ns = worst_overrun_ns.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void TimingRecorder::clear() {
+    for (Counters& c : stages) {
+        for (auto& n : c.histogram) n.store(0, std::memory_order_relaxed);
+        c.total_ns.store(0, std::memory_order_relaxed);
+        c.max_ns.store(0, std::memory_order_relaxed);
+    }
+    overruns.store(0, std::memory_order_relaxed);
+    worst_overrun_ns.store(0, std::memory_order_relaxed);
+}
+
+} // namespace aec
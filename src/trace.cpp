@@ -0,0 +1,208 @@
+#include "aec/trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aec {
+namespace trace {
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+};
+
+// Written by its thread alone, read by write_chrome_json() from any other.
+// Slots are relaxed atomics so a torn read is never undefined; the reader
+// drops whatever the writer may have reached while it copied.
+struct Ring {
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> begin_ns{0};
+        std::atomic<uint64_t> end_ns{0};
+    };
+
+    std::unique_ptr<Slot[]> slots{new Slot[kRingEvents]};
+    std::atomic<uint64_t> head{0};    // events ever written
+    std::atomic<uint64_t> cleared{0}; // events before this were dropped by clear()
+    std::atomic<bool> live{true};
+    uint32_t tid = 0;
+    std::string name;
+
+    uint64_t oldest(uint64_t end) const {
+        return std::max(cleared.load(std::memory_order_relaxed), end > kRingEvents ? end - kRingEvents : 0);
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    uint32_t next_tid = 1;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// Hands the ring back when its thread exits; its events stay readable until
+// a new thread takes the ring over
+struct ThreadRing {
+    Ring* ring = nullptr;
+    ~ThreadRing() {
+        if (ring) ring->live.store(false, std::memory_order_release);
+    }
+};
+
+thread_local ThreadRing current;
+
+Ring* acquire_ring() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Ring* ring = nullptr;
+    for (auto& candidate : r.rings) {
+        if (!candidate->live.load(std::memory_order_acquire)) {
+            ring = candidate.get();
+            ring->cleared.store(ring->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            ring->live.store(true, std::memory_order_relaxed);
+            break;
+        }
+    }
+    if (!ring) {
+        r.rings.emplace_back(new Ring);
+        ring = r.rings.back().get();
+    }
+    ring->tid = r.next_tid++;
+    ring->name = "thread " + std::to_string(ring->tid);
+    return ring;
+}
+
+void write_escaped(std::FILE* f, const char* s) {
+    for (; *s; ++s) {
+        const unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', f);
+            std::fputc(c, f);
+        } else if (c < 0x20) {
+            std::fprintf(f, "\\u%04x", c);
+        } else {
+            std::fputc(c, f);
+        }
+    }
+}
+
+} // namespace
+
+void record(const char* name, uint64_t begin_ns, uint64_t end_ns) {
+    Ring* ring = current.ring;
+    if (!ring) ring = current.ring = acquire_ring();
+    const uint64_t h = ring->head.load(std::memory_order_relaxed);
+    // As a seqlock writer: an exporter that sees any of the slot stores
+    // below (then fences) also sees head at least h, so it drops the slot
+    std::atomic_thread_fence(std::memory_order_release);
+    Ring::Slot& slot = ring->slots[h & (kRingEvents - 1)];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    ring->head.store(h + 1, std::memory_order_release);
+}
+
+void register_thread(const char* name) {
+    if (!current.ring) current.ring = acquire_ring();
+    if (!name) return;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    current.ring->name = name;
+}
+
+bool write_chrome_json(const char* path) {
+    if (!path) return false;
+    struct Thread {
+        uint32_t tid;
+        std::string name;
+        std::vector<Event> events;
+    };
+    std::vector<Thread> threads;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& ring : r.rings) {
+            Thread t{ring->tid, ring->name, {}};
+            const uint64_t end = ring->head.load(std::memory_order_acquire);
+            const uint64_t begin = ring->oldest(end);
+            t.events.reserve(static_cast<size_t>(end - begin));
+            for (uint64_t i = begin; i < end; ++i) {
+                const Ring::Slot& slot = ring->slots[i & (kRingEvents - 1)];
+                t.events.push_back({slot.name.load(std::memory_order_relaxed),
+                                    slot.begin_ns.load(std::memory_order_relaxed),
+                                    slot.end_ns.load(std::memory_order_relaxed)});
+            }
+            // Slots the writer may have reused while they were copied,
+            // including the one a live thread may be filling for the next
+            // event (a ring is not handed over while the registry is locked)
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const bool writing = ring->live.load(std::memory_order_acquire);
+            const uint64_t valid = ring->oldest(ring->head.load(std::memory_order_relaxed) + (writing ? 1 : 0));
+            if (valid > begin) {
+                t.events.erase(t.events.begin(),
+                               t.events.begin() + static_cast<ptrdiff_t>(std::min(valid, end) - begin));
+            }
+            if (!t.events.empty()) threads.push_back(std::move(t));
+        }
+    }
+
+    uint64_t origin = UINT64_MAX;
+    for (const Thread& t : threads) {
+        for (const Event& e : t.events) origin = std::min(origin, e.begin_ns);
+    }
+
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", f);
+    bool first = true;
+    for (const Thread& t : threads) {
+        std::fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                     first ? "" : ",", t.tid);
+        write_escaped(f, t.name.c_str());
+        std::fputs("\"}}", f);
+        first = false;
+        for (const Event& e : t.events) {
+            if (!e.name) continue;
+            std::fputs(",\n{\"name\":\"", f);
+            write_escaped(f, e.name);
+            // Microseconds, to the nanosecond
+            std::fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", t.tid,
+                         static_cast<double>(e.begin_ns - origin) / 1000.0,
+                         static_cast<double>(e.end_ns - e.begin_ns) / 1000.0);
+        }
+    }
+    std::fputs("\n]}\n", f);
+    const bool ok = std::ferror(f) == 0;
+    return std::fclose(f) == 0 && ok;
+}
+
+void clear() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& ring : r.rings) ring->cleared.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+size_t event_count() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    size_t n = 0;
+    for (const auto& ring : r.rings) {
+        const uint64_t end = ring->head.load(std::memory_order_acquire);
+        n += static_cast<size_t>(end - ring->oldest(end));
+    }
+    return n;
+}
+
+} // namespace trace
+} // namespace aec
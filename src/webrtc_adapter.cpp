@@ -1,11 +1,16 @@
-double WebRTCAecAdapter::GetErle() const {
-double WebRTCAecAdapter::GetLatencyMs() const {
 #include "aec/webrtc_adapter.h"
+#include "aec/trace.hpp"
 #include <cstring>
 namespace aec {
 namespace webrtc {
 bool WebRTCAecAdapter::Init(const AECConfig& config, uint32_t sample_rate, uint32_t frame_ms, uint32_t channels) {
-    sample_rate_ = sample_rate;
+    return Init(config, sample_rate, sample_rate, frame_ms, channels);
+}
+bool WebRTCAecAdapter::Init(const AECConfig& config, uint32_t render_rate, uint32_t capture_rate, uint32_t frame_ms,
+                            uint32_t channels) {
+    sample_rate_ = capture_rate;
+    render_rate_ = render_rate;
+    if (sample_rate_ == 0) return false;
     channels_ = channels > 0 ? channels : 1;
     if (config.frame_size != 0) {
         frame_size_ = config.frame_size;
@@ -15,26 +20,84 @@ bool WebRTCAecAdapter::Init(const AECConfig& config, uint32_t sample_rate, uint3
         frame_size_ = static_cast<uint32_t>((static_cast<uint64_t>(sample_rate_) * frame_ms_) / 1000);
     }
     if (frame_size_ == 0) return false;
+    render_resampler_.reset();
+    if (render_rate_ != sample_rate_) {
+        // Each render frame must yield exactly one capture frame
+        if (!Resampler::supports(render_rate_, sample_rate_) ||
+            (static_cast<uint64_t>(frame_size_) * render_rate_) % sample_rate_ != 0) {
+            return false;
+        }
+        render_resampler_.reset(new Resampler(render_rate_, sample_rate_, channels_));
+    }
     const size_t total_samples = static_cast<size_t>(frame_size_) * channels_;
-    far_buffer_.assign(total_samples, 0);
+    render_queue_.reset(new FrameQueue(render_queue_depth_, total_samples));
+    render_scratch_.assign(render_resampler_ ? total_samples : 0, 0);
+    render_primed_ = false;
+    render_overruns_.store(0, std::memory_order_relaxed);
+    render_underruns_.store(0, std::memory_order_relaxed);
+    silence_.assign(total_samples, 0);
     out_buffer_.assign(total_samples, 0);
-    aec_ = create_aec(config);
+    // The engine is chosen by rate (subbands for wideband audio)
+    AECConfig engine_config = config;
+    engine_config.sample_rate = sample_rate_;
+    aec_ = create_aec(engine_config);
     return aec_ != nullptr;
 }
+bool WebRTCAecAdapter::SetRenderQueue(uint32_t depth, uint32_t delay_frames) noexcept {
+    if (delay_frames >= depth) return false;
+    render_queue_depth_ = depth;
+    render_delay_frames_ = delay_frames;
+    return true;
+}
 void WebRTCAecAdapter::ProcessRender(const int16_t* far_frame) noexcept {
-    if (!far_frame) return;
-    const size_t bytes = static_cast<size_t>(frame_size_) * channels_ * sizeof(int16_t);
-    std::memcpy(far_buffer_.data(), far_frame, bytes);
+    AEC_TRACE_SCOPE("WebRTCAecAdapter::ProcessRender");
+    if (!far_frame || !render_queue_) return;
+    int16_t* slot = render_queue_->acquire();
+    if (!slot) render_overruns_.fetch_add(1, std::memory_order_relaxed);
+    if (render_resampler_) {
+        // A dropped frame still goes through the resampler, whose history
+        // has to stay continuous
+        const size_t render_frame = static_cast<size_t>(frame_size_) * render_rate_ / sample_rate_;
+        render_resampler_->process(far_frame, render_frame, slot ? slot : render_scratch_.data());
+    } else if (slot) {
+        std::memcpy(slot, far_frame, static_cast<size_t>(frame_size_) * channels_ * sizeof(int16_t));
+    }
+    if (slot) render_queue_->push();
+}
+// The queued render frame for this capture, or silence while the queue
+// builds up to the alignment delay
+const int16_t* WebRTCAecAdapter::NextRenderFrame() noexcept {
+    const uint32_t queued = render_queue_->size();
+    if (!render_primed_) {
+        if (queued <= render_delay_frames_) return silence_.data();
+        render_primed_ = true;
+    } else if (queued == 0) {
+        render_underruns_.fetch_add(1, std::memory_order_relaxed);
+        render_primed_ = false;
+        return silence_.data();
+    }
+    return render_queue_->front();
 }
 bool WebRTCAecAdapter::ProcessCapture(int16_t* in_out_frame) noexcept {
+    AEC_TRACE_SCOPE("WebRTCAecAdapter::ProcessCapture");
     if (!in_out_frame) return false;
-    if (!enabled_) return true;
-    if (!aec_) return false;
-    const bool ok = aec_->process(far_buffer_.data(), in_out_frame, out_buffer_.data(), frame_size_, channels_);
-    if (!ok) return false;
-    const size_t bytes = static_cast<size_t>(frame_size_) * channels_ * sizeof(int16_t);
-    std::memcpy(in_out_frame, out_buffer_.data(), bytes);
-    return true;
+    if (!aec_) return !enabled_;
+    // The render side keeps moving while the canceller is off
+    const int16_t* far = NextRenderFrame();
+    bool ok = true;
+    if (enabled_) {
+        ok = aec_->process(far, in_out_frame, out_buffer_.data(), frame_size_, channels_);
+        if (ok) std::memcpy(in_out_frame, out_buffer_.data(), static_cast<size_t>(frame_size_) * channels_ * sizeof(int16_t));
+    }
+    if (far != silence_.data()) render_queue_->pop();
+    return ok;
+}
+RenderQueueStats WebRTCAecAdapter::GetRenderQueueStats() const noexcept {
+    RenderQueueStats stats;
+    stats.overruns = render_overruns_.load(std::memory_order_relaxed);
+    stats.underruns = render_underruns_.load(std::memory_order_relaxed);
+    stats.queued = render_queue_ ? render_queue_->size() : 0;
+    return stats;
 }
 double WebRTCAecAdapter::GetErle() const {
     if (!aec_) return 0.0;
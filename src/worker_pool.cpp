@@ -0,0 +1,168 @@
+#include "aec/worker_pool.hpp"
+#include "aec/trace.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace aec {
+
+// Tells the core we are in a spin-wait loop (lower power, no memory-order
+// mis-speculation penalty on exit)
+static inline void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+class WorkerPool::Impl {
+public:
+    Impl(uint32_t workers, bool pin, uint32_t spin_iterations)
+        : pin(pin),
+          // Spinning only pays when the threads really run side by side
+          spin_iterations(std::thread::hardware_concurrency() > 1 ? spin_iterations : 0),
+          participants(workers + 1) {
+        threads.reserve(workers);
+        for (uint32_t i = 0; i < workers; ++i) threads.emplace_back([this, i] { worker_loop(i + 1); });
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+            generation.fetch_add(1, std::memory_order_release);
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    void run(uint32_t tasks, TaskFn fn, void* context) {
+        if (participants == 1 || tasks <= 1) {
+            for (uint32_t t = 0; t < tasks; ++t) fn(context, t);
+            return;
+        }
+
+        // The job is published by the generation bump; workers read it only
+        // after seeing the new generation, and run() does not return (so the
+        // job is not rewritten) until every worker has finished with it
+        job_fn = fn;
+        job_context = context;
+        job_tasks = tasks;
+        pending.store(participants - 1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            generation.fetch_add(1, std::memory_order_release);
+        }
+        wake.notify_all();
+
+        for (uint32_t t = 0; t < tasks; t += participants) fn(context, t);
+
+        for (uint32_t i = 0; i < spin_iterations && pending.load(std::memory_order_acquire) != 0; ++i) cpu_relax();
+        if (pending.load(std::memory_order_acquire) != 0) {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+        }
+    }
+
+    uint32_t workers() const { return participants - 1; }
+    uint64_t wakeups() const { return wakeup_count.load(std::memory_order_relaxed); }
+    uint32_t pinned() const { return pinned_count.load(std::memory_order_relaxed); }
+
+private:
+    void worker_loop(uint32_t index) {
+        if (pin && pin_to_cpu(index)) pinned_count.fetch_add(1, std::memory_order_relaxed);
+#if defined(AEC_ENABLE_TRACING)
+        char name[32];
+        std::snprintf(name, sizeof(name), "aec worker %u", index);
+        trace::register_thread(name);
+#endif
+        uint64_t seen = 0;
+        for (;;) {
+            uint64_t g = generation.load(std::memory_order_acquire);
+            for (uint32_t i = 0; g == seen && i < spin_iterations; ++i) {
+                cpu_relax();
+                g = generation.load(std::memory_order_acquire);
+            }
+            if (g == seen) {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation.load(std::memory_order_acquire) != seen; });
+                g = generation.load(std::memory_order_acquire);
+                wakeup_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            seen = g;
+            if (stop) return;
+
+            for (uint32_t t = index; t < job_tasks; t += participants) job_fn(job_context, t);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_one();
+            }
+        }
+    }
+
+    // Worker i goes to the i-th CPU of the affinity mask it inherited (the
+    // process's cgroup or taskset), wrapping around, which leaves the first
+    // to the thread calling run(). False when the mask has a single CPU or
+    // the kernel refused. Only on Linux/Android; elsewhere the scheduler
+    // places the threads.
+    static bool pin_to_cpu(uint32_t index) {
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+        const int count = CPU_COUNT(&allowed);
+        if (count < 2) return false;
+        int skip = static_cast<int>(index % static_cast<uint32_t>(count));
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (!CPU_ISSET(cpu, &allowed) || skip-- > 0) continue;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return sched_setaffinity(0, sizeof(set), &set) == 0;
+        }
+        return false;
+#else
+        (void)index;
+        return false;
+#endif
+    }
+
+    const bool pin;
+    const uint32_t spin_iterations;
+    const uint32_t participants; // workers plus the thread calling run()
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake; // new generation, for parked workers
+    std::condition_variable done; // pending reached zero, for a parked run()
+    std::atomic<uint64_t> generation{0};
+    std::atomic<uint32_t> pending{0};
+    std::atomic<uint64_t> wakeup_count{0};
+    std::atomic<uint32_t> pinned_count{0};
+    bool stop = false; // written under the mutex before the final generation bump
+    TaskFn job_fn = nullptr;
+    void* job_context = nullptr;
+    uint32_t job_tasks = 0;
+};
+
+WorkerPool::WorkerPool(uint32_t workers, bool pin, uint32_t spin_iterations)
+    : pimpl(std::make_unique<Impl>(workers, pin, spin_iterations)) {}
+WorkerPool::~WorkerPool() = default;
+
+void WorkerPool::run(uint32_t tasks, TaskFn fn, void* context) { pimpl->run(tasks, fn, context); }
+uint32_t WorkerPool::workers() const { return pimpl->workers(); }
+uint64_t WorkerPool::wakeups() const { return pimpl->wakeups(); }
+uint32_t WorkerPool::pinned() const { return pimpl->pinned(); }
+
+} // namespace aec
@@ -2,6 +2,7 @@
 #include "aec/aec.hpp"
 #include <vector>
 #include <cmath>
+#include <random>
 
 class AECTest : public ::testing::Test {
 protected:
@@ -53,15 +54,96 @@ TEST_F(AECTest, LatencyMeasurement) {
     EXPECT_LT(latency, 5.0); // Should be less than 5ms
 }
 
+// Far-end noise and its echo through a short two-tap path
+static void make_echo(uint32_t frame_size, std::mt19937& gen, std::vector<int16_t>& history,
+                      std::vector<int16_t>& far_end, std::vector<int16_t>& near_end) {
+    std::normal_distribution<float> dist(0.0f, 3000.0f);
+    for (uint32_t i = 0; i < frame_size; ++i) {
+        history.insert(history.begin(), static_cast<int16_t>(dist(gen)));
+        history.pop_back();
+        far_end[i] = history[0];
+        near_end[i] = static_cast<int16_t>(0.5f * history[20] + 0.2f * history[40]);
+    }
+}
+
 TEST_F(AECTest, ERLEMeasurement) {
+    config.use_fixed_point = false;
     auto aec = aec::create_aec(config);
-    
-    std::vector<int16_t> far_end(config.frame_size, 1000);
-    std::vector<int16_t> near_end(config.frame_size, 2000);
-    std::vector<int16_t> output(config.frame_size);
-    
-    aec->process(far_end.data(), near_end.data(), output.data(), config.frame_size);
-    
-    double erle = aec->get_erle();
-    EXPECT_GT(erle, 0.0);
+    EXPECT_EQ(aec->get_erle(), 0.0);
+
+    std::mt19937 gen(3);
+    std::vector<int16_t> history(64, 0);
+    std::vector<int16_t> far_end(config.frame_size), near_end(config.frame_size), output(config.frame_size);
+    for (int i = 0; i < 150; ++i) {
+        make_echo(config.frame_size, gen, history, far_end, near_end);
+        aec->process(far_end.data(), near_end.data(), output.data(), config.frame_size);
+    }
+
+    aec::AECMetrics metrics = aec->get_metrics();
+    const aec::ChannelMetrics& m = metrics.channel[0];
+    EXPECT_EQ(metrics.channels, 1u);
+    EXPECT_GT(aec->get_erle(), 15.0);
+    EXPECT_EQ(metrics.erle_db, aec->get_erle());
+    EXPECT_EQ(m.erle_db, metrics.erle_db);
+    // 0.5^2 + 0.2^2 of the far-end power reaches the microphone
+    EXPECT_NEAR(m.erl_db, -10.0 * std::log10(0.29), 0.5);
+    EXPECT_NEAR(m.misadjustment, std::pow(10.0, -m.erle_db / 10.0), 1e-9);
+    EXPECT_GT(m.coefficient_norm, 0.4);
+    EXPECT_EQ(m.echo_frames, 150u);
+    EXPECT_FALSE(metrics.double_talk);
+
+    aec->reset();
+    EXPECT_EQ(aec->get_erle(), 0.0);
+    EXPECT_EQ(aec->get_metrics().channel[0].echo_frames, 0u);
+}
+
+TEST_F(AECTest, MetricsSkipSilentFarEndAndDoubleTalk) {
+    config.use_fixed_point = false;
+    config.enable_double_talk_detection = true;
+    auto aec = aec::create_aec(config);
+    std::vector<int16_t> far_end(config.frame_size, 0), near_end(config.frame_size), output(config.frame_size);
+
+    // Near-end talk over a silent far-end says nothing about the echo path
+    std::mt19937 gen(9);
+    std::normal_distribution<float> dist(0.0f, 3000.0f);
+    for (int i = 0; i < 20; ++i) {
+        for (auto& v : near_end) v = static_cast<int16_t>(dist(gen));
+        aec->process(far_end.data(), near_end.data(), output.data(), config.frame_size);
+    }
+    EXPECT_EQ(aec->get_metrics().channel[0].echo_frames, 0u);
+
+    // Loud near-end talk over a quiet, unrelated far-end is double-talk
+    for (int i = 0; i < 20; ++i) {
+        for (auto& v : far_end) v = static_cast<int16_t>(dist(gen) / 10.0f);
+        for (auto& v : near_end) v = static_cast<int16_t>(dist(gen));
+        aec->process(far_end.data(), near_end.data(), output.data(), config.frame_size);
+    }
+    aec::AECMetrics metrics = aec->get_metrics();
+    EXPECT_TRUE(metrics.double_talk);
+    EXPECT_TRUE(metrics.channel[0].double_talk);
+    EXPECT_GT(metrics.channel[0].dtd_near_far_ratio, 1.5);
+    EXPECT_LT(metrics.channel[0].echo_frames, 5u);
+}
+
+TEST_F(AECTest, DTDTierCounters) {
+    config.channels = 2;
+    config.enable_double_talk_detection = true;
+    config.dtd_tiered = true;
+    auto aec = aec::create_aec(config);
+
+    // Echo only on both channels: the energy gate settles every frame
+    std::vector<int16_t> far_end(config.frame_size * 2), near_end(far_end.size()), output(far_end.size());
+    for (size_t i = 0; i < far_end.size(); ++i) {
+        far_end[i] = static_cast<int16_t>(3000.0f * std::sin(0.05f * static_cast<float>(i / 2)));
+        near_end[i] = static_cast<int16_t>(far_end[i] / 2);
+    }
+    for (int i = 0; i < 10; ++i) {
+        aec->process(far_end.data(), near_end.data(), output.data(), config.frame_size, 2);
+    }
+    aec::DTDTierCounters counters = aec->get_dtd_tier_counters();
+    EXPECT_EQ(counters.silent + counters.far_only + counters.near_only + counters.coherence, 20u);
+    EXPECT_EQ(counters.far_only, 20u);
+
+    aec->reset();
+    EXPECT_EQ(aec->get_dtd_tier_counters().far_only, 0u);
 }
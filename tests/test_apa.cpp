@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "aec/apa_filter.hpp"
+#include "aec/nlms_filter.hpp"
+#include "aec/aec.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+
+// AR(2) far-end (strongly colored, like voiced speech) through a decaying
+// echo path, with far-end silence over [gap_from, gap_to). Returns ERLE (dB)
+// over samples [from, to).
+template <typename Process>
+static double colored_erle(uint32_t length, uint32_t from, uint32_t to, Process process,
+                           uint32_t gap_from = 0, uint32_t gap_to = 0) {
+    std::mt19937 gen(3);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(length);
+    for (uint32_t i = 0; i < length; ++i) h[i] = 0.3f * dist(gen) * std::exp(-static_cast<float>(i) / (length / 4.0f));
+
+    std::vector<float> x(to, 0.0f);
+    float p1 = 0.0f, p2 = 0.0f;
+    for (uint32_t i = 0; i < to; ++i) {
+        float v = 0.05f * dist(gen);
+        float s = 1.6f * p1 - 0.8f * p2 + v;
+        p2 = p1;
+        p1 = s;
+        x[i] = (i >= gap_from && i < gap_to) ? 0.0f : s;
+    }
+    double near_pow = 0.0, out_pow = 0.0;
+    for (uint32_t i = 0; i < to; ++i) {
+        float y = 0.0f;
+        for (uint32_t j = 0; j < length && j <= i; ++j) y += h[j] * x[i - j];
+        float e = process(x[i], y);
+        if (i >= from) {
+            near_pow += y * y;
+            out_pow += e * e;
+        }
+    }
+    return 10.0 * std::log10(near_pow / (out_pow + 1e-20));
+}
+
+TEST(APATest, ConvergesFasterThanNLMSOnColoredInput) {
+    const uint32_t length = 256;
+    aec::APAFilter apa(length, 8, 1.0f, 1e-6f);
+    aec::NLMSFilter nlms(length, 0.5f, 1e-6f, false);
+
+    // Fourth 250 ms window after start-up
+    double apa_erle = colored_erle(length, 12000, 16000, [&](float x, float y) { return apa.process(x, y); });
+    double nlms_erle = colored_erle(length, 12000, 16000, [&](float x, float y) { return nlms.process_float(x, y); });
+    EXPECT_GT(apa_erle, nlms_erle + 3.0);
+}
+
+TEST(APATest, StableAcrossFarEndSilence) {
+    const uint32_t length = 256;
+    aec::APAFilter apa(length, 8, 1.0f, 1e-6f);
+    // Far-end drops out for half a second, then resumes: the projection must
+    // not blow up while the correlation matrix refills
+    double erle = colored_erle(length, 24000, 32000, [&](float x, float y) { return apa.process(x, y); },
+                               16000, 24000);
+    EXPECT_GT(erle, 20.0);
+    EXPECT_TRUE(std::isfinite(apa.get_coeff_norm()));
+}
+
+TEST(APATest, FrozenAdaptationKeepsCancelling) {
+    const uint32_t length = 64;
+    aec::APAFilter apa(length, 4, 0.5f, 1e-6f);
+    uint32_t n = 0;
+    double erle = colored_erle(length, 20000, 24000, [&](float x, float y) {
+        return apa.process(x, y, n++ < 16000);
+    });
+    EXPECT_GT(erle, 20.0);
+}
+
+TEST(APATest, ResetClearsCoefficients) {
+    aec::APAFilter apa(16, 4, 0.5f, 1e-6f);
+    EXPECT_EQ(apa.order(), 4u);
+    for (int i = 0; i < 100; ++i) apa.process(std::sin(0.3f * i), 0.5f * std::sin(0.3f * i));
+    EXPECT_GT(apa.get_coeff_norm(), 0.0f);
+    apa.reset();
+    EXPECT_EQ(apa.get_coeff_norm(), 0.0f);
+}
+
+TEST(APATest, AECConfigSelectsEngine) {
+    aec::AECConfig config;
+    config.frame_size = 128;
+    config.filter_length = 64;
+    config.mu = 0.5f;
+    config.enable_double_talk_detection = false;
+
+    std::vector<int16_t> far(config.frame_size), near(config.frame_size);
+    for (uint32_t i = 0; i < config.frame_size; ++i) {
+        far[i] = static_cast<int16_t>(3000.0f * std::sin(0.21f * i) + 1000.0f * std::sin(1.3f * i));
+        near[i] = static_cast<int16_t>(far[i] / 2);
+    }
+    std::vector<int16_t> out_nlms(config.frame_size), out_apa(config.frame_size);
+
+    auto nlms = aec::create_aec(config);
+    config.algorithm = aec::Algorithm::APA;
+    config.apa_order = 4;
+    auto apa = aec::create_aec(config);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(nlms->process(far.data(), near.data(), out_nlms.data(), config.frame_size));
+        ASSERT_TRUE(apa->process(far.data(), near.data(), out_apa.data(), config.frame_size));
+    }
+    EXPECT_NE(out_nlms, out_apa);
+
+    // At least 20 dB of echo removed after five frames
+    double near_pow = 0.0, apa_pow = 0.0;
+    for (auto v : near) near_pow += static_cast<double>(v) * v;
+    for (auto v : out_apa) apa_pow += static_cast<double>(v) * v;
+    EXPECT_LT(apa_pow, 0.01 * near_pow);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/arena.hpp"
+#include <cstdint>
+
+namespace {
+
+struct Counted {
+    explicit Counted(int& live) : live(live) { ++live; }
+    ~Counted() { --live; }
+    int& live;
+};
+
+} // namespace
+
+TEST(ArenaTest, AllocationsAreCacheLineAligned) {
+    aec::Arena arena(1000, false);
+    EXPECT_EQ(arena.capacity(), 1024u);
+    void* a = arena.allocate(3);
+    void* b = arena.allocate(100);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % aec::Arena::alignment, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % aec::Arena::alignment, 0u);
+    EXPECT_EQ(static_cast<char*>(b) - static_cast<char*>(a), 64);
+    EXPECT_EQ(arena.used(), 64u + 128u);
+    EXPECT_TRUE(arena.owns(b));
+    // Full: the caller falls back to the heap
+    EXPECT_EQ(arena.allocate(1024), nullptr);
+}
+
+TEST(ArenaTest, CountingArenaSizesARealOne) {
+    aec::Arena probe;
+    {
+        aec::ArenaVector<float> v(100, 0.0f, &probe);
+        aec::ArenaVector<double> w(&probe);
+        w.resize(7);
+    }
+    EXPECT_EQ(probe.used(), 448u + 64u);
+    EXPECT_EQ(probe.capacity(), 0u);
+
+    aec::Arena arena(probe.used(), false);
+    aec::ArenaVector<float> v(100, 0.0f, &arena);
+    aec::ArenaVector<double> w(&arena);
+    w.resize(7);
+    EXPECT_TRUE(arena.owns(v.data()));
+    EXPECT_TRUE(arena.owns(w.data()));
+    EXPECT_EQ(arena.used(), arena.capacity());
+    // Growing past the block moves to the heap
+    v.resize(1000);
+    EXPECT_FALSE(arena.owns(v.data()));
+}
+
+TEST(ArenaTest, ArenaObjectsAreDestroyed) {
+    aec::Arena arena(256, false);
+    int live = 0;
+    {
+        aec::ArenaPtr<Counted> in_arena = aec::arena_new<Counted>(&arena, live);
+        aec::ArenaPtr<Counted> on_heap = aec::arena_new<Counted>(nullptr, live);
+        EXPECT_TRUE(arena.owns(in_arena.get()));
+        EXPECT_FALSE(arena.owns(on_heap.get()));
+        EXPECT_EQ(live, 2);
+    }
+    EXPECT_EQ(live, 0);
+}
+
+TEST(ArenaTest, HugePagesFallBack) {
+    // Works with or without huge pages reserved on the machine
+    aec::Arena arena(4096, true);
+    EXPECT_GE(arena.capacity(), 4096u);
+    EXPECT_NE(arena.allocate(4096), nullptr);
+}
+
+TEST(ArenaTest, FootprintFollowsConfig) {
+    aec::AECConfig config;
+    config.filter_length = 512;
+    config.channels = 2;
+    const size_t small = aec::create_aec(config)->memory_footprint();
+    EXPECT_EQ(aec::create_aec(config)->memory_footprint(), small);
+    config.filter_length = 1024;
+    // Two channels of 512 more Q15 taps and mirrored delay-line samples
+    EXPECT_GE(aec::create_aec(config)->memory_footprint(), small + 2 * 3 * 512 * sizeof(int16_t));
+    config.arena_huge_pages = true;
+    EXPECT_GE(aec::create_aec(config)->memory_footprint(), small);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "aec/delay_estimator.hpp"
+#include "aec/aec.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+static int16_t clamp16(float v) {
+    return static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, v)));
+}
+
+// AR(2) far-end (speech-like colouring, or white) with 250 ms pauses every
+// 750 ms
+static std::vector<int16_t> make_far(uint32_t n, uint32_t seed, bool colored = true) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<int16_t> far(n);
+    float p1 = 0.0f, p2 = 0.0f;
+    for (uint32_t i = 0; i < n; ++i) {
+        float v = dist(gen);
+        float s = colored ? 1.6f * p1 - 0.8f * p2 + 0.2f * v : 0.7f * v;
+        p2 = p1;
+        p1 = s;
+        far[i] = (i / 4000) % 3 == 2 ? 0 : clamp16(3000.0f * s);
+    }
+    return far;
+}
+
+// Echo with a bulk delay and a short dispersive tail, plus near-end noise
+static std::vector<int16_t> make_echo(const std::vector<int16_t>& far, uint32_t delay, float noise) {
+    std::mt19937 gen(17);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<int16_t> near(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        float y = noise * dist(gen);
+        for (uint32_t j = 0; j < 24 && j + delay <= i; ++j) {
+            y += 0.4f * std::exp(-static_cast<float>(j) / 6.0f) * (j % 2 ? -1.0f : 1.0f) * far[i - delay - j];
+        }
+        near[i] = clamp16(y);
+    }
+    return near;
+}
+
+TEST(DelayEstimatorTest, FindsBulkDelay) {
+    const uint32_t delay = 4000; // 250 ms at 16 kHz
+    auto far = make_far(16000 * 4, 1);
+    auto near = make_echo(far, delay, 300.0f);
+
+    aec::DelayEstimator estimator(8000);
+    for (size_t i = 0; i < far.size(); i += 160) estimator.update(&far[i], &near[i], 160);
+    EXPECT_NEAR(static_cast<double>(estimator.delay()), delay, 4.0);
+    EXPECT_GT(estimator.confidence(), 0.5f);
+    EXPECT_EQ(estimator.max_delay(), 8000u);
+}
+
+TEST(DelayEstimatorTest, LowConfidenceOnUnrelatedSignals) {
+    auto far = make_far(16000 * 4, 1);
+    auto near = make_far(16000 * 4, 2);
+
+    aec::DelayEstimator estimator(8000);
+    for (size_t i = 0; i < far.size(); i += 160) estimator.update(&far[i], &near[i], 160);
+    EXPECT_LT(estimator.confidence(), 0.3f);
+
+    estimator.reset();
+    EXPECT_EQ(estimator.delay(), 0u);
+    EXPECT_EQ(estimator.confidence(), 0.0f);
+}
+
+TEST(DelayEstimatorTest, InterleavedStride) {
+    const uint32_t delay = 1200;
+    auto far = make_far(16000 * 3, 3);
+    auto near = make_echo(far, delay, 100.0f);
+    // Channel 0 of a stereo buffer, channel 1 holds unrelated samples
+    std::vector<int16_t> far2(far.size() * 2), near2(near.size() * 2);
+    for (size_t i = 0; i < far.size(); ++i) {
+        far2[2 * i] = far[i];
+        near2[2 * i] = near[i];
+        far2[2 * i + 1] = near2[2 * i + 1] = static_cast<int16_t>(i * 7919);
+    }
+    aec::DelayEstimator estimator(4000);
+    for (size_t i = 0; i < far.size(); i += 256) {
+        const uint32_t n = static_cast<uint32_t>(std::min<size_t>(256, far.size() - i));
+        estimator.update(&far2[2 * i], &near2[2 * i], n, 2);
+    }
+    EXPECT_NEAR(static_cast<double>(estimator.delay()), delay, 4.0);
+}
+
+TEST(DelayEstimatorTest, AECCancelsLateEchoWithShortFilter) {
+    const uint32_t delay = 4000;
+    auto far = make_far(16000 * 6, 4, false);
+    auto near = make_echo(far, delay, 0.0f);
+
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.mu = 0.5f;
+    config.use_fixed_point = false;
+    config.enable_double_talk_detection = false;
+
+    auto run = [&](aec::AEC& aec) {
+        std::vector<int16_t> out(config.frame_size);
+        double near_pow = 0.0, out_pow = 0.0;
+        for (size_t off = 0; off + config.frame_size <= far.size(); off += config.frame_size) {
+            EXPECT_TRUE(aec.process(&far[off], &near[off], out.data(), config.frame_size));
+            if (off >= 16000 * 5) {
+                for (uint32_t i = 0; i < config.frame_size; ++i) {
+                    near_pow += static_cast<double>(near[off + i]) * near[off + i];
+                    out_pow += static_cast<double>(out[i]) * out[i];
+                }
+            }
+        }
+        return 10.0 * std::log10(near_pow / (out_pow + 1.0));
+    };
+
+    auto plain = aec::create_aec(config);
+    const double plain_erle = run(*plain);
+    EXPECT_EQ(plain->get_estimated_delay(), 0u);
+    EXPECT_EQ(plain->get_delay_confidence(), 0.0f);
+
+    config.enable_delay_estimation = true;
+    auto compensated = aec::create_aec(config);
+    const double erle = run(*compensated);
+    EXPECT_NEAR(static_cast<double>(compensated->get_estimated_delay()), delay, 4.0);
+    EXPECT_GT(compensated->get_delay_confidence(), config.delay_confidence_threshold);
+    // Jitter of a few samples is left to the headroom taps
+    EXPECT_NEAR(static_cast<double>(compensated->get_applied_delay() + config.delay_headroom),
+                static_cast<double>(compensated->get_estimated_delay()), 8.0);
+
+    EXPECT_LT(plain_erle, 3.0);
+    EXPECT_GT(erle, 20.0);
+
+    compensated->reset();
+    EXPECT_EQ(compensated->get_applied_delay(), 0u);
+}
@@ -86,3 +86,117 @@ TEST(DoubleTalkDetectorTest, DoubleTalkWithNearDominantDisablesAdapt) {
         EXPECT_TRUE(adapt);
     }
 
+    TEST(DoubleTalkDetectorTest, FrequencyDomainNonPowerOfTwoFrame) {
+        // 10 ms frames at 16 kHz are zero-padded to a 256-point transform
+        DoubleTalkDetector coherent(160, 1.2f, 0.2f, 0.9f, 2, true, 0);
+        DoubleTalkDetector incoherent(160, 1.2f, 0.15f, 0.85f, 2, true, 0);
+        std::vector<int16_t> far(160, 0);
+        std::vector<int16_t> near(160, 0);
+
+        bool adapt_coherent = false, adapt_incoherent = true;
+        for (int i = 0; i < 12; ++i) {
+            fill_sine(far, 1000.0f, 440.0f, 16000, 160 * i);
+            fill_sine(near, 500.0f, 440.0f, 16000, 160 * i);
+            adapt_coherent = coherent.update(far.data(), near.data(), 160, 1);
+            fill_sine(near, 2000.0f, 900.0f, 16000, 160 * i + 3);
+            adapt_incoherent = incoherent.update(far.data(), near.data(), 160, 1);
+        }
+        EXPECT_TRUE(adapt_coherent);
+        EXPECT_FALSE(adapt_incoherent);
+    }
+
+    // Batched detector against independent per-channel detectors on 8 mics
+    static void check_multichannel_matches(bool use_frequency, bool shared_far, bool tiered = false) {
+        const uint32_t ch = 8, frame = 160;
+        MultiChannelDoubleTalkDetector bank(ch, frame, 1.2f, 0.2f, 0.9f, 2, use_frequency, 0, tiered);
+        std::vector<DoubleTalkDetector> single(ch, DoubleTalkDetector(frame, 1.2f, 0.2f, 0.9f, 2, use_frequency, 0,
+                                                                      tiered));
+        std::vector<int16_t> far(frame), near(frame);
+        std::vector<int16_t> far_il(frame * ch), near_il(frame * ch);
+        for (int f = 0; f < 40; ++f) {
+            // The far-end pauses for a few frames, leaving only near-end talk
+            fill_sine(far, f >= 30 && f < 34 ? 0.0f : 3000.0f, 440.0f, 16000, frame * f);
+            for (uint32_t c = 0; c < ch; ++c) {
+                // Echo-only on some mics, talk on the others every other half second
+                const bool talk = c % 3 == 0 && (f / 25) % 2 == 0;
+                fill_sine(near, talk ? 4000.0f : 500.0f + 100.0f * c, talk ? 900.0f : 440.0f, 16000, frame * f + c);
+                for (uint32_t i = 0; i < frame; ++i) {
+                    far_il[i * ch + c] = shared_far ? far[i] : static_cast<int16_t>(far[i] + c);
+                    near_il[i * ch + c] = near[i];
+                }
+            }
+            bool adapt[8];
+            bank.update(far_il.data(), near_il.data(), frame, ch, adapt);
+            EXPECT_EQ(bank.far_end_shared(), shared_far);
+            for (uint32_t c = 0; c < ch; ++c) {
+                EXPECT_EQ(adapt[c], single[c].update(&far_il[c], &near_il[c], frame, ch));
+                EXPECT_EQ(bank.channel(c).get_last_coherence(), single[c].get_last_coherence());
+                EXPECT_EQ(bank.channel(c).get_last_ratio(), single[c].get_last_ratio());
+            }
+        }
+        DTDTierCounters total;
+        for (const auto& d : single) {
+            total.silent += d.tier_counters().silent;
+            total.far_only += d.tier_counters().far_only;
+            total.near_only += d.tier_counters().near_only;
+            total.coherence += d.tier_counters().coherence;
+        }
+        EXPECT_EQ(bank.tier_counters().silent, total.silent);
+        EXPECT_EQ(bank.tier_counters().far_only, total.far_only);
+        EXPECT_EQ(bank.tier_counters().near_only, total.near_only);
+        EXPECT_EQ(bank.tier_counters().coherence, total.coherence);
+    }
+
+    TEST(DoubleTalkDetectorTest, MultiChannelSharedFarEndMatchesPerChannel) {
+        check_multichannel_matches(true, true);
+        check_multichannel_matches(false, true);
+    }
+
+    TEST(DoubleTalkDetectorTest, MultiChannelSeparateFarEndsMatchPerChannel) {
+        check_multichannel_matches(true, false);
+        check_multichannel_matches(false, false);
+    }
+
+    TEST(DoubleTalkDetectorTest, MultiChannelTieredMatchesPerChannel) {
+        check_multichannel_matches(true, true, true);
+        check_multichannel_matches(true, false, true);
+    }
+
+    TEST(DoubleTalkDetectorTest, TieredGateSkipsClearFrames) {
+        const uint32_t frame = 160;
+        DoubleTalkDetector full(frame, 1.5f, 0.3f, 0.9f, 3, true, 0);
+        DoubleTalkDetector tiered(frame, 1.5f, 0.3f, 0.9f, 3, true, 0, true, 10.0f);
+        std::vector<int16_t> far(frame), near(frame);
+        auto run = [&](int frames, float far_amp, float near_amp, float near_freq, int start) {
+            for (int f = 0; f < frames; ++f) {
+                fill_sine(far, far_amp, 440.0f, 16000, frame * (start + f));
+                fill_sine(near, near_amp, near_freq, 16000, frame * (start + f) + 7);
+                const bool a = full.update(far.data(), near.data(), frame);
+                const bool b = tiered.update(far.data(), near.data(), frame);
+                // The gate only settles frames whose outcome is clear
+                if (tiered.tier_counters().coherence == 0) {
+                    EXPECT_EQ(a, b);
+                }
+            }
+        };
+        run(10, 0.0f, 0.0f, 440.0f, 0);       // silence
+        run(20, 3000.0f, 1500.0f, 440.0f, 10); // echo only
+        EXPECT_EQ(tiered.tier_counters().silent, 10u);
+        EXPECT_EQ(tiered.tier_counters().far_only, 20u);
+        EXPECT_EQ(tiered.tier_counters().coherence, 0u);
+        EXPECT_TRUE(tiered.is_adapt_allowed());
+
+        run(40, 0.0f, 3000.0f, 440.0f, 30);    // near-end talk, far-end silent
+        EXPECT_GT(tiered.tier_counters().near_only, 10u);
+        EXPECT_FALSE(tiered.is_adapt_allowed());
+
+        run(40, 2000.0f, 3000.0f, 900.0f, 70); // double-talk: ratio in the ambiguous band
+        EXPECT_GT(tiered.tier_counters().coherence, 10u);
+        EXPECT_FALSE(tiered.is_adapt_allowed());
+
+        // Without tiering every frame takes the coherence path
+        EXPECT_EQ(full.tier_counters().coherence, 110u);
+        EXPECT_EQ(full.tier_counters().silent + full.tier_counters().far_only + full.tier_counters().near_only, 0u);
+        tiered.reset();
+        EXPECT_EQ(tiered.tier_counters().coherence, 0u);
+    }
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "aec/fft.hpp"
+#include <vector>
+#include <cmath>
+
+TEST(FFTTest, MatchesNaiveDFT) {
+    const uint32_t n = 64;
+    aec::RealFFT fft(n);
+    std::vector<float> x(n);
+    for (uint32_t i = 0; i < n; ++i) x[i] = std::sin(0.3f * i) + 0.25f * std::cos(1.7f * i);
+
+    std::vector<std::complex<float>> X(fft.bins());
+    fft.forward(x.data(), X.data());
+
+    for (uint32_t k = 0; k < fft.bins(); ++k) {
+        std::complex<double> acc(0.0, 0.0);
+        for (uint32_t i = 0; i < n; ++i) {
+            acc += std::polar(1.0, -2.0 * M_PI * k * i / n) * static_cast<double>(x[i]);
+        }
+        EXPECT_NEAR(X[k].real(), acc.real(), 1e-4);
+        EXPECT_NEAR(X[k].imag(), acc.imag(), 1e-4);
+    }
+}
+
+TEST(FFTTest, InverseRoundTrip) {
+    const uint32_t n = 512;
+    aec::RealFFT fft(n);
+    std::vector<float> x(n), y(n);
+    for (uint32_t i = 0; i < n; ++i) x[i] = static_cast<float>((i * 37) % 101) / 101.0f - 0.5f;
+
+    std::vector<std::complex<float>> X(fft.bins());
+    fft.forward(x.data(), X.data());
+    fft.inverse(X.data(), y.data());
+    for (uint32_t i = 0; i < n; ++i) EXPECT_NEAR(y[i], x[i], 1e-5f);
+}
+
+TEST(FFTTest, DoubleMatchesNaiveDFT) {
+    const uint32_t n = 256;
+    aec::RealFFTd fft(n);
+    std::vector<double> x(n);
+    for (uint32_t i = 0; i < n; ++i) x[i] = std::sin(0.3 * i) - 0.5 * std::cos(2.1 * i);
+
+    std::vector<std::complex<double>> X(fft.bins());
+    fft.forward(x.data(), X.data());
+
+    for (uint32_t k = 0; k < fft.bins(); ++k) {
+        std::complex<double> acc(0.0, 0.0);
+        for (uint32_t i = 0; i < n; ++i) acc += std::polar(1.0, -2.0 * M_PI * k * i / n) * x[i];
+        EXPECT_NEAR(X[k].real(), acc.real(), 1e-9);
+        EXPECT_NEAR(X[k].imag(), acc.imag(), 1e-9);
+    }
+}
+
+TEST(FFTTest, RoundTripAllSizes) {
+    for (uint32_t n = 2; n <= 4096; n <<= 1) {
+        SCOPED_TRACE(n);
+        aec::RealFFT fft(n);
+        std::vector<float> x(n), y(n);
+        for (uint32_t i = 0; i < n; ++i) x[i] = static_cast<float>((i * 37) % 101) / 101.0f - 0.5f;
+        std::vector<std::complex<float>> X(fft.bins());
+        fft.forward(x.data(), X.data());
+        fft.inverse(X.data(), y.data());
+        for (uint32_t i = 0; i < n; ++i) ASSERT_NEAR(y[i], x[i], 1e-4f);
+    }
+}
+
+TEST(FFTTest, PlansAreShared) {
+    EXPECT_EQ(aec::fft_plan<float>(256), aec::fft_plan<float>(256));
+    EXPECT_NE(aec::fft_plan<float>(256), aec::fft_plan<float>(512));
+
+    aec::RealFFT a(1024), b(1024);
+    aec::RealFFTd c(1024);
+    EXPECT_EQ(a.plan(), b.plan());
+    EXPECT_EQ(a.plan(), aec::fft_plan<float>(1024).get());
+    EXPECT_EQ(c.plan(), aec::fft_plan<double>(1024).get());
+}
+
+TEST(FFTTest, BatchMatchesSingleExactly) {
+    for (uint32_t n : {2u, 16u, 256u}) {
+        for (uint32_t count : {1u, 3u, 8u, 9u}) {
+            SCOPED_TRACE(n * 100 + count);
+            aec::RealFFTd fft(n);
+            std::vector<double> batch(static_cast<size_t>(n) * count);
+            for (size_t i = 0; i < batch.size(); ++i) batch[i] = std::sin(0.37 * i) + 0.1 * std::cos(1.3 * i);
+            std::vector<double> re(static_cast<size_t>(fft.bins()) * count), im(re.size());
+            fft.forward_batch(batch.data(), re.data(), im.data(), count);
+
+            std::vector<double> x(n);
+            std::vector<std::complex<double>> X(fft.bins());
+            for (uint32_t c = 0; c < count; ++c) {
+                for (uint32_t i = 0; i < n; ++i) x[i] = batch[static_cast<size_t>(i) * count + c];
+                fft.forward(x.data(), X.data());
+                for (uint32_t k = 0; k < fft.bins(); ++k) {
+                    ASSERT_EQ(re[static_cast<size_t>(k) * count + c], X[k].real());
+                    ASSERT_EQ(im[static_cast<size_t>(k) * count + c], X[k].imag());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "aec/ipnlms_filter.hpp"
+#include "aec/nlms_filter.hpp"
+#include "aec/aec.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+
+// Sparse echo path: a bulk delay, then a short decaying response. White
+// far-end; the path moves to `moved_delay` at sample `move_at`. Returns ERLE
+// (dB) over samples [from, to).
+template <typename Process>
+static double sparse_erle(uint32_t delay, uint32_t from, uint32_t to, Process process,
+                          uint32_t move_at = 0, uint32_t moved_delay = 0) {
+    const uint32_t taps = 32;
+    std::mt19937 gen(5);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(taps);
+    for (uint32_t i = 0; i < taps; ++i) h[i] = 0.5f * dist(gen) * std::exp(-static_cast<float>(i) / 8.0f);
+
+    std::vector<float> x(to);
+    for (auto& v : x) v = 0.1f * dist(gen);
+
+    double near_pow = 0.0, out_pow = 0.0;
+    for (uint32_t i = 0; i < to; ++i) {
+        const uint32_t d = (move_at != 0 && i >= move_at) ? moved_delay : delay;
+        float y = 0.0f;
+        for (uint32_t j = 0; j < taps && j + d <= i; ++j) y += h[j] * x[i - d - j];
+        float e = process(x[i], y);
+        if (i >= from) {
+            near_pow += y * y;
+            out_pow += e * e;
+        }
+    }
+    return 10.0 * std::log10(near_pow / (out_pow + 1e-20));
+}
+
+TEST(IPNLMSTest, ConvergesFasterThanNLMSOnSparsePath) {
+    const uint32_t length = 512;
+    aec::IPNLMSFilter ipnlms(length, 0.5f, 1e-6f, 0.0f);
+    aec::NLMSFilter nlms(length, 0.5f, 1e-6f, false);
+
+    double ipnlms_erle = sparse_erle(300, 1500, 2500, [&](float x, float y) { return ipnlms.process(x, y); });
+    double nlms_erle = sparse_erle(300, 1500, 2500, [&](float x, float y) { return nlms.process_float(x, y); });
+    EXPECT_GT(ipnlms_erle, nlms_erle + 3.0);
+}
+
+TEST(IPNLMSTest, TapSkippingKeepsCancelling) {
+    const uint32_t length = 1024;
+    aec::IPNLMSFilter full(length, 0.5f, 1e-6f, -0.5f);
+    aec::IPNLMSFilter sparse(length, 0.5f, 1e-6f, -0.5f);
+    sparse.enable_tap_skipping(64, -40.0f, 4000);
+
+    // Ends inside a skipping phase (probes run at 0, 5024 and 11072)
+    double full_erle = sparse_erle(400, 9000, 14000, [&](float x, float y) { return full.process(x, y); });
+    double sparse_erle_db = sparse_erle(400, 9000, 14000, [&](float x, float y) { return sparse.process(x, y); });
+    EXPECT_GT(sparse_erle_db, 35.0);
+    EXPECT_GT(sparse_erle_db, full_erle - 10.0);
+    // The 32-tap response straddles at most two 64-tap blocks; a few more may
+    // sit near the -40 dB line
+    EXPECT_LE(sparse.active_taps(), length / 4);
+    EXPECT_EQ(full.active_taps(), length);
+}
+
+TEST(IPNLMSTest, TapSkippingFollowsMovedPath) {
+    const uint32_t length = 1024;
+    aec::IPNLMSFilter sparse(length, 0.5f, 1e-6f, -0.5f);
+    sparse.enable_tap_skipping(64, -40.0f, 4000);
+
+    // Path jumps from the 100-tap region into a skipped one; the periodic
+    // re-check must bring it back
+    double erle = sparse_erle(100, 24000, 28000, [&](float x, float y) { return sparse.process(x, y); },
+                              10000, 700);
+    EXPECT_GT(erle, 30.0);
+}
+
+TEST(IPNLMSTest, ResetClearsCoefficients) {
+    aec::IPNLMSFilter ipnlms(64, 0.5f, 1e-6f, -0.5f);
+    ipnlms.enable_tap_skipping(16, -40.0f, 100);
+    for (int i = 0; i < 500; ++i) ipnlms.process(std::sin(0.3f * i), 0.5f * std::sin(0.3f * i));
+    EXPECT_GT(ipnlms.get_coeff_norm(), 0.0f);
+    ipnlms.reset();
+    EXPECT_EQ(ipnlms.get_coeff_norm(), 0.0f);
+    EXPECT_EQ(ipnlms.active_taps(), 64u);
+}
+
+TEST(IPNLMSTest, AECConfigSelectsEngine) {
+    aec::AECConfig config;
+    config.frame_size = 128;
+    config.filter_length = 256;
+    config.mu = 0.5f;
+    config.enable_double_talk_detection = false;
+
+    std::mt19937 gen(9);
+    std::normal_distribution<float> dist(0.0f, 3000.0f);
+    const uint32_t frames = 40;
+    std::vector<int16_t> far(config.frame_size * frames), near(far.size());
+    for (auto& v : far) v = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, dist(gen))));
+    for (size_t i = 0; i < far.size(); ++i) near[i] = i >= 50 ? static_cast<int16_t>(far[i - 50] / 2) : 0;
+
+    config.algorithm = aec::Algorithm::IPNLMS;
+    config.sparse_tap_skipping = true;
+    config.sparse_block_size = 32;
+    auto aec = aec::create_aec(config);
+    std::vector<int16_t> out(config.frame_size);
+    double near_pow = 0.0, out_pow = 0.0;
+    for (uint32_t f = 0; f < frames; ++f) {
+        const size_t off = static_cast<size_t>(f) * config.frame_size;
+        ASSERT_TRUE(aec->process(&far[off], &near[off], out.data(), config.frame_size));
+        if (f >= frames - 5) {
+            for (uint32_t i = 0; i < config.frame_size; ++i) {
+                near_pow += static_cast<double>(near[off + i]) * near[off + i];
+                out_pow += static_cast<double>(out[i]) * out[i];
+            }
+        }
+    }
+    EXPECT_LT(out_pow, 0.01 * near_pow);
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "aec/aec.hpp"
+#include "aec/fixed_point.hpp"
 #include <vector>
+#include <random>
 
 TEST(MultiChannelTest, FourChannelProcessing) {
     aec::AECConfig config;
@@ -39,3 +41,111 @@ TEST(MultiChannelTest, FourChannelProcessing) {
         EXPECT_NE(out[c], near[c]);
     }
 }
+
+// Interleaved noise with a per-channel echo, and the same samples as planes
+struct PlanarSignals {
+    uint32_t frame_size;
+    uint32_t channels;
+    std::vector<int16_t> far, near; // interleaved
+    std::vector<std::vector<int16_t>> far_q15, near_q15; // planar
+    std::vector<std::vector<float>> far_f32, near_f32;
+
+    PlanarSignals(uint32_t frame_size, uint32_t channels) : frame_size(frame_size), channels(channels) {
+        std::mt19937 gen(11);
+        std::normal_distribution<float> dist(0.0f, 2000.0f);
+        far.resize(static_cast<size_t>(frame_size) * channels);
+        near.resize(far.size());
+        far_q15.assign(channels, std::vector<int16_t>(frame_size));
+        near_q15 = far_q15;
+        far_f32.assign(channels, std::vector<float>(frame_size));
+        near_f32 = far_f32;
+        for (uint32_t i = 0; i < frame_size; ++i) {
+            const int16_t x = static_cast<int16_t>(dist(gen));
+            for (uint32_t c = 0; c < channels; ++c) {
+                const int16_t y = static_cast<int16_t>(x / static_cast<int>(c + 2) + dist(gen) / 8);
+                far[i * channels + c] = far_q15[c][i] = x;
+                near[i * channels + c] = near_q15[c][i] = y;
+                far_f32[c][i] = x / 32768.0f;
+                near_f32[c][i] = y / 32768.0f;
+            }
+        }
+    }
+};
+
+template <typename T>
+static std::vector<const T*> planes(const std::vector<std::vector<T>>& buffers) {
+    std::vector<const T*> p;
+    for (const auto& b : buffers) p.push_back(b.data());
+    return p;
+}
+
+template <typename T>
+static std::vector<T*> planes(std::vector<std::vector<T>>& buffers) {
+    std::vector<T*> p;
+    for (auto& b : buffers) p.push_back(b.data());
+    return p;
+}
+
+TEST(MultiChannelTest, PlanarInt16MatchesInterleaved) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.channels = 3;
+    config.dtd_use_frequency = true;
+    config.enable_delay_estimation = true;
+    config.max_delay_ms = 50;
+    for (bool fixed : {true, false}) {
+        config.use_fixed_point = fixed;
+        aec::AEC interleaved(config);
+        aec::AEC planar(config);
+        // Longer than config.frame_size, so both run in chunks
+        PlanarSignals s(400, config.channels);
+        std::vector<int16_t> out(s.far.size());
+        std::vector<std::vector<int16_t>> out_planes(s.channels, std::vector<int16_t>(s.frame_size));
+        for (int frame = 0; frame < 30; ++frame) {
+            ASSERT_TRUE(interleaved.process(s.far.data(), s.near.data(), out.data(), s.frame_size, s.channels));
+            ASSERT_TRUE(planar.process(planes(s.far_q15).data(), planes(s.near_q15).data(),
+                                       planes(out_planes).data(), s.frame_size, s.channels));
+            for (uint32_t i = 0; i < s.frame_size; ++i) {
+                for (uint32_t c = 0; c < s.channels; ++c) {
+                    ASSERT_EQ(out_planes[c][i], out[i * s.channels + c]) << "fixed " << fixed << " frame " << frame;
+                }
+            }
+        }
+    }
+}
+
+TEST(MultiChannelTest, PlanarFloatMatchesInt16) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.channels = 2;
+    config.dtd_use_frequency = true;
+    config.enable_delay_estimation = true;
+    config.max_delay_ms = 50;
+    for (bool fixed : {true, false}) {
+        config.use_fixed_point = fixed;
+        aec::AEC q15(config);
+        aec::AEC f32(config);
+        PlanarSignals s(160, config.channels);
+        std::vector<std::vector<int16_t>> out_q15(s.channels, std::vector<int16_t>(s.frame_size));
+        std::vector<std::vector<float>> out_f32(s.channels, std::vector<float>(s.frame_size));
+        for (int frame = 0; frame < 30; ++frame) {
+            ASSERT_TRUE(q15.process(planes(s.far_q15).data(), planes(s.near_q15).data(),
+                                    planes(out_q15).data(), s.frame_size, s.channels));
+            ASSERT_TRUE(f32.process(planes(s.far_f32).data(), planes(s.near_f32).data(),
+                                    planes(out_f32).data(), s.frame_size, s.channels));
+            for (uint32_t c = 0; c < s.channels; ++c) {
+                for (uint32_t i = 0; i < s.frame_size; ++i) {
+                    // The Q15 engine quantizes float input exactly back to the
+                    // int16 samples; float engines see the same values either way
+                    // and only the int16 output is rounded
+                    const float y = out_f32[c][i];
+                    const int16_t expected = fixed ? static_cast<int16_t>(y * 32768.0f)
+                                                   : aec::Q15::saturate(static_cast<int32_t>(y * 32767.0f));
+                    ASSERT_EQ(expected, out_q15[c][i]) << "fixed " << fixed << " frame " << frame;
+                }
+            }
+        }
+    }
+}
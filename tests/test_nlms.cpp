@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "aec/nlms_filter.hpp"
+#include <vector>
+#include <cmath>
 
 TEST(NLMSTest, Initialization) {
     aec::NLMSFilter filter(256, 0.1f, 1e-6f, true);
@@ -30,3 +32,58 @@ TEST(NLMSTest, Reset) {
     filter.reset();
     SUCCEED();
 }
+
+TEST(NLMSTest, BlockMatchesPerSampleFixed) {
+    aec::NLMSFilter per_sample(64, 0.1f, 1e-6f, true);
+    aec::NLMSFilter block(64, 0.1f, 1e-6f, true);
+
+    // Two interleaved channels; the filter only sees channel 1
+    const size_t n = 200, stride = 2;
+    std::vector<int16_t> far(n * stride), near(n * stride), out(n * stride, 0);
+    for (size_t i = 0; i < n; ++i) {
+        far[i * stride + 1] = static_cast<int16_t>((i * 7919) % 4000 - 2000);
+        near[i * stride + 1] = static_cast<int16_t>(far[i * stride + 1] / 2 + 100);
+    }
+    ASSERT_TRUE(block.process_block(far.data() + 1, near.data() + 1, out.data() + 1, n, stride, true));
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(out[i * stride + 1], per_sample.process_fixed(far[i * stride + 1], near[i * stride + 1]));
+        EXPECT_EQ(out[i * stride], 0);
+    }
+    EXPECT_EQ(block.get_coeff_norm(), per_sample.get_coeff_norm());
+}
+
+TEST(NLMSTest, BlockMatchesPerSampleFloat) {
+    aec::NLMSFilter per_sample(64, 0.1f, 1e-6f, false);
+    aec::NLMSFilter block(64, 0.1f, 1e-6f, false);
+
+    const size_t n = 200;
+    std::vector<float> far(n), near(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        far[i] = std::sin(0.05f * static_cast<float>(i)) * 0.3f;
+        near[i] = 0.5f * far[i];
+    }
+    ASSERT_TRUE(block.process_block(far.data(), near.data(), out.data(), n, 1, true));
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_FLOAT_EQ(out[i], per_sample.process_float(far[i], near[i]));
+    }
+}
+
+TEST(NLMSTest, BlockRejectsWrongSampleType) {
+    aec::NLMSFilter filter(32, 0.1f, 1e-6f, true);
+    std::vector<float> buf(16, 0.0f);
+    EXPECT_FALSE(filter.process_block(buf.data(), buf.data(), buf.data(), buf.size(), 1, true));
+}
+
+TEST(NLMSTest, FloatPowerTrackingStableAfterLoudInput) {
+    // A loud burst followed by near-silence stresses the sliding power sum:
+    // any drift below zero would blow up the normalized step.
+    aec::NLMSFilter filter(128, 0.5f, 1e-6f, false);
+    float e = 0.0f;
+    for (int i = 0; i < 20000; ++i) {
+        float far = (i < 10000) ? 0.9f * std::sin(0.37f * i) : 1e-4f * std::sin(0.11f * i);
+        e = filter.process_float(far, 0.5f * far);
+        ASSERT_TRUE(std::isfinite(e));
+    }
+    EXPECT_LT(std::fabs(e), 1e-3f);
+    EXPECT_TRUE(std::isfinite(filter.get_coeff_norm()));
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "aec/pbfdaf_filter.hpp"
+#include "aec/aec.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+
+// Far-end white noise through a sparse echo path, returns ERLE (dB) over the
+// last second of `seconds` of audio.
+static double run_pbfdaf(uint32_t length, uint32_t block, float mu, int seconds) {
+    const uint32_t sr = 16000;
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    std::vector<float> h(length, 0.0f);
+    h[10] = 0.5f;
+    h[length / 2] = -0.25f;
+    h[length - 1] = 0.1f;
+
+    aec::PBFDAFFilter filter(length, block, mu, 1e-6f);
+    std::vector<float> history(length, 0.0f);
+    std::vector<float> far(block), near(block), out(block);
+    double near_pow = 0.0, out_pow = 0.0;
+    const uint32_t total = sr * seconds;
+    for (uint32_t n = 0; n < total; n += block) {
+        for (uint32_t i = 0; i < block; ++i) {
+            far[i] = dist(gen);
+            history.insert(history.begin(), far[i]);
+            history.pop_back();
+            float y = 0.0f;
+            for (uint32_t j = 0; j < length; ++j) y += h[j] * history[j];
+            near[i] = y;
+        }
+        EXPECT_TRUE(filter.process_block(far.data(), near.data(), out.data(), block, 1, true));
+        if (n >= total - sr) {
+            for (uint32_t i = 0; i < block; ++i) {
+                near_pow += near[i] * near[i];
+                out_pow += out[i] * out[i];
+            }
+        }
+    }
+    return 10.0 * std::log10(near_pow / (out_pow + 1e-20));
+}
+
+TEST(PBFDAFTest, Partitions) {
+    aec::PBFDAFFilter filter(1000, 256, 0.5f, 1e-6f);
+    EXPECT_EQ(filter.block_size(), 256u);
+    EXPECT_EQ(filter.partitions(), 4u);
+}
+
+TEST(PBFDAFTest, PartialBlocksAdaptAsWholeBlocks) {
+    // Chunks that split blocks adapt exactly as whole-block calls: once the
+    // calls line up with blocks again the outputs are the same
+    aec::PBFDAFFilter whole(256, 64, 0.5f, 1e-6f), split(256, 64, 0.5f, 1e-6f);
+    std::mt19937 gen(9);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    std::vector<float> far(64 * 40), near(far.size()), out_whole(far.size()), out_split(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = dist(gen);
+        near[i] = 0.5f * (i >= 20 ? far[i - 20] : 0.0f);
+    }
+    for (size_t i = 0; i < far.size(); i += 64) {
+        ASSERT_TRUE(whole.process_block(&far[i], &near[i], &out_whole[i], 64, 1, true));
+    }
+    const size_t aligned = 64 * 30;
+    const size_t chunks[] = {1, 100, 27, 64, 80, 200};
+    for (size_t i = 0, c = 0; i < aligned; c = (c + 1) % 6) {
+        const size_t n = std::min(chunks[c], aligned - i);
+        ASSERT_TRUE(split.process_block(&far[i], &near[i], &out_split[i], n, 1, true));
+        i += n;
+    }
+    ASSERT_TRUE(split.process_block(&far[aligned], &near[aligned], &out_split[aligned], far.size() - aligned, 1, true));
+    for (size_t i = aligned; i < far.size(); ++i) ASSERT_EQ(out_split[i], out_whole[i]) << i;
+
+    // Outputs of partial blocks leave out what the unconstrained partitions
+    // would wrap in from later samples, so they differ slightly
+    double whole_pow = 0.0, split_pow = 0.0;
+    for (size_t i = 64 * 10; i < aligned; ++i) {
+        whole_pow += out_whole[i] * out_whole[i];
+        split_pow += out_split[i] * out_split[i];
+    }
+    EXPECT_LT(split_pow, 2.0 * whole_pow + 1e-12);
+}
+
+TEST(PBFDAFTest, ConvergesOnLongEchoPath) {
+    double erle = run_pbfdaf(512, 64, 0.5f, 3);
+    EXPECT_GT(erle, 30.0);
+}
+
+TEST(PBFDAFTest, AECSelectsEngineFromConfig) {
+    aec::AECConfig config;
+    config.algorithm = aec::Algorithm::PBFDAF;
+    config.frame_size = 160;
+    config.filter_length = 2048;
+    config.mu = 0.5f;
+    config.enable_double_talk_detection = false;
+
+    auto aec = aec::create_aec(config);
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(-4000, 4000);
+    std::vector<int16_t> far(config.frame_size), near(config.frame_size), out(config.frame_size);
+    std::vector<int16_t> prev(config.frame_size, 0);
+    double near_pow = 0.0, out_pow = 0.0;
+    for (int frame = 0; frame < 400; ++frame) {
+        // Echo is the previous frame's far-end scaled by 0.5 (160-sample delay)
+        for (uint32_t i = 0; i < config.frame_size; ++i) {
+            far[i] = static_cast<int16_t>(dist(gen));
+            near[i] = static_cast<int16_t>(prev[i] / 2);
+        }
+        prev = far;
+        ASSERT_TRUE(aec->process(far.data(), near.data(), out.data(), config.frame_size));
+        if (frame >= 300) {
+            for (uint32_t i = 0; i < config.frame_size; ++i) {
+                near_pow += static_cast<double>(near[i]) * near[i];
+                out_pow += static_cast<double>(out[i]) * out[i];
+            }
+        }
+    }
+    EXPECT_GT(10.0 * std::log10(near_pow / (out_pow + 1.0)), 20.0);
+}
+
+TEST(PBFDAFTest, OddFrameSizesKeepLargeBlocks) {
+    // 441 samples (10 ms at 44.1 kHz) has no power-of-two factor; it still
+    // runs in 32-sample blocks, and in half frames
+    aec::AECConfig config;
+    config.algorithm = aec::Algorithm::PBFDAF;
+    config.sample_rate = 44100;
+    config.frame_size = 441;
+    config.filter_length = 1024;
+    config.mu = 0.5f;
+    config.enable_double_talk_detection = false;
+
+    auto aec = aec::create_aec(config);
+    std::mt19937 gen(4);
+    std::uniform_int_distribution<int> dist(-4000, 4000);
+    std::vector<int16_t> far(config.frame_size), near(config.frame_size), out(config.frame_size);
+    std::vector<int16_t> history(300, 0);
+    double near_pow = 0.0, out_pow = 0.0;
+    for (int frame = 0; frame < 300; ++frame) {
+        // Echo is the far-end 300 samples earlier, scaled by 0.5
+        for (uint32_t i = 0; i < config.frame_size; ++i) {
+            far[i] = static_cast<int16_t>(dist(gen));
+            near[i] = static_cast<int16_t>(history.back() / 2);
+            history.insert(history.begin(), far[i]);
+            history.pop_back();
+        }
+        ASSERT_TRUE(aec->process(far.data(), near.data(), out.data(), 200));
+        ASSERT_TRUE(aec->process(far.data() + 200, near.data() + 200, out.data() + 200, 241));
+        if (frame >= 200) {
+            for (uint32_t i = 0; i < config.frame_size; ++i) {
+                near_pow += static_cast<double>(near[i]) * near[i];
+                out_pow += static_cast<double>(out[i]) * out[i];
+            }
+        }
+    }
+    EXPECT_GT(10.0 * std::log10(near_pow / (out_pow + 1.0)), 20.0);
+}
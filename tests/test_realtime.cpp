@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/apa_filter.hpp"
+#include "aec/arena.hpp"
+#include "aec/delay_estimator.hpp"
+#include "aec/double_talk_detector.hpp"
+#include "aec/ipnlms_filter.hpp"
+#include "aec/nlms_filter.hpp"
+#include "aec/pbfdaf_filter.hpp"
+#include "aec/residual_echo_suppressor.hpp"
+#include "aec/rls_filter.hpp"
+#include "aec/session_pool.hpp"
+#include "aec/webrtc_adapter.h"
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include <new>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+// Replaces the global allocation functions for the whole test binary. While
+// an AllocationGuard is alive on a thread, every operator new on that thread
+// is counted, so tests can assert that a code path never touches the heap.
+namespace {
+
+thread_local bool g_tracking = false;
+thread_local size_t g_allocations = 0;
+
+void* tracked_alloc(std::size_t size) {
+    if (g_tracking) ++g_allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* tracked_aligned_alloc(std::size_t size, std::size_t align) {
+    if (g_tracking) ++g_allocations;
+    void* p = nullptr;
+    if (posix_memalign(&p, std::max(align, sizeof(void*)), size ? size : 1) != 0) throw std::bad_alloc();
+    return p;
+}
+
+class AllocationGuard {
+public:
+    AllocationGuard() {
+        g_allocations = 0;
+        g_tracking = true;
+    }
+    ~AllocationGuard() { g_tracking = false; }
+    size_t count() const { return g_allocations; }
+};
+
+} // namespace
+
+void* operator new(std::size_t size) { return tracked_alloc(size); }
+void* operator new[](std::size_t size) { return tracked_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) {
+    return tracked_aligned_alloc(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return tracked_aligned_alloc(size, static_cast<std::size_t>(align));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+// Far-end noise with an echo and some near-end talk, interleaved
+static void make_signals(uint32_t samples, uint32_t ch, std::vector<int16_t>& far, std::vector<int16_t>& near) {
+    std::mt19937 gen(5);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    far.resize(static_cast<size_t>(samples) * ch);
+    near.resize(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>(2000.0f * dist(gen));
+        const float echo = i >= 10 * ch ? 0.5f * far[i - 10 * ch] : 0.0f;
+        const float talk = (i / 4000) % 2 ? 800.0f * dist(gen) : 0.0f;
+        near[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, echo + talk)));
+    }
+}
+
+static size_t allocations_while_processing(const aec::AECConfig& config, uint32_t frame) {
+    const uint32_t ch = config.channels;
+    std::vector<int16_t> far, near;
+    make_signals(16000, ch, far, near);
+    std::vector<int16_t> out(static_cast<size_t>(frame) * ch);
+    auto aec = aec::create_aec(config);
+
+    AllocationGuard guard;
+    for (size_t off = 0; off + static_cast<size_t>(frame) * ch <= far.size(); off += static_cast<size_t>(frame) * ch) {
+        if (!aec->process(&far[off], &near[off], out.data(), frame, ch)) return SIZE_MAX;
+    }
+    aec->reset();
+    return guard.count();
+}
+
+TEST(RealtimeTest, GuardCountsAllocations) {
+    AllocationGuard guard;
+    auto p = std::make_unique<int>(1);
+    std::vector<float> v(16);
+    EXPECT_EQ(guard.count(), 2u);
+}
+
+TEST(RealtimeTest, ProcessDoesNotAllocate) {
+    const aec::Algorithm algorithms[] = {aec::Algorithm::NLMS, aec::Algorithm::PBFDAF, aec::Algorithm::RLS,
+                                         aec::Algorithm::APA, aec::Algorithm::IPNLMS};
+    for (aec::Algorithm algorithm : algorithms) {
+        for (bool fixed : {true, false}) {
+            for (bool frequency_dtd : {true, false}) {
+                aec::AECConfig config;
+                config.frame_size = 160;
+                config.filter_length = 256;
+                config.algorithm = algorithm;
+                config.use_fixed_point = fixed;
+                config.dtd_use_frequency = frequency_dtd;
+                config.sparse_tap_skipping = algorithm == aec::Algorithm::IPNLMS;
+                config.sparse_recheck_interval = 800;
+                SCOPED_TRACE(static_cast<int>(algorithm) * 4 + fixed * 2 + frequency_dtd);
+                EXPECT_EQ(allocations_while_processing(config, config.frame_size), 0u);
+            }
+        }
+    }
+}
+
+TEST(RealtimeTest, MultichannelDelayAndLongFramesDoNotAllocate) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.channels = 2;
+    config.enable_delay_estimation = true;
+    EXPECT_EQ(allocations_while_processing(config, 160), 0u);
+    // Frames longer than config.frame_size run in configured-size chunks
+    EXPECT_EQ(allocations_while_processing(config, 480), 0u);
+    EXPECT_EQ(allocations_while_processing(config, 400), 0u);
+}
+
+TEST(RealtimeTest, SubbandEngineDoesNotAllocate) {
+    aec::AECConfig config;
+    config.sample_rate = 48000;
+    config.frame_size = 480;
+    config.filter_length = 1024;
+    EXPECT_EQ(allocations_while_processing(config, 480), 0u);
+    EXPECT_EQ(allocations_while_processing(config, 441), 0u);
+}
+
+TEST(RealtimeTest, ResidualEchoSuppressionDoesNotAllocate) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.channels = 2;
+    config.enable_residual_echo_suppression = true;
+    config.dtd_tiered = true;
+    EXPECT_EQ(allocations_while_processing(config, 160), 0u);
+    EXPECT_EQ(allocations_while_processing(config, 400), 0u);
+    // Without frequency-domain spectra the suppressor transforms its own
+    config.dtd_use_frequency = false;
+    EXPECT_EQ(allocations_while_processing(config, 160), 0u);
+}
+
+TEST(RealtimeTest, StateSnapshotDoesNotAllocate) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.use_fixed_point = false;
+    config.algorithm = aec::Algorithm::IPNLMS;
+    config.sparse_tap_skipping = true;
+    config.enable_delay_estimation = true;
+    config.enable_residual_echo_suppression = true;
+    std::vector<int16_t> far, near;
+    make_signals(16000, 1, far, near);
+    std::vector<int16_t> out(config.frame_size);
+    auto aec = aec::create_aec(config);
+    for (size_t off = 0; off + config.frame_size <= far.size(); off += config.frame_size) {
+        ASSERT_TRUE(aec->process(&far[off], &near[off], out.data(), config.frame_size));
+    }
+    std::vector<uint8_t> snapshot(aec->state_size());
+    auto restored = aec::create_aec(config);
+
+    AllocationGuard guard;
+    ASSERT_TRUE(aec->save_state(snapshot.data(), snapshot.size()));
+    ASSERT_TRUE(restored->load_state(snapshot.data(), snapshot.size()));
+    EXPECT_EQ(guard.count(), 0u);
+}
+
+TEST(RealtimeTest, ParallelChannelsDoNotAllocate) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.channels = 4;
+    config.worker_threads = 3;
+    EXPECT_EQ(allocations_while_processing(config, 160), 0u);
+}
+
+TEST(RealtimeTest, PlanarFloatDoesNotAllocate) {
+    for (bool fixed : {true, false}) {
+        aec::AECConfig config;
+        config.frame_size = 160;
+        config.filter_length = 256;
+        config.channels = 2;
+        config.use_fixed_point = fixed;
+        config.enable_delay_estimation = true;
+        std::vector<int16_t> far, near;
+        make_signals(16000, config.channels, far, near);
+        const uint32_t samples = static_cast<uint32_t>(far.size() / config.channels);
+        std::vector<std::vector<float>> far_f32(config.channels, std::vector<float>(samples));
+        std::vector<std::vector<float>> near_f32 = far_f32;
+        std::vector<std::vector<float>> out_f32(config.channels, std::vector<float>(config.frame_size));
+        for (uint32_t i = 0; i < samples; ++i) {
+            for (uint32_t c = 0; c < config.channels; ++c) {
+                far_f32[c][i] = far[i * config.channels + c] / 32768.0f;
+                near_f32[c][i] = near[i * config.channels + c] / 32768.0f;
+            }
+        }
+        auto aec = aec::create_aec(config);
+
+        AllocationGuard guard;
+        for (uint32_t off = 0; off + config.frame_size <= samples; off += config.frame_size) {
+            const float* far_planes[] = {&far_f32[0][off], &far_f32[1][off]};
+            const float* near_planes[] = {&near_f32[0][off], &near_f32[1][off]};
+            float* out_planes[] = {out_f32[0].data(), out_f32[1].data()};
+            ASSERT_TRUE(aec->process(far_planes, near_planes, out_planes, config.frame_size, config.channels));
+        }
+        EXPECT_EQ(guard.count(), 0u) << "fixed " << fixed;
+    }
+}
+
+TEST(RealtimeTest, SessionPoolDoesNotAllocate) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    std::vector<int16_t> far, near;
+    make_signals(16000, 4, far, near);
+    std::vector<int16_t> out(far.size());
+    for (bool fixed : {true, false}) {
+        config.use_fixed_point = fixed;
+        aec::AECSessionPool pool(config, 4, 1);
+        for (int s = 0; s < 4; ++s) ASSERT_EQ(pool.open_session(), s);
+        AllocationGuard guard;
+        for (size_t off = 0; off + 640 <= far.size(); off += 640) {
+            aec::SessionFrame batch[4];
+            for (uint32_t s = 0; s < 4; ++s) batch[s] = {s, &far[off + s * 160], &near[off + s * 160], &out[off + s * 160]};
+            ASSERT_TRUE(pool.process(batch, 4));
+        }
+        EXPECT_EQ(guard.count(), 0u);
+    }
+}
+
+// Builds T once against a counting arena and once in a real arena of the
+// counted size; the second build must fit exactly and never touch the heap
+template <typename T, typename... Args>
+static void expect_exact_arena_fit(Args... args) {
+    aec::Arena probe;
+    { aec::arena_new<T>(&probe, args..., &probe); }
+    aec::Arena arena(probe.used(), false);
+    AllocationGuard guard;
+    {
+        aec::ArenaPtr<T> object = aec::arena_new<T>(&arena, args..., &arena);
+        EXPECT_TRUE(arena.owns(object.get()));
+    }
+    EXPECT_EQ(guard.count(), 0u);
+    EXPECT_EQ(arena.used(), arena.capacity());
+}
+
+TEST(RealtimeTest, EngineStateFitsItsArena) {
+    expect_exact_arena_fit<aec::NLMSFilter>(300u, 0.1f, 1e-6f, true);
+    expect_exact_arena_fit<aec::NLMSFilter>(300u, 0.1f, 1e-6f, false);
+    expect_exact_arena_fit<aec::PBFDAFFilter>(1024u, 64u, 0.1f, 1e-6f);
+    expect_exact_arena_fit<aec::RLSFilter>(64u, 0.999f, 1e-6f);
+    expect_exact_arena_fit<aec::APAFilter>(256u, 4u, 0.5f, 1e-6f);
+    expect_exact_arena_fit<aec::IPNLMSFilter>(256u, 0.1f, 1e-6f, -0.5f);
+    expect_exact_arena_fit<aec::DelayEstimator>(8000u, 1000u, 4u);
+    expect_exact_arena_fit<aec::MultiChannelDoubleTalkDetector>(4u, 160u, 1.5f, 0.3f, 0.9f, 3u, true, 0u, true, 10.0f);
+    expect_exact_arena_fit<aec::ResidualEchoSuppressor>(160u, 1.5f, -30.0f, 0.9f);
+}
+
+TEST(RealtimeTest, WebRTCAdapterDoesNotAllocate) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 512;
+    aec::webrtc::WebRTCAecAdapter adapter;
+    ASSERT_TRUE(adapter.Init(config, 16000));
+
+    std::vector<int16_t> far, near;
+    make_signals(16000, 1, far, near);
+    AllocationGuard guard;
+    for (size_t off = 0; off + 160 <= far.size(); off += 160) {
+        adapter.ProcessRender(&far[off]);
+        ASSERT_TRUE(adapter.ProcessCapture(&near[off]));
+    }
+    EXPECT_EQ(guard.count(), 0u);
+}
+
+TEST(RealtimeTest, ResamplingWebRTCAdapterDoesNotAllocate) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 512;
+    aec::webrtc::WebRTCAecAdapter adapter;
+    ASSERT_TRUE(adapter.Init(config, 48000, 16000, 10, 1));
+
+    std::vector<int16_t> far, near;
+    make_signals(16000, 1, far, near);
+    std::vector<int16_t> render(480);
+    AllocationGuard guard;
+    for (size_t off = 0; off + 160 <= far.size(); off += 160) {
+        for (size_t i = 0; i < 480; ++i) render[i] = far[off + i / 3];
+        adapter.ProcessRender(render.data());
+        ASSERT_TRUE(adapter.ProcessCapture(&near[off]));
+    }
+    EXPECT_EQ(guard.count(), 0u);
+}
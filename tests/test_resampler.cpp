@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "aec/resampler.hpp"
+#include <vector>
+#include <cmath>
+#include <random>
+
+static const double kPi = 3.14159265358979323846;
+
+// Resamples a sine and returns the SNR (dB) of the output against the ideal
+// sine at the output rate, delayed by the filter's group delay, after the
+// filter has filled
+static double sine_snr(uint32_t in_rate, uint32_t out_rate, double freq) {
+    aec::Resampler resampler(in_rate, out_rate);
+    std::vector<float> in(in_rate), out(resampler.max_output(in.size()));
+    for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<float>(std::sin(2.0 * kPi * freq * i / in_rate));
+    out.resize(resampler.process(in.data(), in.size(), out.data()));
+    EXPECT_NEAR(static_cast<double>(out.size()), static_cast<double>(out_rate), 1.0);
+
+    const double delay = 0.5 * (static_cast<double>(resampler.taps_per_phase()) * resampler.up() - 1) /
+                         (static_cast<double>(in_rate) * resampler.up());
+    double signal = 0.0, error = 0.0;
+    for (size_t m = out.size() / 4; m < out.size(); ++m) {
+        const double ideal = std::sin(2.0 * kPi * freq * (static_cast<double>(m) / out_rate - delay));
+        signal += ideal * ideal;
+        error += (out[m] - ideal) * (out[m] - ideal);
+    }
+    return 10.0 * std::log10(signal / error);
+}
+
+TEST(ResamplerTest, RatioIsReduced) {
+    aec::Resampler down(48000, 16000);
+    EXPECT_EQ(down.up(), 1u);
+    EXPECT_EQ(down.down(), 3u);
+    EXPECT_EQ(down.taps_per_phase() % 8, 0u);
+    aec::Resampler cd(44100, 48000);
+    EXPECT_EQ(cd.up(), 160u);
+    EXPECT_EQ(cd.down(), 147u);
+    EXPECT_FALSE(aec::Resampler::supports(0, 16000));
+    EXPECT_FALSE(aec::Resampler::supports(48000, 47999));
+    EXPECT_TRUE(aec::Resampler::supports(44100, 8000));
+}
+
+TEST(ResamplerTest, EqualRatesCopy) {
+    aec::Resampler resampler(16000, 16000, 2);
+    std::vector<int16_t> in(320), out(320);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<int16_t>(i * 97 - 15000);
+    EXPECT_EQ(resampler.process(in.data(), 160, out.data()), 160u);
+    EXPECT_EQ(in, out);
+    EXPECT_EQ(resampler.latency(), 0u);
+}
+
+TEST(ResamplerTest, PassBandIsClean) {
+    EXPECT_GT(sine_snr(48000, 16000, 1000.0), 60.0);
+    EXPECT_GT(sine_snr(48000, 16000, 6000.0), 60.0);
+    EXPECT_GT(sine_snr(16000, 48000, 3000.0), 60.0);
+    EXPECT_GT(sine_snr(44100, 48000, 5000.0), 60.0);
+    EXPECT_GT(sine_snr(32000, 16000, 440.0), 60.0);
+}
+
+TEST(ResamplerTest, StopBandIsRejected) {
+    // 10 kHz would alias to 6 kHz at 16 kHz
+    aec::Resampler resampler(48000, 16000);
+    std::vector<float> in(48000), out(resampler.max_output(in.size()));
+    for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<float>(std::sin(2.0 * kPi * 10000.0 * i / 48000));
+    out.resize(resampler.process(in.data(), in.size(), out.data()));
+    double power = 0.0;
+    for (size_t m = out.size() / 4; m < out.size(); ++m) power += out[m] * out[m];
+    power /= out.size() - out.size() / 4;
+    EXPECT_LT(10.0 * std::log10(power / 0.5), -70.0);
+}
+
+TEST(ResamplerTest, StreamingMatchesOneBlock) {
+    std::mt19937 gen(4);
+    std::normal_distribution<float> dist(0.0f, 3000.0f);
+    std::vector<int16_t> in(2 * 4410);
+    for (auto& v : in) v = static_cast<int16_t>(dist(gen));
+
+    aec::Resampler whole(44100, 48000, 2);
+    std::vector<int16_t> expected(whole.max_output(in.size() / 2) * 2);
+    expected.resize(whole.process(in.data(), in.size() / 2, expected.data()) * 2);
+
+    aec::Resampler chunked(44100, 48000, 2);
+    std::vector<int16_t> out;
+    std::vector<int16_t> block(chunked.max_output(97) * 2);
+    for (size_t f = 0; f < in.size() / 2; f += 97) {
+        const size_t n = std::min<size_t>(97, in.size() / 2 - f);
+        const size_t written = chunked.process(&in[f * 2], n, block.data());
+        ASSERT_LE(written, chunked.max_output(n));
+        out.insert(out.end(), block.begin(), block.begin() + written * 2);
+    }
+    EXPECT_EQ(out, expected);
+
+    // reset() starts the stream over
+    chunked.reset();
+    std::vector<int16_t> again(expected.size());
+    again.resize(chunked.process(in.data(), in.size() / 2, again.data()) * 2);
+    EXPECT_EQ(again, expected);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/double_talk_detector.hpp"
+#include "aec/residual_echo_suppressor.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+
+// Coloured far-end noise at 16 kHz through a 1024-tap decaying echo path.
+// Returns the ERLE (dB) over seconds [from, to).
+static double run_echo(const aec::AECConfig& config, uint32_t from = 6, uint32_t to = 8) {
+    aec::AEC aec(config);
+    std::mt19937 gen(21);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(1024);
+    for (size_t i = 0; i < h.size(); ++i) h[i] = 0.25f * dist(gen) * std::exp(-static_cast<float>(i) / 200.0f);
+
+    const uint32_t n = config.frame_size;
+    std::vector<float> history(h.size(), 0.0f);
+    std::vector<int16_t> far(n), near(n), out(n);
+    double near_pow = 0.0, out_pow = 0.0;
+    float ar = 0.0f;
+    const uint32_t frames = to * 16000 / n;
+    for (uint32_t f = 0; f < frames; ++f) {
+        for (uint32_t i = 0; i < n; ++i) {
+            ar = 0.8f * ar + 1500.0f * dist(gen);
+            far[i] = static_cast<int16_t>(ar);
+            history.insert(history.begin(), static_cast<float>(far[i]));
+            history.pop_back();
+            float y = 0.0f;
+            for (size_t j = 0; j < h.size(); ++j) y += h[j] * history[j];
+            near[i] = static_cast<int16_t>(y);
+        }
+        EXPECT_TRUE(aec.process(far.data(), near.data(), out.data(), n));
+        if (f >= from * 16000 / n) {
+            for (uint32_t i = 0; i < n; ++i) {
+                near_pow += static_cast<double>(near[i]) * near[i];
+                out_pow += static_cast<double>(out[i]) * out[i];
+            }
+        }
+    }
+    return 10.0 * std::log10(near_pow / (out_pow + 1.0));
+}
+
+static aec::AECConfig short_filter_config() {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.use_fixed_point = false;
+    config.mu = 0.5f;
+    return config;
+}
+
+TEST(ResidualEchoTest, ShortFilterWithSuppressorBeatsLongFilter) {
+    // The 256-tap filter leaves the echo tail; the suppressor takes most of
+    // it out and, while both filters converge, does better than 2048 taps
+    aec::AECConfig config = short_filter_config();
+    const double short_alone = run_echo(config);
+    config.enable_residual_echo_suppression = true;
+    EXPECT_GT(run_echo(config), short_alone + 20.0);
+    const double short_suppressed = run_echo(config, 1, 3);
+    config.enable_residual_echo_suppression = false;
+    config.filter_length = 2048;
+    EXPECT_GT(short_suppressed, run_echo(config, 1, 3));
+}
+
+TEST(ResidualEchoTest, NearEndAlonePassesUnchanged) {
+    // With a silent far-end there is no echo to suppress
+    aec::AECConfig config = short_filter_config();
+    aec::AEC plain(config);
+    config.enable_residual_echo_suppression = true;
+    aec::AEC suppressed(config);
+    std::mt19937 gen(8);
+    std::normal_distribution<float> dist(0.0f, 3000.0f);
+    std::vector<int16_t> far(160, 0), near(160), out_plain(160), out_suppressed(160);
+    for (int f = 0; f < 50; ++f) {
+        for (auto& v : near) v = static_cast<int16_t>(dist(gen));
+        ASSERT_TRUE(plain.process(far.data(), near.data(), out_plain.data(), 160));
+        ASSERT_TRUE(suppressed.process(far.data(), near.data(), out_suppressed.data(), 160));
+        ASSERT_EQ(out_suppressed, out_plain);
+    }
+}
+
+TEST(ResidualEchoTest, NearEndSurvivesDoubleTalk) {
+    // Echo alone until the leak is learned, then near-end speech on top
+    aec::AECConfig config = short_filter_config();
+    config.enable_residual_echo_suppression = true;
+    aec::AEC aec(config);
+    std::mt19937 gen(12);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(512);
+    for (size_t i = 0; i < h.size(); ++i) h[i] = 0.25f * dist(gen) * std::exp(-static_cast<float>(i) / 120.0f);
+    std::vector<float> history(h.size(), 0.0f);
+    std::vector<int16_t> far(160), near(160), out(160);
+    double speech_pow = 0.0, out_pow = 0.0;
+    for (int f = 0; f < 400; ++f) {
+        for (uint32_t i = 0; i < 160; ++i) {
+            far[i] = static_cast<int16_t>(1500.0f * dist(gen));
+            history.insert(history.begin(), static_cast<float>(far[i]));
+            history.pop_back();
+            float y = 0.0f;
+            for (size_t j = 0; j < h.size(); ++j) y += h[j] * history[j];
+            const float speech = f >= 300 ? 3000.0f * dist(gen) : 0.0f;
+            near[i] = static_cast<int16_t>(y + speech);
+            if (f >= 320) speech_pow += speech * speech;
+        }
+        ASSERT_TRUE(aec.process(far.data(), near.data(), out.data(), 160));
+        if (f >= 320) {
+            for (int16_t v : out) out_pow += static_cast<double>(v) * v;
+        }
+    }
+    EXPECT_GT(10.0 * std::log10(out_pow / speech_pow), -3.0);
+}
+
+TEST(ResidualEchoTest, ReusesDetectorSpectra) {
+    // The suppressor gives the same output on the detector's spectra as on
+    // its own transforms, and keeping spectra leaves the tiered decisions
+    // as they were
+    aec::MultiChannelDoubleTalkDetector plain(1, 160, 1.5f, 0.3f, 0.9f, 3, true, 0, true);
+    aec::MultiChannelDoubleTalkDetector keeping(1, 160, 1.5f, 0.3f, 0.9f, 3, true, 0, true);
+    keeping.set_keep_spectra(true);
+    aec::ResidualEchoSuppressor reuse(160), own(160);
+    EXPECT_EQ(reuse.transform_size(), 256u);
+
+    std::mt19937 gen(6);
+    std::normal_distribution<float> dist(0.0f, 2000.0f);
+    std::vector<int16_t> far(160), near(160), out_a(160), out_b(160);
+    for (int f = 0; f < 60; ++f) {
+        const float near_level = (f / 20) % 2 ? 4.0f : 0.3f;
+        for (uint32_t i = 0; i < 160; ++i) {
+            far[i] = static_cast<int16_t>(dist(gen));
+            near[i] = static_cast<int16_t>(0.3f * far[i] + near_level * dist(gen) * 0.2f);
+            out_a[i] = out_b[i] = static_cast<int16_t>(near[i] / 4);
+        }
+        bool adapt_plain = true, adapt_keeping = true;
+        plain.update(far.data(), near.data(), 160, 1, &adapt_plain);
+        keeping.update(far.data(), near.data(), 160, 1, &adapt_keeping);
+        ASSERT_EQ(adapt_plain, adapt_keeping);
+        const aec::DTDSpectra spectra = keeping.spectra(0);
+        ASSERT_NE(spectra.far, nullptr);
+        const auto decision = adapt_keeping ? aec::ResidualEchoSuppressor::Decision::FarEndOnly
+                                            : aec::ResidualEchoSuppressor::Decision::DoubleTalk;
+        reuse.process(far.data(), near.data(), out_a.data(), 160, &spectra, decision);
+        own.process(far.data(), near.data(), out_b.data(), 160, nullptr, decision);
+        ASSERT_EQ(out_a, out_b);
+    }
+    const aec::DTDTierCounters a = plain.tier_counters(), b = keeping.tier_counters();
+    EXPECT_EQ(a.far_only, b.far_only);
+    EXPECT_EQ(a.near_only, b.near_only);
+    EXPECT_EQ(a.coherence, b.coherence);
+    EXPECT_GT(a.far_only + a.near_only, 0u);
+}
+
+TEST(ResidualEchoTest, QuietNearEndTalkIsKept) {
+    // A quiet echo path, then near-end talk well below the far-end that the
+    // detector misses: the leak learned over those frames must not take the
+    // talk out with the echo tail
+    aec::AECConfig config = short_filter_config();
+    config.enable_residual_echo_suppression = true;
+    aec::AEC aec(config);
+    std::mt19937 gen(31);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(1024);
+    for (size_t i = 0; i < h.size(); ++i) h[i] = 0.02f * dist(gen) * std::exp(-static_cast<float>(i) / 200.0f);
+    std::vector<float> history(h.size(), 0.0f);
+    std::vector<int16_t> far(160), near(160), out(160);
+    double speech_pow = 0.0, out_pow = 0.0;
+    int missed = 0;
+    for (int f = 0; f < 600; ++f) {
+        for (uint32_t i = 0; i < 160; ++i) {
+            far[i] = static_cast<int16_t>(2000.0f * dist(gen));
+            history.insert(history.begin(), static_cast<float>(far[i]));
+            history.pop_back();
+            float y = 0.0f;
+            for (size_t j = 0; j < h.size(); ++j) y += h[j] * history[j];
+            const float speech = f >= 300 ? 600.0f * dist(gen) : 0.0f;
+            near[i] = static_cast<int16_t>(y + speech);
+            if (f >= 400) speech_pow += speech * speech;
+        }
+        ASSERT_TRUE(aec.process(far.data(), near.data(), out.data(), 160));
+        if (f >= 400) {
+            if (!aec.get_metrics().double_talk) ++missed;
+            for (int16_t v : out) out_pow += static_cast<double>(v) * v;
+        }
+    }
+    EXPECT_GT(missed, 150);
+    EXPECT_GT(10.0 * std::log10(out_pow / speech_pow), -3.0);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "aec/rls_filter.hpp"
+#include "aec/nlms_filter.hpp"
+#include "aec/aec.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+
+// AR(2) far-end (strongly colored, like voiced speech) through a decaying
+// echo path. Returns ERLE (dB) over samples [from, to).
+template <typename Process>
+static double colored_erle(uint32_t length, uint32_t from, uint32_t to, Process process) {
+    std::mt19937 gen(3);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(length);
+    for (uint32_t i = 0; i < length; ++i) h[i] = 0.3f * dist(gen) * std::exp(-static_cast<float>(i) / (length / 4.0f));
+
+    std::vector<float> x(to, 0.0f);
+    float p1 = 0.0f, p2 = 0.0f;
+    for (uint32_t i = 0; i < to; ++i) {
+        float v = 0.05f * dist(gen);
+        float s = 1.6f * p1 - 0.8f * p2 + v;
+        p2 = p1;
+        p1 = s;
+        x[i] = s;
+    }
+    double near_pow = 0.0, out_pow = 0.0;
+    for (uint32_t i = 0; i < to; ++i) {
+        float y = 0.0f;
+        for (uint32_t j = 0; j < length && j <= i; ++j) y += h[j] * x[i - j];
+        float e = process(x[i], y);
+        if (i >= from) {
+            near_pow += y * y;
+            out_pow += e * e;
+        }
+    }
+    return 10.0 * std::log10(near_pow / (out_pow + 1e-20));
+}
+
+TEST(RLSTest, ConvergesFasterThanNLMSOnColoredInput) {
+    const uint32_t length = 128;
+    aec::RLSFilter rls(length, 0.999f, 1e-6f);
+    aec::NLMSFilter nlms(length, 0.5f, 1e-6f, false);
+
+    // Second 250 ms window after start-up
+    double rls_erle = colored_erle(length, 4000, 8000, [&](float x, float y) { return rls.process(x, y); });
+    double nlms_erle = colored_erle(length, 4000, 8000, [&](float x, float y) { return nlms.process_float(x, y); });
+    EXPECT_GT(rls_erle, 40.0);
+    EXPECT_GT(rls_erle, nlms_erle + 10.0);
+}
+
+TEST(RLSTest, FrozenAdaptationKeepsCancelling) {
+    const uint32_t length = 32;
+    aec::RLSFilter rls(length, 0.999f, 1e-6f);
+    uint32_t n = 0;
+    // Adapt for the first second, then freeze: the ladder must keep cancelling
+    double erle = colored_erle(length, 20000, 24000, [&](float x, float y) {
+        return rls.process(x, y, n++ < 16000);
+    });
+    EXPECT_GT(erle, 30.0);
+}
+
+TEST(RLSTest, ResetClearsCoefficients) {
+    aec::RLSFilter rls(16, 0.999f, 1e-6f);
+    for (int i = 0; i < 100; ++i) rls.process(std::sin(0.3f * i), 0.5f * std::sin(0.3f * i));
+    EXPECT_GT(rls.get_coeff_norm(), 0.0f);
+    rls.reset();
+    EXPECT_EQ(rls.get_coeff_norm(), 0.0f);
+}
+
+TEST(RLSTest, AECConfigSelectsEngine) {
+    aec::AECConfig config;
+    config.frame_size = 128;
+    config.filter_length = 64;
+    config.enable_double_talk_detection = false;
+
+    std::vector<int16_t> far(config.frame_size), near(config.frame_size);
+    for (uint32_t i = 0; i < config.frame_size; ++i) {
+        far[i] = static_cast<int16_t>(3000.0f * std::sin(0.21f * i) + 1000.0f * std::sin(1.3f * i));
+        near[i] = static_cast<int16_t>(far[i] / 2);
+    }
+    std::vector<int16_t> out_nlms(config.frame_size), out_rls(config.frame_size);
+
+    auto nlms = aec::create_aec(config);
+    config.algorithm = aec::Algorithm::RLS;
+    auto rls = aec::create_aec(config);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(nlms->process(far.data(), near.data(), out_nlms.data(), config.frame_size));
+        ASSERT_TRUE(rls->process(far.data(), near.data(), out_rls.data(), config.frame_size));
+    }
+    EXPECT_NE(out_nlms, out_rls);
+
+    double rls_pow = 0.0;
+    for (auto v : out_rls) rls_pow += static_cast<double>(v) * v;
+    EXPECT_LT(rls_pow / config.frame_size, 100.0);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/session_pool.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Far-end noise and its echo plus a burst of near-end talk, different for
+// every seed
+void make_call(uint32_t seed, uint32_t samples, std::vector<int16_t>& far, std::vector<int16_t>& near) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    const uint32_t delay = 5 + seed % 20;
+    far.resize(samples);
+    near.resize(samples);
+    for (uint32_t i = 0; i < samples; ++i) {
+        far[i] = static_cast<int16_t>(2500.0f * dist(gen));
+        const float echo = i >= delay ? 0.4f * far[i - delay] : 0.0f;
+        const float talk = i > samples / 2 && i < samples / 2 + 1600 ? 1500.0f * dist(gen) : 0.0f;
+        near[i] = static_cast<int16_t>(echo + talk);
+    }
+}
+
+aec::AECConfig session_config(bool fixed) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.use_fixed_point = fixed;
+    config.pin_worker_threads = false;
+    return config;
+}
+
+} // namespace
+
+TEST(SessionPoolTest, SessionsMatchStandaloneAEC) {
+    const uint32_t sessions = 7, frames = 40, frame = 160;
+    for (bool fixed : {true, false}) {
+        const aec::AECConfig config = session_config(fixed);
+        std::vector<std::vector<int16_t>> far(sessions), near(sessions), expected(sessions);
+        for (uint32_t s = 0; s < sessions; ++s) {
+            make_call(s + 1, frames * frame, far[s], near[s]);
+            expected[s].resize(far[s].size());
+            auto reference = aec::create_aec(config);
+            for (uint32_t f = 0; f < frames; ++f) {
+                ASSERT_TRUE(reference->process(&far[s][f * frame], &near[s][f * frame], &expected[s][f * frame], frame));
+            }
+        }
+
+        for (uint32_t workers : {0u, 3u}) {
+            SCOPED_TRACE(fixed * 10 + workers);
+            aec::AECSessionPool pool(config, sessions, workers);
+            std::vector<std::vector<int16_t>> out(sessions, std::vector<int16_t>(frames * frame));
+            for (uint32_t s = 0; s < sessions; ++s) ASSERT_EQ(pool.open_session(), static_cast<int32_t>(s));
+            // Sessions join the batches at different times, in shuffled order
+            std::vector<uint32_t> next(sessions, 0);
+            std::mt19937 order(9);
+            for (uint32_t step = 0; step < frames + sessions; ++step) {
+                std::vector<aec::SessionFrame> batch;
+                for (uint32_t s = 0; s < sessions; ++s) {
+                    if (step < s || next[s] == frames) continue;
+                    const uint32_t off = next[s]++ * frame;
+                    batch.push_back({s, &far[s][off], &near[s][off], &out[s][off]});
+                }
+                std::shuffle(batch.begin(), batch.end(), order);
+                ASSERT_TRUE(pool.process(batch.data(), static_cast<uint32_t>(batch.size())));
+            }
+            for (uint32_t s = 0; s < sessions; ++s) {
+                EXPECT_EQ(out[s], expected[s]) << s;
+                EXPECT_EQ(pool.session_stats(s).frames, frames);
+                EXPECT_EQ(pool.session_stats(s).samples, frames * frame);
+            }
+            const aec::SessionPoolStats stats = pool.stats();
+            EXPECT_EQ(stats.frames, sessions * frames);
+            EXPECT_EQ(stats.samples, static_cast<uint64_t>(sessions) * frames * frame);
+            EXPECT_EQ(stats.batches, frames + sessions);
+            EXPECT_GT(stats.realtime_factor, 0.0);
+        }
+    }
+}
+
+TEST(SessionPoolTest, SessionLifecycle) {
+    aec::AECSessionPool pool(session_config(true), 2);
+    EXPECT_EQ(pool.max_sessions(), 2u);
+    EXPECT_EQ(pool.open_session(), 0);
+    EXPECT_EQ(pool.open_session(), 1);
+    EXPECT_EQ(pool.open_session(), -1);
+    EXPECT_EQ(pool.active_sessions(), 2u);
+
+    std::vector<int16_t> far, near, out(160), first(160);
+    make_call(3, 160, far, near);
+    aec::SessionFrame frame{1, far.data(), near.data(), first.data()};
+    ASSERT_TRUE(pool.process(&frame, 1));
+
+    // Repeated and closed sessions are rejected
+    aec::SessionFrame twice[2] = {{0, far.data(), near.data(), out.data()}, {0, far.data(), near.data(), out.data()}};
+    EXPECT_FALSE(pool.process(twice, 2));
+    pool.close_session(1);
+    EXPECT_FALSE(pool.process(&frame, 1));
+    EXPECT_EQ(pool.active_sessions(), 1u);
+
+    // A reopened session starts from scratch
+    EXPECT_EQ(pool.open_session(), 1);
+    EXPECT_EQ(pool.session_stats(1).frames, 0u);
+    frame.output = out.data();
+    ASSERT_TRUE(pool.process(&frame, 1));
+    EXPECT_EQ(out, first);
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "aec/simd_kernels.hpp"
+#include <vector>
+#include <random>
+#include <cstring>
+#include <cmath>
+
+static const char* kKernelNames[] = {"sse4.1", "avx2", "avx512", "neon"};
+
+TEST(SimdKernelsTest, ActiveKernelIsNamed) {
+    const char* name = aec::simd::active_kernel_name();
+    ASSERT_NE(name, nullptr);
+    EXPECT_EQ(aec::simd::find_kernels(name), &aec::simd::kernels());
+    EXPECT_EQ(aec::simd::find_kernels("no-such-isa"), nullptr);
+}
+
+TEST(SimdKernelsTest, Q15KernelsBitExactWithScalar) {
+    const aec::simd::Kernels& ref = aec::simd::scalar_kernels();
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    // Odd length exercises the scalar tails; extreme values the wrap/saturation
+    const size_t n = 1031;
+    std::vector<int16_t> a(n), b(n), w(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = static_cast<int16_t>(dist(gen));
+        b[i] = static_cast<int16_t>(dist(gen));
+        w[i] = static_cast<int16_t>(dist(gen));
+    }
+    a[0] = b[0] = -32768;
+
+    for (const char* name : kKernelNames) {
+        const aec::simd::Kernels* k = aec::simd::find_kernels(name);
+        if (!k) continue;
+        SCOPED_TRACE(name);
+        EXPECT_EQ(k->dot_q15(a.data(), b.data(), n), ref.dot_q15(a.data(), b.data(), n));
+
+        std::vector<int16_t> w_ref = w, w_simd = w;
+        ref.update_q15(w_ref.data(), a.data(), -32768, 12345, n);
+        k->update_q15(w_simd.data(), a.data(), -32768, 12345, n);
+        EXPECT_EQ(w_simd, w_ref);
+        ref.update_q15(w_ref.data(), b.data(), 20000, -32768, n);
+        k->update_q15(w_simd.data(), b.data(), 20000, -32768, n);
+        EXPECT_EQ(w_simd, w_ref);
+    }
+}
+
+TEST(SimdKernelsTest, FloatKernelsMatchScalar) {
+    const aec::simd::Kernels& ref = aec::simd::scalar_kernels();
+    const size_t n = 517;
+    std::vector<float> a(n), b(n), y(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = std::sin(0.01f * i);
+        b[i] = std::cos(0.02f * i);
+        y[i] = 0.001f * static_cast<float>(i);
+    }
+    for (const char* name : kKernelNames) {
+        const aec::simd::Kernels* k = aec::simd::find_kernels(name);
+        if (!k) continue;
+        SCOPED_TRACE(name);
+        EXPECT_NEAR(k->dot_f32(a.data(), b.data(), n), ref.dot_f32(a.data(), b.data(), n), 1e-3f);
+
+        std::vector<float> y_ref = y, y_simd = y;
+        ref.axpy_f32(0.25f, a.data(), y_ref.data(), n);
+        k->axpy_f32(0.25f, a.data(), y_simd.data(), n);
+        for (size_t i = 0; i < n; ++i) EXPECT_NEAR(y_simd[i], y_ref[i], 1e-6f);
+
+        EXPECT_NEAR(k->abs_sum_f32(a.data(), n), ref.abs_sum_f32(a.data(), n), 1e-3f);
+        std::vector<float> g_ref(n), g_simd(n);
+        float p_ref = ref.gain_f32(g_ref.data(), a.data(), b.data(), 0.01f, 0.5f, n);
+        float p_simd = k->gain_f32(g_simd.data(), a.data(), b.data(), 0.01f, 0.5f, n);
+        EXPECT_NEAR(p_simd, p_ref, 1e-3f);
+        for (size_t i = 0; i < n; ++i) EXPECT_NEAR(g_simd[i], g_ref[i], 1e-6f);
+    }
+}
+
+TEST(SimdKernelsTest, ButterflyMatchesScalar) {
+    const aec::simd::Kernels& ref = aec::simd::scalar_kernels();
+    // Spans below, at and above every vector width, plus odd ones for the tails
+    const size_t spans[] = {1, 2, 3, 4, 8, 16, 17, 64};
+    for (const char* name : kKernelNames) {
+        const aec::simd::Kernels* k = aec::simd::find_kernels(name);
+        if (!k) continue;
+        SCOPED_TRACE(name);
+        for (size_t h : spans) {
+            const size_t groups = 256 / (2 * h) + 1;
+            std::vector<float> w(2 * h), data(4 * h * groups);
+            for (size_t i = 0; i < h; ++i) {
+                w[2 * i] = std::cos(0.1f * static_cast<float>(i));
+                w[2 * i + 1] = -std::sin(0.1f * static_cast<float>(i));
+            }
+            for (size_t i = 0; i < data.size(); ++i) data[i] = std::sin(0.37f * static_cast<float>(i));
+            std::vector<float> d_ref = data, d_simd = data;
+            ref.butterfly_c32(d_ref.data(), w.data(), h, groups);
+            k->butterfly_c32(d_simd.data(), w.data(), h, groups);
+            for (size_t i = 0; i < data.size(); ++i) EXPECT_NEAR(d_simd[i], d_ref[i], 1e-5f);
+        }
+    }
+}
+
+TEST(SimdKernelsTest, DoubleButterflyMatchesScalarExactly) {
+    const aec::simd::Kernels& ref = aec::simd::scalar_kernels();
+    const size_t spans[] = {1, 2, 3, 4, 5, 8, 64};
+    for (const char* name : kKernelNames) {
+        const aec::simd::Kernels* k = aec::simd::find_kernels(name);
+        if (!k) continue;
+        SCOPED_TRACE(name);
+        for (size_t h : spans) {
+            const size_t groups = 256 / (2 * h) + 1;
+            std::vector<double> w(2 * h), data(4 * h * groups);
+            for (size_t i = 0; i < h; ++i) {
+                w[2 * i] = std::cos(0.1 * static_cast<double>(i));
+                w[2 * i + 1] = -std::sin(0.1 * static_cast<double>(i));
+            }
+            for (size_t i = 0; i < data.size(); ++i) data[i] = std::sin(0.37 * static_cast<double>(i));
+            std::vector<double> d_ref = data;
+            ref.butterfly_c64(d_ref.data(), w.data(), h, groups);
+            k->butterfly_c64(data.data(), w.data(), h, groups);
+            EXPECT_EQ(data, d_ref) << h;
+        }
+    }
+}
+
+TEST(SimdKernelsTest, BatchButterflyMatchesScalarExactly) {
+    const aec::simd::Kernels& ref = aec::simd::scalar_kernels();
+    const size_t spans[] = {1, 2, 4, 16};
+    const size_t counts[] = {1, 2, 3, 4, 8, 9, 17};
+    for (const char* name : kKernelNames) {
+        const aec::simd::Kernels* k = aec::simd::find_kernels(name);
+        if (!k) continue;
+        SCOPED_TRACE(name);
+        for (size_t h : spans) {
+            for (size_t count : counts) {
+                const size_t groups = 64 / (2 * h);
+                std::vector<double> w(2 * h), re(2 * h * groups * count), im(re.size());
+                for (size_t i = 0; i < h; ++i) {
+                    w[2 * i] = std::cos(0.1 * static_cast<double>(i));
+                    w[2 * i + 1] = -std::sin(0.1 * static_cast<double>(i));
+                }
+                for (size_t i = 0; i < re.size(); ++i) {
+                    re[i] = std::sin(0.37 * static_cast<double>(i));
+                    im[i] = std::cos(0.11 * static_cast<double>(i));
+                }
+                std::vector<double> re_ref = re, im_ref = im;
+                ref.butterfly_batch_f64(re_ref.data(), im_ref.data(), w.data(), h, groups, count);
+                k->butterfly_batch_f64(re.data(), im.data(), w.data(), h, groups, count);
+                EXPECT_EQ(re, re_ref);
+                EXPECT_EQ(im, im_ref);
+            }
+        }
+    }
+}
+
+TEST(SimdKernelsTest, SubbandRowKernelsMatchScalar) {
+    const aec::simd::Kernels& ref = aec::simd::scalar_kernels();
+    // Lane counts below, at and above every vector width
+    const size_t lane_counts[] = {1, 3, 4, 8, 13, 16, 33, 40};
+    const size_t rows = 9;
+    for (const char* name : kKernelNames) {
+        const aec::simd::Kernels* k = aec::simd::find_kernels(name);
+        if (!k) continue;
+        SCOPED_TRACE(name);
+        for (size_t lanes : lane_counts) {
+            std::vector<float> w_re(lanes * rows), w_im(w_re.size()), x_re(w_re.size()), x_im(w_re.size());
+            for (size_t i = 0; i < w_re.size(); ++i) {
+                w_re[i] = std::sin(0.37f * static_cast<float>(i));
+                w_im[i] = std::cos(0.11f * static_cast<float>(i));
+                x_re[i] = std::cos(0.23f * static_cast<float>(i));
+                x_im[i] = std::sin(0.05f * static_cast<float>(i));
+            }
+            std::vector<float> a(lanes), b(lanes), y_re(lanes), y_im(lanes);
+            for (size_t i = 0; i < lanes; ++i) {
+                a[i] = 0.01f * static_cast<float>(i);
+                b[i] = -0.02f * static_cast<float>(i);
+                y_re[i] = 0.5f;
+                y_im[i] = -0.5f;
+            }
+            std::vector<float> yr_ref = y_re, yi_ref = y_im;
+            ref.cmac_rows_f32(yr_ref.data(), yi_ref.data(), w_re.data(), w_im.data(), x_re.data(), x_im.data(),
+                              lanes, rows);
+            k->cmac_rows_f32(y_re.data(), y_im.data(), w_re.data(), w_im.data(), x_re.data(), x_im.data(), lanes,
+                             rows);
+            for (size_t i = 0; i < lanes; ++i) {
+                EXPECT_NEAR(y_re[i], yr_ref[i], 1e-5f);
+                EXPECT_NEAR(y_im[i], yi_ref[i], 1e-5f);
+            }
+
+            std::vector<float> wr_ref = w_re, wi_ref = w_im;
+            ref.cupdate_rows_f32(wr_ref.data(), wi_ref.data(), a.data(), b.data(), x_re.data(), x_im.data(), lanes,
+                                 rows);
+            k->cupdate_rows_f32(w_re.data(), w_im.data(), a.data(), b.data(), x_re.data(), x_im.data(), lanes, rows);
+            for (size_t i = 0; i < w_re.size(); ++i) {
+                EXPECT_NEAR(w_re[i], wr_ref[i], 1e-6f);
+                EXPECT_NEAR(w_im[i], wi_ref[i], 1e-6f);
+            }
+        }
+    }
+}
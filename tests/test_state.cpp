@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/state_io.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+
+// Far-end noise through a decaying echo path `delay` samples late, with
+// near-end talk in every third second; `ch` interleaved channels, each with
+// its own far-end
+static void make_echo(uint32_t samples, uint32_t ch, uint32_t rate, uint32_t delay,
+                      std::vector<int16_t>& far, std::vector<int16_t>& near) {
+    std::mt19937 gen(17);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(64);
+    for (size_t i = 0; i < h.size(); ++i) h[i] = 0.4f * dist(gen) * std::exp(-static_cast<float>(i) / 12.0f);
+    far.resize(static_cast<size_t>(samples) * ch);
+    near.resize(far.size());
+    for (size_t i = 0; i < far.size(); ++i) far[i] = static_cast<int16_t>(3000.0f * dist(gen));
+    for (uint32_t t = 0; t < samples; ++t) {
+        const bool talk = (t / rate) % 3 == 2;
+        for (uint32_t c = 0; c < ch; ++c) {
+            float y = talk ? 1500.0f * dist(gen) : 0.0f;
+            for (uint32_t j = 0; j < h.size() && j + delay <= t; ++j) {
+                y += h[j] * far[static_cast<size_t>(t - delay - j) * ch + c];
+            }
+            near[static_cast<size_t>(t) * ch + c] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, y)));
+        }
+    }
+}
+
+// Frames [from, to) of the signals through `aec`; the output of each frame
+// is appended to `out` when given
+static void run_frames(aec::AEC& aec, const aec::AECConfig& config, const std::vector<int16_t>& far,
+                       const std::vector<int16_t>& near, uint32_t from, uint32_t to,
+                       std::vector<int16_t>* out = nullptr) {
+    const size_t frame = static_cast<size_t>(config.frame_size) * config.channels;
+    std::vector<int16_t> buffer(frame);
+    for (uint32_t f = from; f < to; ++f) {
+        ASSERT_TRUE(aec.process(&far[f * frame], &near[f * frame], buffer.data(), config.frame_size,
+                                config.channels));
+        if (out) out->insert(out->end(), buffer.begin(), buffer.end());
+    }
+}
+
+// Saves after two seconds; a new instance restored from the snapshot then
+// gives the same output as the original for the next second, and ends in
+// the same state
+static void expect_bit_exact_restore(const aec::AECConfig& config, uint32_t delay = 0) {
+    SCOPED_TRACE(testing::Message() << "algorithm " << static_cast<int>(config.algorithm) << ", "
+                                    << config.filter_length << " taps, fixed " << config.use_fixed_point);
+    std::vector<int16_t> far, near;
+    make_echo(3 * config.sample_rate, config.channels, config.sample_rate, delay, far, near);
+    const uint32_t frames = 3 * config.sample_rate / config.frame_size;
+    const uint32_t split = 2 * frames / 3;
+
+    aec::AEC original(config);
+    run_frames(original, config, far, near, 0, split);
+    std::vector<uint8_t> snapshot;
+    ASSERT_TRUE(original.save_state(snapshot));
+    EXPECT_EQ(snapshot.size(), original.state_size());
+
+    aec::AEC restored(config);
+    ASSERT_TRUE(restored.load_state(snapshot.data(), snapshot.size()));
+    std::vector<int16_t> expected, actual;
+    run_frames(original, config, far, near, split, frames, &expected);
+    run_frames(restored, config, far, near, split, frames, &actual);
+    EXPECT_EQ(actual, expected);
+    // Down to state that has not reached the output yet
+    std::vector<uint8_t> original_after, restored_after;
+    ASSERT_TRUE(original.save_state(original_after));
+    ASSERT_TRUE(restored.save_state(restored_after));
+    EXPECT_TRUE(original_after == restored_after);
+
+    const aec::AECMetrics a = original.get_metrics(), b = restored.get_metrics();
+    EXPECT_EQ(a.erle_db, b.erle_db);
+    EXPECT_EQ(a.channel[0].echo_frames, b.channel[0].echo_frames);
+    EXPECT_EQ(original.get_applied_delay(), restored.get_applied_delay());
+    if (delay > 0) {
+        EXPECT_GT(restored.get_applied_delay(), 0u);
+    }
+    EXPECT_EQ(original.get_estimated_delay(), restored.get_estimated_delay());
+}
+
+static aec::AECConfig base_config() {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.mu = 0.3f;
+    return config;
+}
+
+TEST(StateTest, NLMSRestoresBitExact) {
+    for (uint32_t taps : {256u, 300u}) {
+        for (bool fixed : {true, false}) {
+            aec::AECConfig config = base_config();
+            config.filter_length = taps;
+            config.use_fixed_point = fixed;
+            config.mu = fixed ? 0.05f : 0.3f;
+            expect_bit_exact_restore(config);
+        }
+    }
+}
+
+TEST(StateTest, OtherEnginesRestoreBitExact) {
+    aec::AECConfig config = base_config();
+    config.use_fixed_point = false;
+    config.algorithm = aec::Algorithm::PBFDAF;
+    expect_bit_exact_restore(config);
+    config.algorithm = aec::Algorithm::APA;
+    expect_bit_exact_restore(config);
+    config.algorithm = aec::Algorithm::IPNLMS;
+    config.sparse_tap_skipping = true;
+    config.sparse_recheck_interval = 3000;
+    expect_bit_exact_restore(config);
+    config.algorithm = aec::Algorithm::RLS;
+    config.filter_length = 64;
+    expect_bit_exact_restore(config);
+}
+
+TEST(StateTest, SubbandEngineRestoresBitExact) {
+    aec::AECConfig config = base_config();
+    config.sample_rate = 48000;
+    config.frame_size = 480;
+    config.filter_length = 1024;
+    expect_bit_exact_restore(config);
+}
+
+TEST(StateTest, DelayCompensationAndSuppressionRestoreBitExact) {
+    // Two channels with the tiered detector, the residual echo suppressor
+    // and the far-end delayed by 1000 samples
+    aec::AECConfig config = base_config();
+    config.channels = 2;
+    config.use_fixed_point = false;
+    config.enable_delay_estimation = true;
+    config.max_delay_ms = 100;
+    config.delay_headroom = 32;
+    config.dtd_tiered = true;
+    config.enable_residual_echo_suppression = true;
+    expect_bit_exact_restore(config, 1000);
+}
+
+TEST(StateTest, WarmStartSkipsConvergence) {
+    aec::AECConfig config = base_config();
+    config.use_fixed_point = false;
+    config.mu = 0.1f;
+    std::vector<int16_t> far, near;
+    make_echo(3 * config.sample_rate, 1, config.sample_rate, 0, far, near);
+    aec::AEC trained(config);
+    run_frames(trained, config, far, near, 0, 200);
+    std::vector<uint8_t> snapshot;
+    ASSERT_TRUE(trained.save_state(snapshot));
+
+    // The first quarter second of a new call, echo only
+    aec::AEC cold(config), warm(config);
+    ASSERT_TRUE(warm.load_state(snapshot.data(), snapshot.size()));
+    std::vector<int16_t> cold_out, warm_out;
+    run_frames(cold, config, far, near, 0, 25, &cold_out);
+    run_frames(warm, config, far, near, 0, 25, &warm_out);
+    double near_pow = 0.0, cold_pow = 0.0, warm_pow = 0.0;
+    for (size_t i = 0; i < cold_out.size(); ++i) {
+        near_pow += static_cast<double>(near[i]) * near[i];
+        cold_pow += static_cast<double>(cold_out[i]) * cold_out[i];
+        warm_pow += static_cast<double>(warm_out[i]) * warm_out[i];
+    }
+    const double cold_erle = 10.0 * std::log10(near_pow / (cold_pow + 1.0));
+    const double warm_erle = 10.0 * std::log10(near_pow / (warm_pow + 1.0));
+    EXPECT_GT(warm_erle, cold_erle + 10.0);
+}
+
+TEST(StateTest, RejectsOtherConfigurations) {
+    aec::AECConfig config = base_config();
+    config.channels = 2;
+    std::vector<int16_t> far, near;
+    make_echo(config.sample_rate, config.channels, config.sample_rate, 0, far, near);
+    aec::AEC original(config);
+    run_frames(original, config, far, near, 0, 50);
+    std::vector<uint8_t> snapshot;
+    ASSERT_TRUE(original.save_state(snapshot));
+
+    aec::AECConfig other = config;
+    other.filter_length = 512;
+    EXPECT_FALSE(aec::AEC(other).load_state(snapshot.data(), snapshot.size()));
+    other = config;
+    other.mu = 0.2f;
+    EXPECT_FALSE(aec::AEC(other).load_state(snapshot.data(), snapshot.size()));
+    other = config;
+    other.use_fixed_point = false;
+    EXPECT_FALSE(aec::AEC(other).load_state(snapshot.data(), snapshot.size()));
+    other = config;
+    other.enable_residual_echo_suppression = true;
+    EXPECT_FALSE(aec::AEC(other).load_state(snapshot.data(), snapshot.size()));
+
+    // A rejected snapshot leaves the instance as it was
+    other = config;
+    other.channels = 1;
+    aec::AEC mono(other);
+    run_frames(mono, other, far, near, 0, 10);
+    const uint64_t frames = mono.get_metrics().channel[0].echo_frames;
+    EXPECT_FALSE(mono.load_state(snapshot.data(), snapshot.size()));
+    EXPECT_EQ(mono.get_metrics().channel[0].echo_frames, frames);
+
+    // Threads do not change the state
+    other = config;
+    other.worker_threads = 1;
+    EXPECT_TRUE(aec::AEC(other).load_state(snapshot.data(), snapshot.size()));
+}
+
+TEST(StateTest, RejectsDamagedSnapshots) {
+    aec::AECConfig config = base_config();
+    aec::AEC original(config);
+    std::vector<int16_t> far, near;
+    make_echo(config.sample_rate, 1, config.sample_rate, 0, far, near);
+    run_frames(original, config, far, near, 0, 20);
+    std::vector<uint8_t> snapshot;
+    ASSERT_TRUE(original.save_state(snapshot));
+
+    std::vector<uint8_t> small(snapshot.size() - 1);
+    EXPECT_FALSE(original.save_state(small.data(), small.size()));
+
+    aec::AEC restored(config);
+    EXPECT_FALSE(restored.load_state(snapshot.data(), snapshot.size() - 1));
+    EXPECT_FALSE(restored.load_state(snapshot.data(), 0));
+    std::vector<uint8_t> damaged = snapshot;
+    damaged[0] ^= 0xff; // magic
+    EXPECT_FALSE(restored.load_state(damaged.data(), damaged.size()));
+    damaged = snapshot;
+    damaged[4] += 1; // version
+    EXPECT_FALSE(restored.load_state(damaged.data(), damaged.size()));
+
+    // Trailing bytes, as in a mapping rounded up to whole pages, are fine
+    std::vector<uint8_t> padded = snapshot;
+    padded.resize(4096 * ((snapshot.size() + 4095) / 4096), 0);
+    EXPECT_TRUE(restored.load_state(padded.data(), padded.size()));
+    std::vector<uint8_t> again;
+    ASSERT_TRUE(restored.save_state(again));
+    EXPECT_EQ(again, snapshot);
+}
+
+TEST(StateTest, RejectsFlagsOtherThanZeroOrOne) {
+    // Flags such as the detectors' are a byte each; a mapped snapshot with
+    // anything else there is damaged, not a bool
+    std::vector<uint8_t> data(2);
+    aec::StateWriter out(data.data(), data.size());
+    out.put(true);
+    out.put(false);
+    ASSERT_TRUE(out.ok());
+    EXPECT_EQ(out.size(), 2u);
+
+    bool first = false, second = true;
+    aec::StateReader in(data.data(), data.size());
+    EXPECT_TRUE(in.get(first) && in.get(second));
+    EXPECT_TRUE(first);
+    EXPECT_FALSE(second);
+
+    data[1] = 2;
+    aec::StateReader damaged(data.data(), data.size());
+    EXPECT_TRUE(damaged.get(first));
+    EXPECT_FALSE(damaged.get(second));
+    EXPECT_FALSE(damaged.ok());
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "aec/subband_filter.hpp"
+#include "aec/aec.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+
+// Coloured far-end noise at 48 kHz through a decaying echo path with 200
+// samples of bulk delay; returns ERLE (dB) over the last second
+static double run_subband(aec::SubbandFilter& filter, const std::vector<float>& h, uint32_t block, int seconds) {
+    const uint32_t sr = 48000;
+    std::mt19937 gen(3);
+    std::normal_distribution<float> dist(0.0f, 0.03f);
+    std::vector<float> history(h.size(), 0.0f);
+    std::vector<float> far(block), near(block), out(block);
+    double near_pow = 0.0, out_pow = 0.0;
+    float ar = 0.0f;
+    const uint32_t total = sr * seconds;
+    for (uint32_t n = 0; n + block <= total; n += block) {
+        for (uint32_t i = 0; i < block; ++i) {
+            ar = 0.9f * ar + dist(gen);
+            far[i] = ar;
+            history.insert(history.begin(), far[i]);
+            history.pop_back();
+            float y = 0.0f;
+            for (size_t j = 0; j < h.size(); ++j) y += h[j] * history[j];
+            near[i] = y;
+        }
+        EXPECT_TRUE(filter.process_block(far.data(), near.data(), out.data(), block, 1, true));
+        if (n >= total - sr) {
+            for (uint32_t i = 0; i < block; ++i) {
+                near_pow += near[i] * near[i];
+                out_pow += out[i] * out[i];
+            }
+        }
+    }
+    return 10.0 * std::log10(near_pow / (out_pow + 1e-20));
+}
+
+static std::vector<float> echo_path(uint32_t length) {
+    std::mt19937 gen(11);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> h(length, 0.0f);
+    for (uint32_t i = 200; i < length; ++i) h[i] = 0.3f * dist(gen) * std::exp(-static_cast<float>(i - 200) / 300.0f);
+    return h;
+}
+
+TEST(SubbandTest, Geometry) {
+    aec::SubbandFilter filter(2048, 64, 0.5f, 1e-6f);
+    EXPECT_EQ(filter.bands(), 64u);
+    EXPECT_EQ(filter.decimation(), 32u);
+    EXPECT_EQ(filter.taps_per_band(), 2048u / 32 + 8);
+    EXPECT_EQ(filter.latency(), 256u);
+    // Unsupported band counts fall back to 64
+    EXPECT_EQ(aec::SubbandFilter(2048, 48, 0.5f, 1e-6f).bands(), 64u);
+}
+
+TEST(SubbandTest, ReconstructsNearEndWithoutEcho) {
+    // Zero coefficients: the output is the near-end through analysis and
+    // synthesis, delayed by latency()
+    aec::SubbandFilter filter(512, 32, 0.5f, 1e-6f);
+    std::mt19937 gen(5);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    std::vector<float> near(24000), far(near.size(), 0.0f), out(near.size());
+    for (float& v : near) v = dist(gen);
+    ASSERT_TRUE(filter.process_block(far.data(), near.data(), out.data(), near.size(), 1, false));
+    const uint32_t lag = filter.latency();
+    double signal = 0.0, error = 0.0;
+    for (size_t i = lag; i < near.size(); ++i) {
+        signal += near[i - lag] * near[i - lag];
+        error += (out[i] - near[i - lag]) * (out[i] - near[i - lag]);
+    }
+    EXPECT_GT(10.0 * std::log10(signal / error), 40.0);
+}
+
+TEST(SubbandTest, ConvergesOnWidebandEchoPath) {
+    const std::vector<float> h = echo_path(2048);
+    aec::SubbandFilter filter(2048, 64, 0.5f, 1e-6f);
+    EXPECT_GT(run_subband(filter, h, 480, 4), 30.0);
+    double norm = 0.0;
+    for (float v : h) norm += v * v;
+    EXPECT_NEAR(filter.get_coeff_norm(), std::sqrt(norm), 0.2 * std::sqrt(norm));
+}
+
+TEST(SubbandTest, OutputDoesNotDependOnBlockSize) {
+    const std::vector<float> h = echo_path(512);
+    aec::SubbandFilter a(512, 32, 0.5f, 1e-6f);
+    aec::SubbandFilter b(512, 32, 0.5f, 1e-6f);
+    std::mt19937 gen(9);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    std::vector<float> far(4800), near(far.size()), out_a(far.size()), out_b(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = dist(gen);
+        near[i] = 0.5f * (i >= 3 ? far[i - 3] : 0.0f);
+    }
+    ASSERT_TRUE(a.process_block(far.data(), near.data(), out_a.data(), far.size(), 1, true));
+    for (size_t off = 0; off < far.size(); off += 7) {
+        const size_t n = std::min<size_t>(7, far.size() - off);
+        ASSERT_TRUE(b.process_block(&far[off], &near[off], &out_b[off], n, 1, true));
+    }
+    EXPECT_EQ(out_a, out_b);
+}
+
+TEST(SubbandTest, AECSelectsSubbandsBySampleRate) {
+    // A near-end click with a silent far-end comes out after the filterbank
+    // delay in subband mode and at once in fullband mode
+    auto click_position = [](uint32_t sample_rate, uint32_t subbands) {
+        aec::AECConfig config;
+        config.sample_rate = sample_rate;
+        config.subband_count = subbands;
+        config.frame_size = 480;
+        config.filter_length = 1024;
+        config.enable_double_talk_detection = false;
+        aec::AEC aec(config);
+        std::vector<int16_t> far(960, 0), near(960, 0), out(960);
+        near[10] = 16000;
+        for (uint32_t off = 0; off < 960; off += 480) {
+            EXPECT_TRUE(aec.process(&far[off], &near[off], &out[off], 480));
+        }
+        size_t peak = 0;
+        for (size_t i = 1; i < out.size(); ++i) {
+            if (std::abs(out[i]) > std::abs(out[peak])) peak = i;
+        }
+        return peak;
+    };
+    EXPECT_EQ(click_position(16000, 64), 10u);
+    EXPECT_EQ(click_position(48000, 64), 10u + 256);
+    EXPECT_EQ(click_position(32000, 32), 10u + 128);
+    EXPECT_EQ(click_position(48000, 0), 10u);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/timing.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(TimingTest, BucketsAreLogSpaced) {
+    for (uint32_t b = 0; b + 1 < aec::kTimingBuckets; ++b) {
+        const uint64_t floor = aec::timing_bucket_floor(b);
+        const uint64_t next = aec::timing_bucket_floor(b + 1);
+        ASSERT_LT(floor, next);
+        EXPECT_EQ(aec::TimingRecorder::bucket(floor), b);
+        EXPECT_EQ(aec::TimingRecorder::bucket(next - 1), b);
+        // Four buckets per octave: each at most 25% wider than its floor
+        if (b >= 4) {
+            EXPECT_LE(next - floor, floor / 4 + 1);
+        }
+    }
+    EXPECT_EQ(aec::TimingRecorder::bucket(UINT64_MAX), aec::kTimingBuckets - 1);
+}
+
+TEST(TimingTest, PercentilesAndMax) {
+    aec::TimingRecorder recorder;
+    for (int i = 0; i < 98; ++i) recorder.record(aec::Stage::Filter, 1000);
+    recorder.record(aec::Stage::Filter, 50000);
+    recorder.record(aec::Stage::Filter, 70000);
+
+    const aec::TimingStats stats = recorder.snapshot();
+    const aec::StageTiming& t = stats.stage(aec::Stage::Filter);
+    EXPECT_EQ(t.count, 100u);
+    EXPECT_EQ(t.total_ns, 98u * 1000 + 50000 + 70000);
+    EXPECT_GE(t.p50_ns, 1000u);
+    EXPECT_LT(t.p50_ns, 1250u);
+    EXPECT_GE(t.p99_ns, 50000u);
+    EXPECT_LT(t.p99_ns, 62500u);
+    EXPECT_EQ(t.max_ns, 70000u);
+    EXPECT_EQ(stats.stage(aec::Stage::DoubleTalk).count, 0u);
+}
+
+TEST(TimingTest, OverrunsAndReset) {
+    aec::TimingRecorder recorder;
+    recorder.record_frame(9000000, 10000000);
+    recorder.record_frame(13000000, 10000000);
+    recorder.record_frame(11000000, 10000000);
+    aec::TimingStats stats = recorder.snapshot();
+    EXPECT_EQ(stats.frames, 3u);
+    EXPECT_EQ(stats.overruns, 2u);
+    EXPECT_EQ(stats.worst_overrun_ns, 3000000u);
+
+    // Reads as cleared at once; the recording side clears at its next sync
+    recorder.reset();
+    EXPECT_EQ(recorder.snapshot().frames, 0u);
+    recorder.sync();
+    recorder.record_frame(1000, 10000000);
+    stats = recorder.snapshot();
+    EXPECT_EQ(stats.frames, 1u);
+    EXPECT_EQ(stats.overruns, 0u);
+    EXPECT_EQ(stats.stage(aec::Stage::Frame).max_ns, 1000u);
+}
+
+TEST(TimingTest, ProcessRecordsEveryStage) {
+#if !defined(AEC_ENABLE_TIMING)
+    GTEST_SKIP() << "built without AEC_ENABLE_TIMING";
+#endif
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.channels = 2;
+    config.enable_delay_estimation = true;
+    aec::AEC aec(config);
+    std::vector<int16_t> far(320), near(320), out(320);
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>((i * 7919) % 4000) - 2000;
+        near[i] = static_cast<int16_t>(far[i] / 2);
+    }
+
+    // A monitoring thread reads and resets while frames are processed
+    std::atomic<bool> done{false};
+    std::thread monitor([&] {
+        while (!done.load()) {
+            aec::TimingStats stats = aec.get_timing();
+            EXPECT_LE(stats.stage(aec::Stage::Frame).p50_ns, stats.stage(aec::Stage::Frame).max_ns);
+            if (stats.frames > 20) aec.reset_timing();
+        }
+    });
+    for (int i = 0; i < 200; ++i) ASSERT_TRUE(aec.process(far.data(), near.data(), out.data(), 160, 2));
+    done.store(true);
+    monitor.join();
+
+    aec.reset_timing();
+    EXPECT_EQ(aec.get_timing().frames, 0u);
+    for (int i = 0; i < 10; ++i) ASSERT_TRUE(aec.process(far.data(), near.data(), out.data(), 160, 2));
+    aec::TimingStats stats = aec.get_timing();
+    EXPECT_EQ(stats.frames, 10u);
+    for (aec::Stage stage : {aec::Stage::Convert, aec::Stage::Delay, aec::Stage::DoubleTalk,
+                             aec::Stage::Filter, aec::Stage::Frame}) {
+        const aec::StageTiming& t = stats.stage(stage);
+        SCOPED_TRACE(static_cast<int>(stage));
+        EXPECT_EQ(t.count, 10u);
+        EXPECT_GT(t.max_ns, 0u);
+        EXPECT_LE(t.p50_ns, t.p99_ns);
+        EXPECT_LE(t.p99_ns, t.max_ns);
+    }
+    // The filters are part of the frame
+    EXPECT_LE(stats.stage(aec::Stage::Filter).total_ns, stats.stage(aec::Stage::Frame).total_ns);
+}
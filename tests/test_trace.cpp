@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/trace.hpp"
+#include "aec/webrtc_adapter.h"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static size_t count(const std::string& s, const std::string& what) {
+    size_t n = 0;
+    for (size_t pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) ++n;
+    return n;
+}
+
+TEST(TraceTest, ScopesExportAsChromeJson) {
+    aec::trace::clear();
+    std::thread([] {
+        aec::trace::register_thread("trace \"test\"");
+        for (int i = 0; i < 3; ++i) {
+            aec::trace::Scope outer("outer");
+            aec::trace::Scope inner("inner");
+        }
+    }).join();
+    EXPECT_EQ(aec::trace::event_count(), 6u);
+
+    const std::string path = ::testing::TempDir() + "aec_trace_scopes.json";
+    ASSERT_TRUE(aec::trace::write_chrome_json(path.c_str()));
+    const std::string json = read_file(path);
+    ASSERT_FALSE(json.empty());
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+    EXPECT_EQ(count(json, "\"name\":\"outer\",\"ph\":\"X\""), 3u);
+    EXPECT_EQ(count(json, "\"name\":\"inner\",\"ph\":\"X\""), 3u);
+    // Thread names are escaped
+    EXPECT_EQ(count(json, "\"args\":{\"name\":\"trace \\\"test\\\"\"}"), 1u);
+
+    aec::trace::clear();
+    EXPECT_EQ(aec::trace::event_count(), 0u);
+    EXPECT_FALSE(aec::trace::write_chrome_json(""));
+}
+
+TEST(TraceTest, RingKeepsNewestEvents) {
+    aec::trace::clear();
+    std::thread([] {
+        for (int i = 0; i < 10; ++i) aec::trace::record("old", i, i + 1);
+        for (uint32_t i = 0; i < aec::trace::kRingEvents; ++i) aec::trace::record("new", 100 + i, 101 + i);
+    }).join();
+    EXPECT_EQ(aec::trace::event_count(), aec::trace::kRingEvents);
+
+    const std::string path = ::testing::TempDir() + "aec_trace_ring.json";
+    ASSERT_TRUE(aec::trace::write_chrome_json(path.c_str()));
+    const std::string json = read_file(path);
+    EXPECT_EQ(count(json, "\"name\":\"old\""), 0u);
+    EXPECT_EQ(count(json, "\"name\":\"new\""), aec::trace::kRingEvents);
+    // Times are relative to the earliest event kept
+    EXPECT_EQ(count(json, "\"ts\":0.000,\"dur\":0.001}"), 1u);
+    aec::trace::clear();
+}
+
+TEST(TraceTest, ProcessEmitsTracePoints) {
+    aec::AECConfig config;
+    config.frame_size = 160;
+    config.filter_length = 256;
+    config.channels = 2;
+    config.worker_threads = 1;
+    std::vector<int16_t> far(320), near(320), out(320);
+    for (size_t i = 0; i < far.size(); ++i) {
+        far[i] = static_cast<int16_t>((i * 7919) % 4000) - 2000;
+        near[i] = static_cast<int16_t>(far[i] / 2);
+    }
+
+    aec::trace::clear();
+    {
+        aec::AEC aec(config);
+        for (int i = 0; i < 5; ++i) ASSERT_TRUE(aec.process(far.data(), near.data(), out.data(), 160, 2));
+    }
+    aec::webrtc::WebRTCAecAdapter adapter;
+    ASSERT_TRUE(adapter.Init(aec::AECConfig{}, 16000));
+    adapter.ProcessRender(far.data());
+    ASSERT_TRUE(adapter.ProcessCapture(near.data()));
+
+#if defined(AEC_ENABLE_TRACING)
+    const std::string path = ::testing::TempDir() + "aec_trace_process.json";
+    ASSERT_TRUE(aec::trace::write_chrome_json(path.c_str()));
+    const std::string json = read_file(path);
+    EXPECT_EQ(count(json, "\"name\":\"AEC::process\""), 6u);
+    // One channel ran on the worker, whose events outlive it
+    EXPECT_EQ(count(json, "\"name\":\"AEC::channel\""), 11u);
+    EXPECT_EQ(count(json, "\"args\":{\"name\":\"aec worker 1\"}"), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"MultiChannelDoubleTalkDetector::update\""), 6u);
+    EXPECT_GT(count(json, "\"name\":\"NLMSFilter::process_block\""), 0u);
+    EXPECT_EQ(count(json, "\"name\":\"WebRTCAecAdapter::ProcessRender\""), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"WebRTCAecAdapter::ProcessCapture\""), 1u);
+    aec::trace::clear();
+#else
+    // Compiled out: the hot path records nothing
+    EXPECT_EQ(aec::trace::event_count(), 0u);
+#endif
+}
+
+TEST(TraceTest, ExportWhileRingWrapsDropsTornEvents) {
+    // Each lap of the ring writes its own name and duration; an event put
+    // together from two laps shows up as a name with the wrong duration
+    aec::trace::clear();
+    std::atomic<bool> stop{false};
+    std::thread writer([&stop] {
+        for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            const bool odd = (i / aec::trace::kRingEvents) & 1;
+            aec::trace::record(odd ? "odd" : "even", 4 * i, 4 * i + (odd ? 2 : 1));
+        }
+    });
+    while (aec::trace::event_count() < aec::trace::kRingEvents) std::this_thread::yield();
+
+    const std::string path = ::testing::TempDir() + "aec_trace_wrap.json";
+    int torn = 0;
+    for (int pass = 0; pass < 20; ++pass) {
+        ASSERT_TRUE(aec::trace::write_chrome_json(path.c_str()));
+        std::istringstream json(read_file(path));
+        for (std::string line; std::getline(json, line);) {
+            const bool even = line.find("\"name\":\"even\"") != std::string::npos;
+            const bool odd = line.find("\"name\":\"odd\"") != std::string::npos;
+            if (!even && !odd) continue;
+            const size_t dur = line.find("\"dur\":");
+            torn += dur == std::string::npos || line.compare(dur + 6, 6, even ? "0.001}" : "0.002}") != 0;
+        }
+    }
+    stop.store(true, std::memory_order_relaxed);
+    writer.join();
+    EXPECT_EQ(torn, 0);
+    aec::trace::clear();
+}
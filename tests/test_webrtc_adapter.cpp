@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "aec/webrtc_adapter.h"
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
 class WebRTCAecAdapterTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -39,3 +43,141 @@ TEST_F(WebRTCAecAdapterTest, EnableDisable) {
     ASSERT_TRUE(ok);
     EXPECT_EQ(near, backup);
 }
+TEST_F(WebRTCAecAdapterTest, ResamplesRenderToCaptureRate) {
+    // 48 kHz render, 16 kHz capture: the capture microphone picks up the
+    // render signal band-limited and decimated, 40 samples later
+    config.use_fixed_point = false;
+    aec::webrtc::WebRTCAecAdapter adapter;
+    ASSERT_TRUE(adapter.Init(config, 48000, 16000, 10, 1));
+    // 10 ms is 220.5 samples at 22.05 kHz
+    EXPECT_FALSE(adapter.Init(config, 22050, 16000, 10, 1));
+    ASSERT_TRUE(adapter.Init(config, 48000, 16000, 10, 1));
+
+    std::mt19937 gen(2);
+    std::normal_distribution<float> dist(0.0f, 3000.0f);
+    aec::Resampler path(48000, 16000);
+    std::vector<int16_t> render(480), decimated(160), history(200, 0), capture(160);
+    double near_power = 0.0, out_power = 0.0;
+    for (int frame = 0; frame < 400; ++frame) {
+        for (auto& v : render) v = static_cast<int16_t>(dist(gen));
+        ASSERT_EQ(path.process(render.data(), 480, decimated.data()), 160u);
+        for (size_t i = 0; i < 160; ++i) {
+            history.insert(history.begin(), decimated[i]);
+            history.pop_back();
+            capture[i] = static_cast<int16_t>(0.5f * history[40]);
+        }
+        if (frame >= 300) {
+            for (int16_t v : capture) near_power += static_cast<double>(v) * v;
+        }
+        adapter.ProcessRender(render.data());
+        ASSERT_TRUE(adapter.ProcessCapture(capture.data()));
+        if (frame >= 300) {
+            for (int16_t v : capture) out_power += static_cast<double>(v) * v;
+        }
+    }
+    EXPECT_GT(10.0 * std::log10(near_power / (out_power + 1.0)), 20.0);
+}
+// Far-end noise and its echo, frame by frame
+static void make_frames(uint32_t frames, uint32_t frame_size, std::vector<std::vector<int16_t>>& far,
+                        std::vector<std::vector<int16_t>>& near) {
+    std::mt19937 gen(4);
+    std::normal_distribution<float> dist(0.0f, 3000.0f);
+    far.assign(frames, std::vector<int16_t>(frame_size));
+    near = far;
+    int16_t last = 0;
+    for (uint32_t f = 0; f < frames; ++f) {
+        for (uint32_t i = 0; i < frame_size; ++i) {
+            far[f][i] = static_cast<int16_t>(dist(gen));
+            near[f][i] = static_cast<int16_t>(0.4f * far[f][i] + 0.2f * last);
+            last = far[f][i];
+        }
+    }
+}
+TEST_F(WebRTCAecAdapterTest, RenderQueueAppliesAlignmentDelay) {
+    // Render and capture in turn with two frames of delay: capture frame n
+    // is cancelled against render frame n - 2, silence before that
+    aec::webrtc::WebRTCAecAdapter adapter;
+    EXPECT_FALSE(adapter.SetRenderQueue(2, 2));
+    ASSERT_TRUE(adapter.SetRenderQueue(4, 2));
+    ASSERT_TRUE(adapter.Init(config, config.sample_rate));
+    aec::AEC reference(config);
+    std::vector<std::vector<int16_t>> far, near;
+    make_frames(100, config.frame_size, far, near);
+    const std::vector<int16_t> silence(config.frame_size, 0);
+    std::vector<int16_t> expected(config.frame_size);
+    for (uint32_t f = 0; f < far.size(); ++f) {
+        const int16_t* delayed = f >= 2 ? far[f - 2].data() : silence.data();
+        ASSERT_TRUE(reference.process(delayed, near[f].data(), expected.data(), config.frame_size));
+        adapter.ProcessRender(far[f].data());
+        ASSERT_TRUE(adapter.ProcessCapture(near[f].data()));
+        ASSERT_EQ(near[f], expected) << "frame " << f;
+    }
+    const aec::webrtc::RenderQueueStats stats = adapter.GetRenderQueueStats();
+    EXPECT_EQ(stats.overruns, 0u);
+    EXPECT_EQ(stats.underruns, 0u);
+    EXPECT_EQ(stats.queued, 2u);
+}
+TEST_F(WebRTCAecAdapterTest, RenderQueueCountsOverrunsAndUnderruns) {
+    aec::webrtc::WebRTCAecAdapter adapter;
+    ASSERT_TRUE(adapter.SetRenderQueue(3, 0));
+    ASSERT_TRUE(adapter.Init(config, config.sample_rate));
+    std::vector<int16_t> far(config.frame_size, 1000), near(config.frame_size, 500);
+    // Render runs five frames ahead: the last two do not fit
+    for (int i = 0; i < 5; ++i) adapter.ProcessRender(far.data());
+    aec::webrtc::RenderQueueStats stats = adapter.GetRenderQueueStats();
+    EXPECT_EQ(stats.overruns, 2u);
+    EXPECT_EQ(stats.queued, 3u);
+    // Capture drains the three, then finds nothing once; it waits for render
+    // again without counting more
+    for (int i = 0; i < 5; ++i) ASSERT_TRUE(adapter.ProcessCapture(near.data()));
+    stats = adapter.GetRenderQueueStats();
+    EXPECT_EQ(stats.underruns, 1u);
+    EXPECT_EQ(stats.queued, 0u);
+    adapter.ProcessRender(far.data());
+    ASSERT_TRUE(adapter.ProcessCapture(near.data()));
+    stats = adapter.GetRenderQueueStats();
+    EXPECT_EQ(stats.underruns, 1u);
+    EXPECT_EQ(stats.queued, 0u);
+    // Init starts over
+    ASSERT_TRUE(adapter.Init(config, config.sample_rate));
+    stats = adapter.GetRenderQueueStats();
+    EXPECT_EQ(stats.overruns + stats.underruns + stats.queued, 0u);
+}
+TEST_F(WebRTCAecAdapterTest, RenderAndCaptureOnSeparateThreads) {
+    // Render stays between one and five frames ahead of capture, so with two
+    // frames of delay nothing underruns or overruns and capture frame n
+    // meets render frame n, as if the two ran in turn on one thread
+    aec::webrtc::WebRTCAecAdapter adapter;
+    ASSERT_TRUE(adapter.SetRenderQueue(8, 2));
+    ASSERT_TRUE(adapter.Init(config, config.sample_rate));
+    aec::AEC reference(config);
+    std::vector<std::vector<int16_t>> far, near;
+    make_frames(500, config.frame_size, far, near);
+    std::vector<std::vector<int16_t>> expected = near;
+    for (uint32_t f = 0; f < far.size(); ++f) {
+        ASSERT_TRUE(reference.process(far[f].data(), near[f].data(), expected[f].data(), config.frame_size));
+    }
+
+    std::atomic<uint32_t> rendered{0}, captured{0};
+    std::thread render([&] {
+        for (uint32_t f = 0; f < far.size(); ++f) {
+            while (f >= captured.load() + 5) std::this_thread::yield();
+            adapter.ProcessRender(far[f].data());
+            rendered.store(f + 1);
+        }
+    });
+    bool ok = true;
+    for (uint32_t f = 0; f < near.size(); ++f) {
+        while (rendered.load() < std::min<uint32_t>(f + 3, static_cast<uint32_t>(far.size()))) {
+            std::this_thread::yield();
+        }
+        ok &= adapter.ProcessCapture(near[f].data());
+        captured.store(f + 1);
+    }
+    render.join();
+    EXPECT_TRUE(ok);
+    EXPECT_TRUE(near == expected);
+    const aec::webrtc::RenderQueueStats stats = adapter.GetRenderQueueStats();
+    EXPECT_EQ(stats.overruns, 0u);
+    EXPECT_EQ(stats.underruns, 0u);
+}
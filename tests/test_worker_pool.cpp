@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "aec/aec.hpp"
+#include "aec/worker_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace {
+
+struct Counts {
+    std::vector<std::atomic<uint32_t>> runs;
+    explicit Counts(size_t n) : runs(n) {}
+};
+
+void count_task(void* context, uint32_t task) {
+    static_cast<Counts*>(context)->runs[task].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Interleaved far-end noise, with each channel hearing its own echo of it
+void make_signals(uint32_t samples, uint32_t ch, std::vector<int16_t>& far, std::vector<int16_t>& near) {
+    std::mt19937 gen(11);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    far.resize(static_cast<size_t>(samples) * ch);
+    near.resize(far.size());
+    for (size_t i = 0; i < samples; ++i) {
+        const int16_t x = static_cast<int16_t>(3000.0f * dist(gen));
+        for (uint32_t c = 0; c < ch; ++c) {
+            const size_t n = i * ch + c;
+            far[n] = x;
+            const float echo = i >= 8 + c ? (0.6f - 0.05f * c) * far[(i - 8 - c) * ch + c] : 0.0f;
+            near[n] = static_cast<int16_t>(echo + 30.0f * dist(gen));
+        }
+    }
+}
+
+std::vector<int16_t> run_aec(aec::AECConfig config, uint32_t workers) {
+    config.worker_threads = workers;
+    std::vector<int16_t> far, near;
+    make_signals(8000, config.channels, far, near);
+    std::vector<int16_t> out(far.size());
+    auto aec = aec::create_aec(config);
+    const size_t step = static_cast<size_t>(config.frame_size) * config.channels;
+    for (size_t off = 0; off + step <= far.size(); off += step) {
+        EXPECT_TRUE(aec->process(&far[off], &near[off], &out[off], config.frame_size, config.channels));
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(WorkerPoolTest, EveryTaskRunsOnce) {
+    for (uint32_t workers : {0u, 1u, 3u, 7u}) {
+        aec::WorkerPool pool(workers, false);
+        EXPECT_EQ(pool.workers(), workers);
+        for (uint32_t tasks : {0u, 1u, 2u, 5u, 8u, 13u}) {
+            Counts counts(tasks);
+            for (int rep = 0; rep < 50; ++rep) pool.run(tasks, count_task, &counts);
+            for (uint32_t t = 0; t < tasks; ++t) EXPECT_EQ(counts.runs[t].load(), 50u) << workers << " " << t;
+        }
+    }
+}
+
+TEST(WorkerPoolTest, ParkedWorkersWakeUp) {
+    // No spinning, so idle workers park and every batch must wake them
+    aec::WorkerPool pool(2, false, 0);
+    Counts counts(6);
+    for (int rep = 0; rep < 3; ++rep) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        pool.run(6, count_task, &counts);
+    }
+    for (uint32_t t = 0; t < 6; ++t) EXPECT_EQ(counts.runs[t].load(), 3u);
+    EXPECT_GT(pool.wakeups(), 0u);
+}
+
+TEST(WorkerPoolTest, ParallelChannelsMatchSerial) {
+    const aec::Algorithm algorithms[] = {aec::Algorithm::NLMS, aec::Algorithm::PBFDAF, aec::Algorithm::RLS,
+                                         aec::Algorithm::APA, aec::Algorithm::IPNLMS};
+    for (aec::Algorithm algorithm : algorithms) {
+        for (bool fixed : {true, false}) {
+            if (fixed && algorithm != aec::Algorithm::NLMS) continue;
+            aec::AECConfig config;
+            config.frame_size = 160;
+            config.filter_length = 128;
+            config.channels = 8;
+            config.algorithm = algorithm;
+            config.use_fixed_point = fixed;
+            config.pin_worker_threads = false;
+            SCOPED_TRACE(static_cast<int>(algorithm) * 2 + fixed);
+            const std::vector<int16_t> serial = run_aec(config, 0);
+            for (uint32_t workers : {1u, 3u, 7u}) EXPECT_EQ(run_aec(config, workers), serial) << workers;
+        }
+    }
+}
+
+#if defined(__linux__)
+namespace {
+
+struct Affinity {
+    cpu_set_t sets[3];
+};
+
+void record_affinity(void* context, uint32_t task) {
+    cpu_set_t& set = static_cast<Affinity*>(context)->sets[task];
+    CPU_ZERO(&set);
+    sched_getaffinity(0, sizeof(set), &set);
+}
+
+} // namespace
+
+TEST(WorkerPoolTest, PinsWithinAffinityMask) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+    const int cpus = CPU_COUNT(&allowed);
+
+    aec::WorkerPool unpinned(2);
+    Affinity affinity;
+    unpinned.run(3, record_affinity, &affinity);
+    EXPECT_EQ(unpinned.pinned(), 0u);
+
+    aec::WorkerPool pool(2, true);
+    pool.run(3, record_affinity, &affinity);
+    if (cpus < 2) {
+        // Nowhere else to go: nothing is pinned
+        EXPECT_EQ(pool.pinned(), 0u);
+        return;
+    }
+    EXPECT_EQ(pool.pinned(), 2u);
+    for (uint32_t worker = 1; worker <= 2; ++worker) {
+        cpu_set_t& set = affinity.sets[worker];
+        ASSERT_EQ(CPU_COUNT(&set), 1);
+        cpu_set_t outside;
+        CPU_XOR(&outside, &set, &allowed);
+        EXPECT_EQ(CPU_COUNT(&outside), cpus - 1) << "pinned outside the process's mask";
+    }
+    if (cpus >= 3) {
+        EXPECT_FALSE(CPU_EQUAL(&affinity.sets[1], &affinity.sets[2]));
+    }
+}
+#endif